@@ -0,0 +1,75 @@
+/* File:     aleatorio.h
+ *
+ * Purpose:  Números pseudoaleatórios baseados em contador: o k-ésimo valor
+ *           de uma semente é uma função pura de (semente, k), sem estado.
+ *
+ *           O valor é a saída do SplitMix64 (função de mistura de Stafford,
+ *           variante 13) aplicada a mistura(semente) + k·φ, com φ = 2^64/ouro.
+ *           Como não há estado compartilhado, qualquer thread gera qualquer
+ *           posição: o resultado não depende de quantas threads dividem o
+ *           trabalho, e um laço sobre k não tem dependência entre iterações.
+ *
+ *           aleat_permuta dá uma permutação pseudoaleatória de [0, n) sem
+ *           guardá-la: rede de Feistel de 4 rodadas sobre a menor potência
+ *           de 4 que cobre n, repetida enquanto o resultado sair de [0, n)
+ *           ("cycle walking"; em média menos de 4 repetições).
+ *
+ * Exemplo:
+ *    double u = aleat_uniforme(semente, i);        // [0, 1)
+ *    double g = aleat_normal(semente, i);          // N(0, 1)
+ *    long j = aleat_permuta(i, n, semente);        // posição de i na permutação
+ */
+#ifndef _ALEATORIO_H_
+#define _ALEATORIO_H_
+
+#include <stdint.h>
+#include <math.h>
+
+#define ALEAT_GAMA 0x9E3779B97F4A7C15ULL  // 2^64 / razão áurea (ímpar)
+
+// Função de mistura do SplitMix64 (bijetora em 64 bits)
+static inline uint64_t aleat_mistura(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Valor número contador da sequência da semente
+static inline uint64_t aleat_u64(uint64_t semente, uint64_t contador) {
+    return aleat_mistura(aleat_mistura(semente) + (contador + 1) * ALEAT_GAMA);
+}
+
+// Uniforme em [0, 1) com 53 bits
+static inline double aleat_uniforme(uint64_t semente, uint64_t contador) {
+    return (aleat_u64(semente, contador) >> 11) * 0x1.0p-53;
+}
+
+// Normal padrão (Box-Muller). Usa os contadores 2·contador e 2·contador+1
+static inline double aleat_normal(uint64_t semente, uint64_t contador) {
+    double u1 = ((aleat_u64(semente, 2 * contador) >> 11) + 1) * 0x1.0p-53;  // (0, 1]
+    double u2 = aleat_uniforme(semente, 2 * contador + 1);
+    return sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+}
+
+// Posição de i (0 <= i < n) em uma permutação pseudoaleatória de [0, n)
+static inline uint64_t aleat_permuta(uint64_t i, uint64_t n, uint64_t semente) {
+    int bits = 2;
+    while (bits < 64 && (1ULL << bits) < n)
+        bits += 2;
+    int meio = bits / 2;
+    uint64_t mascara = (1ULL << meio) - 1;
+
+    do {
+        uint64_t esq = i >> meio, dir = i & mascara;
+        for (int r = 0; r < 4; r++) {
+            uint64_t f = aleat_mistura(dir ^ aleat_u64(semente, r)) & mascara;
+            uint64_t novo = esq ^ f;
+            esq = dir;
+            dir = novo;
+        }
+        i = (esq << meio) | dir;
+    } while (i >= n);
+    return i;
+}
+
+#endif
@@ -0,0 +1,189 @@
+/* File:     atualiza_modelo.c
+ *
+ * Purpose:  Atualiza um modelo salvo (--salvar-modelo) com pontos novos,
+ *           sem reler os dados antigos, ou junta modelos de partes do
+ *           conjunto processadas separadamente.
+ *
+ *           Atualização: o arquivo novo (CSV ou binário) é lido em paralelo
+ *           e dividido em blocos de ATUALIZA_BLOCO pontos; cada thread
+ *           calcula os momentos e o SSE dos seus blocos (ver estatisticas.h).
+ *           Os blocos são combinados em ordem e depois com o modelo. O custo
+ *           é proporcional só aos dados novos.
+ *
+ *           Junção (--combina): combina os momentos e o SSE de cada modelo.
+ *
+ *           Em ambos os casos A e B saem dos momentos combinados e o MSE do
+ *           SSE combinado, sem passar de novo pelos pontos.
+ *
+ * Compile:  gcc -O2 -o atualiza_modelo atualiza_modelo.c -lpthread
+ * Usage:    ./atualiza_modelo <modelo.bin> <novos.csv|novos.bin> <num_threads> [--saida <novo_modelo.bin>]
+ *           ./atualiza_modelo --combina <saida.bin> <modelo1.bin> <modelo2.bin> [...]
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "timer.h"
+#include "leitor_csv.h"
+#include "formato_binario.h"
+#include "estatisticas.h"
+#include "pool_threads.h"
+#include "modelo.h"
+
+#define ATUALIZA_BLOCO 4096  // Pontos por bloco (cabe na cache)
+
+// Dados novos e resultado de cada bloco
+double *X, *Y;
+long N = 0;
+int numThreads;
+long numBlocos;
+Momentos *momentosBloco;
+double *sseBloco;
+
+// Cada thread calcula momentos e SSE de um trecho contíguo de blocos
+void *calcula_blocos(void *arg) {
+    long id = (long)arg;
+    long primeiro = id * numBlocos / numThreads;
+    long ultimo = (id + 1) * numBlocos / numThreads;
+
+    for (long b = primeiro; b < ultimo; b++) {
+        long inicio = b * ATUALIZA_BLOCO;
+        long n = (inicio + ATUALIZA_BLOCO < N) ? ATUALIZA_BLOCO : N - inicio;
+        momentos_bloco(X + inicio, Y + inicio, n, &momentosBloco[b]);
+        sseBloco[b] = momentos_sse_bloco(X + inicio, Y + inicio, n, &momentosBloco[b]);
+    }
+    return NULL;
+}
+
+static void mostra_modelo(const char *titulo, const Modelo *m) {
+    printf("%s: n = %llu, A = %.6f, B = %.6f, MSE = %.6f\n",
+           titulo, (unsigned long long)m->n, m->A, m->B, m->MSE);
+}
+
+// Modelo final a partir dos momentos e do SSE combinados
+static void monta_modelo(Modelo *m, const Momentos *total, double sse) {
+    double A, B;
+    momentos_coeficientes(total, &A, &B);
+    modelo_de_momentos(m, total, A, B, total->n > 0 ? sse / total->n : 0.0);
+}
+
+// ==================== JUNÇÃO DE MODELOS ====================
+static int combina_modelos(const char *saida, char **entradas, int quantos) {
+    Momentos total = {0};
+    double sse = 0.0;
+
+    for (int i = 0; i < quantos; i++) {
+        Modelo parte;
+        Momentos m;
+        if (carrega_modelo(entradas[i], &parte) != 0)
+            return 1;
+        mostra_modelo(entradas[i], &parte);
+        modelo_momentos(&parte, &m);
+        momentos_combina_sse(&total, &sse, &m, parte.MSE * parte.n);
+    }
+
+    Modelo resultado;
+    monta_modelo(&resultado, &total, sse);
+    mostra_modelo("Combinado", &resultado);
+    if (grava_modelo(saida, &resultado) != 0)
+        return 1;
+    printf("Modelo salvo em: %s\n", saida);
+    return 0;
+}
+
+// ==================== PROGRAMA PRINCIPAL ====================
+int main(int argc, char *argv[]) {
+    double inicio, fim, inicio_total, fim_total;
+
+    if (argc >= 5 && strcmp(argv[1], "--combina") == 0)
+        return combina_modelos(argv[2], argv + 3, argc - 3);
+
+    if (argc < 4) {
+        printf("Uso: %s <modelo.bin> <novos.csv|novos.bin> <num_threads> [--saida <novo_modelo.bin>]\n", argv[0]);
+        printf("     %s --combina <saida.bin> <modelo1.bin> <modelo2.bin> [...]\n", argv[0]);
+        return 1;
+    }
+
+    char *arquivoModelo = argv[1];
+    char *nomeArquivo = argv[2];
+    numThreads = atoi(argv[3]);
+    if (numThreads < 1)
+        numThreads = 1;
+    char *arquivoSaida = arquivoModelo;  // Por padrão sobrescreve o modelo
+    for (int i = 4; i < argc; i++) {
+        if (strcmp(argv[i], "--saida") == 0 && i + 1 < argc) {
+            arquivoSaida = argv[++i];
+        } else {
+            fprintf(stderr, "Opcao desconhecida: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    GET_TIME(inicio_total);
+
+    Modelo anterior;
+    if (carrega_modelo(arquivoModelo, &anterior) != 0)
+        return 1;
+
+    // ==================== LEITURA DOS DADOS NOVOS ====================
+    int usaBinario = eh_arquivo_binario(nomeArquivo);
+    N = usaBinario ? carrega_binario(nomeArquivo, &X, &Y, NULL)
+                   : carrega_csv_mmap(nomeArquivo, numThreads, &X, &Y);
+    if (N < 0)
+        return 1;
+
+    numBlocos = (N + ATUALIZA_BLOCO - 1) / ATUALIZA_BLOCO;
+    momentosBloco = malloc((numBlocos + 1) * sizeof(Momentos));
+    sseBloco = malloc((numBlocos + 1) * sizeof(double));
+    if (!momentosBloco || !sseBloco) {
+        fprintf(stderr, "Erro ao alocar memória\n");
+        return 1;
+    }
+
+    // ==================== MOMENTOS DOS DADOS NOVOS ====================
+    GET_TIME(inicio);
+    PoolThreads pool;
+    if (pool_inicializa(&pool, numThreads) != 0) {
+        fprintf(stderr, "Erro ao alocar memória\n");
+        return 1;
+    }
+    pool_executa(&pool, N, calcula_blocos, NULL, 0);
+    pool_destroi(&pool);
+
+    // Blocos em ordem (resultado independe do número de threads), depois o modelo
+    Momentos novos = {0};
+    double sseNovos = 0.0;
+    for (long b = 0; b < numBlocos; b++)
+        momentos_combina_sse(&novos, &sseNovos, &momentosBloco[b], sseBloco[b]);
+
+    Momentos total;
+    double sse = anterior.MSE * anterior.n;
+    modelo_momentos(&anterior, &total);
+    momentos_combina_sse(&total, &sse, &novos, sseNovos);
+    GET_TIME(fim);
+
+    Modelo atualizado;
+    monta_modelo(&atualizado, &total, sse);
+    int erro = grava_modelo(arquivoSaida, &atualizado) != 0;
+    GET_TIME(fim_total);
+
+    // ==================== RESULTADOS ====================
+    printf("\n=== ATUALIZACAO DO MODELO ===\n");
+    mostra_modelo("Anterior", &anterior);
+    printf("Pontos novos: %ld\n", N);
+    mostra_modelo("Atualizado", &atualizado);
+    printf("\n=== TEMPOS DE EXECUCAO ===\n");
+    printf("Tempo atualizacao: %f segundos\n", fim - inicio);
+    printf("Tempo total programa: %f segundos\n", fim_total - inicio_total);
+    if (!erro)
+        printf("Modelo salvo em: %s\n", arquivoSaida);
+
+    if (usaBinario) {
+        libera_binario(X, N);
+    } else {
+        colunas_libera(X);
+    }
+    free(momentosBloco);
+    free(sseBloco);
+    return erro;
+}
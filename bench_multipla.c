@@ -0,0 +1,122 @@
+/* File:     bench_multipla.c
+ *
+ * Purpose:  Mede a montagem paralela da matriz de Gram da regressão
+ *           múltipla (regressao_multipla.h) para p = 2, 4, 8, ..., 256.
+ *
+ *           Para cada p gera em memória uma matriz com o mesmo número de
+ *           bytes (N = megabytes / (p+1) doubles por linha), com y = b0 +
+ *           Σ b_j x_j + ruído e coeficientes conhecidos, e mede cada fase.
+ *           Com p pequeno a fase de Gram é limitada pela memória; com p
+ *           grande, pelas FMAs (p²/2 por linha), o que aparece no GFLOP/s.
+ *
+ * Compile:  gcc -O2 -o bench_multipla bench_multipla.c -lpthread -lm
+ * Usage:    ./bench_multipla [num_threads] [megabytes] [p_max]
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "timer.h"
+#include "pool_threads.h"
+#include "nucleos_simd.h"
+#include "regressao_multipla.h"
+
+#define BENCH_REPETICOES 3
+
+// Gerador congruente simples: os dados só precisam ser reprodutíveis
+static double bench_aleatorio(unsigned long long *estado) {
+    *estado = *estado * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (double)(*estado >> 11) / 9007199254740992.0;  // [0, 1)
+}
+
+int main(int argc, char *argv[]) {
+    int numThreads = (argc >= 2) ? atoi(argv[1]) : 1;
+    long megabytes = (argc >= 3) ? atol(argv[2]) : 256;
+    int pMax = (argc >= 4) ? atoi(argv[3]) : 256;
+
+    if (numThreads < 1 || megabytes < 1 || pMax < 2) {
+        printf("Uso: %s [num_threads] [megabytes] [p_max]\n", argv[0]);
+        return 1;
+    }
+
+    nucleos_seleciona();
+    PoolThreads pool;
+    if (pool_inicializa(&pool, numThreads) != 0) {
+        fprintf(stderr, "Erro ao alocar memória\n");
+        return 1;
+    }
+
+    printf("Threads: %d, nucleo: %s, dados: %ld MB por p\n", numThreads, nucleo_nome, megabytes);
+    printf("%5s %10s %10s %10s %10s %10s %9s %12s\n",
+           "p", "N", "medias(s)", "gram(s)", "chol(s)", "mse(s)", "GFLOP/s", "erro_coef");
+
+    for (int p = 2; p <= pMax; p *= 2) {
+        int m = p + 1;
+        long N = megabytes * 1024 * 1024 / (m * (long)sizeof(double));
+        if (N < 4 * m)
+            N = 4 * m;
+
+        double *dados = malloc(N * m * sizeof(double));
+        double *verdade = malloc(m * sizeof(double));
+        if (!dados || !verdade) {
+            fprintf(stderr, "Erro ao alocar %ld linhas\n", N);
+            return 1;
+        }
+
+        unsigned long long estado = 42;
+        verdade[0] = 2.0;
+        for (int j = 1; j <= p; j++)
+            verdade[j] = 1.0 + 0.5 * j / p;
+        for (long i = 0; i < N; i++) {
+            double *linha = dados + i * m, y = verdade[0];
+            for (int j = 0; j < p; j++) {
+                linha[j] = 100.0 * bench_aleatorio(&estado);
+                y += verdade[j + 1] * linha[j];
+            }
+            linha[p] = y + (bench_aleatorio(&estado) - 0.5);
+        }
+
+        // Menor tempo de cada fase entre as repetições
+        double melhor[4] = {1e30, 1e30, 1e30, 1e30}, erroCoef = 0.0;
+        for (int rep = 0; rep < BENCH_REPETICOES; rep++) {
+            RegressaoMultipla r;
+            double t0, t1, t2, t3, t4;
+            if (multipla_inicializa(&r, dados, N, p, numThreads) != 0) {
+                fprintf(stderr, "Erro ao alocar memória\n");
+                return 1;
+            }
+            GET_TIME(t0);
+            multipla_fase_centro(&r, &pool);
+            GET_TIME(t1);
+            multipla_fase_gram(&r, &pool);
+            GET_TIME(t2);
+            int ok = multipla_resolve(&r) == 0;
+            GET_TIME(t3);
+            if (ok)
+                multipla_fase_mse(&r, &pool);
+            GET_TIME(t4);
+
+            double tempos[4] = {t1 - t0, t2 - t1, t3 - t2, t4 - t3};
+            for (int f = 0; f < 4; f++)
+                if (tempos[f] < melhor[f])
+                    melhor[f] = tempos[f];
+
+            erroCoef = ok ? 0.0 : NAN;
+            for (int j = 1; ok && j <= p; j++)
+                erroCoef = fmax(erroCoef, fabs(r.beta[j] - verdade[j]));
+            multipla_libera(&r);
+        }
+
+        // Trabalho útil do triângulo superior de G: (p+2)(p+3)/2 FMAs por linha
+        double flops = 2.0 * N * (p + 2) * (p + 3) / 2.0;
+        printf("%5d %10ld %10.4f %10.4f %10.6f %10.4f %9.2f %12.3e\n",
+               p, N, melhor[0], melhor[1], melhor[2], melhor[3],
+               flops / melhor[1] / 1e9, erroCoef);
+
+        free(dados);
+        free(verdade);
+    }
+
+    pool_destroi(&pool);
+    return 0;
+}
@@ -0,0 +1,403 @@
+"""Bateria de medições dos programas de regressão.
+
+Roda as variantes (sequencial, sequencial com MSE, paralela e paralela com
+MSE) para cada tamanho N e número de threads, com execuções de aquecimento
+descartadas e várias repetições. Para cada fase (leitura, regressão, MSE e
+total) guarda mediana, mínimo e desvio padrão, além de A, B e MSE da última
+execução, em CSV e JSON junto com a CPU, o compilador e o commit.
+
+Os tempos vêm das linhas "Tempo ...: <segundos>" que cada programa imprime.
+Quando um programa não mede a leitura separadamente, ela é estimada como
+total - regressão - MSE (campo leitura_estimada no JSON).
+
+A variante "mse" também grava as métricas detalhadas (--metricas, ver
+instrumentacao.h): no JSON, "instrumentacao" traz mediana, mínimo e desvio de
+cada fase interna (leitura, conversão, somas, redução, MSE) e, da última
+execução, os tempos por thread e os contadores de hardware (com --opcoes --perf).
+
+Com --interferencia K, K processos ocupam as CPUs 0..K-1 durante as medições
+(vizinho barulhento): compare mse (pedaços com roubo) com mse:--estatico
+(divisão estática) para ver quanto uma CPU disputada atrasa cada fase.
+
+Uma variante terminada em @normal, @thp ou @hugetlb roda com REGRESSAO_PAGINAS
+(memoria_colunas.h) nesse valor: compare mse@normal com mse@thp para ver o
+efeito das páginas grandes na conversão (faltas_pagina nas métricas) e, com
+--perf, nas faltas de TLB.
+
+Com --comparar, as medianas são comparadas com um JSON anterior e o script
+termina com código 2 se alguma fase ficou mais lenta que a tolerância.
+
+Uso:
+    python3 benchmark.py --compilar --tamanhos 100000,1000000 --threads 1,2,4,8
+    python3 benchmark.py --variantes mse,mse:--fundido --saida hoje
+    python3 benchmark.py --comparar ontem.json --tolerancia 0.10
+    python3 benchmark.py --variantes mse,mse:--estatico --threads 4 --interferencia 1
+    python3 benchmark.py --binarios build/x86-64-v3 --variantes motor-par-sse-f64,motor-par-sse-f32
+    python3 benchmark.py --variantes mse:--mmap@normal,mse:--mmap@thp --opcoes --perf
+"""
+import argparse
+import csv
+import json
+import os
+import platform
+import re
+import statistics
+import subprocess
+import sys
+import time
+
+# Variante -> (programa, usa threads)
+VARIANTES = {
+    "sequencial": ("regressao-linear-sequencial", False),
+    "sequencial-mse": ("regressao-linear-sequencial-mse", False),
+    "paralelo": ("regressao-linear", True),
+    "mse": ("regressao-linear-mse", True),
+}
+
+FASES = ["leitura", "regressao", "mse", "total"]
+
+# Variantes que aceitam --metricas <arquivo.json>
+COM_METRICAS = {"mse"}
+
+# Combinações do motor (make motor): motor-<seq|par>-<somas|sse|estendido>-<f64|f32|fx32>
+PADRAO_MOTOR = re.compile(r"motor-(seq|par)-(somas|sse|estendido)-(f64|f32|fx32)$")
+
+
+PAGINAS = ("normal", "thp", "hugetlb")
+
+
+def separa_variante(variante):
+    """'nome:op1:op2@paginas' -> (nome, [op1, op2], paginas ou None)."""
+    base, _, paginas = variante.partition("@")
+    partes = base.split(":")
+    return partes[0], partes[1:], paginas or None
+
+
+def programa_de(nome):
+    """(programa, usa threads) de uma variante conhecida ou de uma combinação do motor."""
+    if nome in VARIANTES:
+        return VARIANTES[nome]
+    m = PADRAO_MOTOR.match(nome)
+    return (nome, m.group(1) == "par") if m else None
+
+NUMERO = r"(-?[0-9]+(?:\.[0-9]*)?(?:[eE][-+]?[0-9]+)?)"
+PADROES_TEMPO = {
+    "leitura": re.compile(r"Tempo (?:de |da )?leitura: " + NUMERO, re.I),
+    "regressao": re.compile(
+        r"Tempo (?:regressao|da regress[aã]o|calculos|de execu[cç][aã]o|somas): " + NUMERO, re.I),
+    "mse": re.compile(r"Tempo (?:do )?MSE: " + NUMERO, re.I),
+    "total": re.compile(r"Tempo total(?: do programa| programa)?: " + NUMERO, re.I),
+}
+PADRAO_A = re.compile(r"A \(intercepto\): " + NUMERO)
+PADRAO_B = re.compile(r"B \(inclinacao\): " + NUMERO)
+PADRAO_RETA = re.compile(r"y = " + NUMERO + r" \+ " + NUMERO + "x")
+PADRAO_MSE = re.compile(r"MSE \(Erro Quadr[aá]tico M[eé]dio\): " + NUMERO)
+
+
+# ==================== AMBIENTE ====================
+def metadados():
+    """CPU, sistema, compilador e commit da árvore medida."""
+    cpu = platform.processor() or platform.machine()
+    try:
+        with open("/proc/cpuinfo") as f:
+            for linha in f:
+                if linha.startswith("model name"):
+                    cpu = linha.split(":", 1)[1].strip()
+                    break
+    except OSError:
+        pass
+
+    def comando(*args):
+        try:
+            return subprocess.run(args, capture_output=True, text=True, check=True).stdout.strip()
+        except (OSError, subprocess.CalledProcessError):
+            return ""
+
+    return {
+        "data": time.strftime("%Y-%m-%dT%H:%M:%S%z"),
+        "cpu": cpu,
+        "cpus": os.cpu_count(),
+        "sistema": platform.platform(),
+        "compilador": comando("gcc", "--version").split("\n")[0],
+        "commit": comando("git", "rev-parse", "HEAD"),
+        "alteracoes_locais": bool(comando("git", "status", "--porcelain", "--untracked-files=no")),
+    }
+
+
+def inicia_interferencia(quantidade):
+    """Processos em laço infinito, o k-ésimo fixado na CPU k (módulo o número de CPUs)."""
+    cpus = sorted(os.sched_getaffinity(0)) if hasattr(os, "sched_getaffinity") else []
+    processos = []
+    for k in range(quantidade):
+        fixa = (lambda c=cpus[k % len(cpus)]: os.sched_setaffinity(0, {c})) if cpus else None
+        processos.append(subprocess.Popen([sys.executable, "-c", "while True: pass"],
+                                          preexec_fn=fixa))
+    return processos
+
+
+def encerra_interferencia(processos):
+    for p in processos:
+        p.kill()
+        p.wait()
+
+
+def compila(dir_binarios):
+    """Compila os programas e as combinações do motor com o Makefile."""
+    cmd = ["make", "-j", str(os.cpu_count() or 1), "BUILD=" + dir_binarios, "all", "motor"]
+    print("Compilando:", " ".join(cmd))
+    subprocess.run(cmd, check=True)
+
+
+def prepara_dados(dir_dados, dir_binarios, n):
+    """Gera (uma vez) o CSV com n pontos, sempre com a mesma semente."""
+    os.makedirs(dir_dados, exist_ok=True)
+    arquivo = os.path.join(dir_dados, f"dados_{n}.csv")
+    if not os.path.exists(arquivo):
+        gerador = os.path.join(dir_binarios, "gerador_dados")
+        subprocess.run([gerador, arquivo, str(n), "0.5", "--semente", "1"],
+                       check=True, stdout=subprocess.DEVNULL)
+    return arquivo
+
+
+# ==================== EXECUÇÃO ====================
+def executa(cmd, limite, paginas=None):
+    """Roda o programa (respondendo 'q' ao modo de previsão) e extrai tempos e resultados."""
+    ambiente = dict(os.environ, REGRESSAO_PAGINAS=paginas) if paginas else None
+    saida = subprocess.run(cmd, input="q\n", capture_output=True, text=True, timeout=limite,
+                           env=ambiente)
+    texto = saida.stdout + saida.stderr
+    if saida.returncode != 0:
+        raise RuntimeError(f"{' '.join(cmd)} terminou com código {saida.returncode}:\n{texto}")
+
+    tempos = {}
+    for fase, padrao in PADROES_TEMPO.items():
+        m = padrao.search(texto)
+        if m:
+            tempos[fase] = float(m.group(1))
+    estimada = "leitura" not in tempos and "total" in tempos
+    if estimada:
+        tempos["leitura"] = max(0.0, tempos["total"] - tempos.get("regressao", 0.0)
+                                - tempos.get("mse", 0.0))
+
+    resultado = {}
+    m = PADRAO_RETA.search(texto)
+    if m:
+        resultado["A"], resultado["B"] = float(m.group(1)), float(m.group(2))
+    else:
+        for nome, padrao in (("A", PADRAO_A), ("B", PADRAO_B)):
+            m = padrao.search(texto)
+            if m:
+                resultado[nome] = float(m.group(1))
+    m = PADRAO_MSE.search(texto)
+    if m:
+        resultado["MSE"] = float(m.group(1))
+    return tempos, resultado, estimada
+
+
+def resume(valores):
+    """Mediana, mínimo e desvio padrão (amostral) de uma lista de tempos."""
+    return {
+        "mediana": statistics.median(valores),
+        "minimo": min(valores),
+        "desvio": statistics.stdev(valores) if len(valores) > 1 else 0.0,
+    }
+
+
+def mede(variante, n, threads, arquivo, args):
+    nome, extras, paginas = separa_variante(variante)
+    programa, usa_threads = programa_de(nome)
+    cmd = [os.path.join(args.binarios, programa), arquivo]
+    if usa_threads:
+        cmd.append(str(threads))
+    cmd += extras + args.opcoes.split()
+
+    for _ in range(args.aquecimento):
+        executa(cmd, args.limite, paginas)
+
+    arquivo_metricas = None
+    if nome in COM_METRICAS:
+        arquivo_metricas = os.path.abspath(f"{args.saida}_metricas.json")
+        cmd += ["--metricas", arquivo_metricas]
+
+    por_fase = {fase: [] for fase in FASES}
+    por_fase_interna, metricas = {}, None
+    resultado, estimada = {}, False
+    for _ in range(args.repeticoes):
+        tempos, resultado, estimada = executa(cmd, args.limite, paginas)
+        for fase, valor in tempos.items():
+            por_fase[fase].append(valor)
+        if arquivo_metricas:
+            metricas = le_metricas(arquivo_metricas)
+            for fase in (metricas or {}).get("fases", []):
+                por_fase_interna.setdefault(fase["nome"], []).append(fase["duracao"])
+
+    medicao = {
+        "variante": variante,
+        "n": n,
+        "threads": threads if usa_threads else 1,
+        "repeticoes": args.repeticoes,
+        "paginas": paginas or "padrao",
+        "fases": {fase: resume(v) for fase, v in por_fase.items() if v},
+        "leitura_estimada": estimada,
+        "resultado": resultado,
+        "comando": " ".join(cmd),
+    }
+    if metricas:
+        medicao["instrumentacao"] = {
+            "fases": {fase: resume(v) for fase, v in por_fase_interna.items()},
+            "ultima_execucao": metricas,
+        }
+    return medicao
+
+
+def le_metricas(arquivo):
+    """JSON gravado pelo programa com --metricas (None se não foi gravado)."""
+    try:
+        with open(arquivo) as f:
+            metricas = json.load(f)
+        os.remove(arquivo)
+        return metricas
+    except (OSError, ValueError):
+        return None
+
+
+def calcula_aceleracao(medicoes):
+    """Aceleração da regressão em relação à mesma variante com 1 thread."""
+    base = {(m["variante"], m["n"]): m for m in medicoes if m["threads"] == 1}
+    for m in medicoes:
+        b = base.get((m["variante"], m["n"]))
+        fase = m["fases"].get("regressao")
+        if b and fase and b["fases"].get("regressao") and fase["mediana"] > 0:
+            m["aceleracao"] = b["fases"]["regressao"]["mediana"] / fase["mediana"]
+
+
+# ==================== SAÍDA ====================
+def grava_csv(arquivo, meta, medicoes):
+    with open(arquivo, "w", newline="") as f:
+        for chave, valor in meta.items():
+            f.write(f"# {chave}: {valor}\n")
+        campos = ["variante", "n", "threads", "repeticoes"]
+        for fase in FASES:
+            campos += [f"{fase}_mediana", f"{fase}_minimo", f"{fase}_desvio"]
+        campos += ["aceleracao", "A", "B", "MSE"]
+        escritor = csv.DictWriter(f, fieldnames=campos)
+        escritor.writeheader()
+        for m in medicoes:
+            linha = {c: m.get(c, "") for c in ("variante", "n", "threads", "repeticoes", "aceleracao")}
+            for fase, r in m["fases"].items():
+                for k, v in r.items():
+                    linha[f"{fase}_{k}"] = f"{v:.6f}"
+            if linha["aceleracao"] != "":
+                linha["aceleracao"] = f"{linha['aceleracao']:.3f}"
+            linha.update(m["resultado"])
+            escritor.writerow(linha)
+
+
+def mostra_tabela(medicoes):
+    print(f"\n{'variante':<26}{'N':>10}{'thr':>5}  "
+          + "".join(f"{fase + ' (med/min)':>24}" for fase in FASES) + f"{'acel':>7}")
+    for m in medicoes:
+        colunas = ""
+        for fase in FASES:
+            r = m["fases"].get(fase)
+            colunas += f"{r['mediana']:>12.6f}/{r['minimo']:<11.6f}" if r else f"{'-':>24}"
+        acel = f"{m['aceleracao']:>7.2f}" if "aceleracao" in m else f"{'-':>7}"
+        print(f"{m['variante']:<26}{m['n']:>10}{m['threads']:>5}  {colunas}{acel}")
+
+
+def compara(medicoes, arquivo_base, tolerancia, minimo):
+    """Lista as fases mais lentas que no arquivo base. Retorna o número de regressões."""
+    with open(arquivo_base) as f:
+        base = {(m["variante"], m["n"], m["threads"]): m for m in json.load(f)["medicoes"]}
+
+    regressoes = 0
+    print(f"\n=== COMPARACAO COM {arquivo_base} (tolerancia {tolerancia:.0%}) ===")
+    for m in medicoes:
+        b = base.get((m["variante"], m["n"], m["threads"]))
+        if not b:
+            continue
+        for fase, r in m["fases"].items():
+            rb = b["fases"].get(fase)
+            if not rb or rb["mediana"] <= 0:
+                continue
+            razao = r["mediana"] / rb["mediana"]
+            if razao > 1 + tolerancia and r["mediana"] - rb["mediana"] > minimo:
+                regressoes += 1
+                print(f"MAIS LENTO: {m['variante']} N={m['n']} threads={m['threads']} {fase}: "
+                      f"{rb['mediana']:.6f} -> {r['mediana']:.6f} s ({razao:.2f}x)")
+    if regressoes == 0:
+        print("Nenhuma fase mais lenta que a tolerancia.")
+    return regressoes
+
+
+# ==================== PROGRAMA PRINCIPAL ====================
+def lista_inteiros(texto):
+    return [int(v) for v in texto.split(",") if v]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Medições dos programas de regressão linear")
+    parser.add_argument("--tamanhos", type=lista_inteiros, default=[100000, 1000000, 10000000])
+    parser.add_argument("--threads", type=lista_inteiros, default=[1, 2, 4, 8])
+    parser.add_argument("--variantes", default=",".join(VARIANTES),
+                        help="lista separada por vírgulas; opções extras após ':' (ex.: mse:--fundido)")
+    parser.add_argument("--opcoes", default="", help="opções repassadas a todas as variantes")
+    parser.add_argument("--repeticoes", type=int, default=5)
+    parser.add_argument("--aquecimento", type=int, default=1)
+    parser.add_argument("--binarios", default=".", help="diretório dos executáveis")
+    parser.add_argument("--dados", default="dados_bench", help="diretório dos CSV gerados")
+    parser.add_argument("--compilar", action="store_true", help="compila antes de medir")
+    parser.add_argument("--saida", default="benchmark", help="prefixo dos arquivos .csv e .json")
+    parser.add_argument("--comparar", help="JSON de uma execução anterior")
+    parser.add_argument("--tolerancia", type=float, default=0.10)
+    parser.add_argument("--minimo", type=float, default=0.001,
+                        help="diferença mínima (s) para contar como regressão")
+    parser.add_argument("--limite", type=float, default=600, help="tempo máximo de cada execução (s)")
+    parser.add_argument("--interferencia", type=int, default=0,
+                        help="processos ocupando as CPUs 0..K-1 durante as medições")
+    args = parser.parse_args()
+
+    variantes = [v for v in args.variantes.split(",") if v]
+    for v in variantes:
+        nome, _, paginas = separa_variante(v)
+        if paginas and paginas not in PAGINAS:
+            parser.error(f"paginas desconhecidas em {v} (use {', '.join(PAGINAS)})")
+        if programa_de(nome) is None:
+            parser.error(f"variante desconhecida: {v} (use {', '.join(VARIANTES)} "
+                         "ou motor-<seq|par>-<somas|sse|estendido>-<f64|f32|fx32>)")
+    if args.repeticoes < 1:
+        parser.error("--repeticoes precisa ser pelo menos 1")
+
+    if args.compilar:
+        compila(args.binarios)
+    meta = metadados()
+    meta["interferencia"] = args.interferencia
+    print(f"CPU: {meta['cpu']} ({meta['cpus']} CPUs), commit {meta['commit'][:12]}"
+          + (" com alteracoes locais" if meta["alteracoes_locais"] else ""))
+
+    medicoes = []
+    arquivos = {n: prepara_dados(args.dados, args.binarios, n) for n in args.tamanhos}
+    interferencia = inicia_interferencia(args.interferencia)
+    try:
+        for n in args.tamanhos:
+            for variante in variantes:
+                usa_threads = programa_de(separa_variante(variante)[0])[1]
+                for threads in (args.threads if usa_threads else [1]):
+                    print(f"{variante} N={n} threads={threads} ...", flush=True)
+                    medicoes.append(mede(variante, n, threads, arquivos[n], args))
+    finally:
+        encerra_interferencia(interferencia)
+    calcula_aceleracao(medicoes)
+
+    mostra_tabela(medicoes)
+    grava_csv(args.saida + ".csv", meta, medicoes)
+    with open(args.saida + ".json", "w") as f:
+        json.dump({"metadados": meta, "medicoes": medicoes}, f, indent=2)
+    print(f"\nResultados em {args.saida}.csv e {args.saida}.json")
+
+    if args.comparar and compara(medicoes, args.comparar, args.tolerancia, args.minimo) > 0:
+        sys.exit(2)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,275 @@
+/* File:     bootstrap_regressao.h
+ *
+ * Purpose:  Incerteza de A e B por bootstrap: R reamostras dos pontos, a
+ *           reta de cada uma, e daí o erro padrão (desvio padrão das R
+ *           retas) e o intervalo de confiança percentil. Também os erros
+ *           padrão analíticos da fórmula clássica (ruído de variância
+ *           constante), para comparar.
+ *
+ *           Nenhuma reamostra é montada: é o bootstrap de Poisson, em que o
+ *           ponto i entra na réplica r com peso w ~ Poisson(1) (o número de
+ *           vezes que ele seria sorteado, no limite de N grande). O peso é
+ *           uma função pura de (semente da réplica, i) pelos números
+ *           baseados em contador de aleatorio.h: o resultado é o mesmo com
+ *           qualquer número de threads, e só as somas ponderadas
+ *           Σw, Σw·d, Σw·e, Σw·d², Σw·d·e são guardadas, com
+ *             d = x - cx            (cx = média de x)
+ *             e = y - (A + B·x)     (resíduo da reta dos dados)
+ *           Cada réplica ajusta e = a + b·d, e a sua reta é
+ *           (A + a - b·cx, B + b). Somas de desvios e resíduos, pequenos,
+ *           não perdem os dígitos que Σx² e Σxy perderiam com x grande.
+ *
+ *           O trabalho é N·R, não N: as tarefas do pool são ladrilhos
+ *           (pedaço de pontos x grupo de réplicas). Com N grande há um grupo
+ *           só e cada pedaço passa pelas R réplicas; com poucos pedaços para
+ *           as threads as réplicas são divididas em grupos, e N pequeno com R
+ *           grande também roda em paralelo (o corte sequencial recebe N·R).
+ *           Cada pedaço é dividido em blocos de BOOTSTRAP_BLOCO pontos que
+ *           ficam na L1: d e e do bloco são calculados uma vez por ladrilho e
+ *           as réplicas do grupo passam por ele (nucleo_pesos_poisson e
+ *           nucleo_somas_pesadas, ver nucleos_simd.h). Cada ladrilho grava as
+ *           somas das suas réplicas na posição do seu pedaço, reduzidas em
+ *           ordem de pedaço: a soma de cada (pedaço, réplica) é sempre a
+ *           mesma, com qualquer divisão em grupos e número de threads.
+ *
+ *           O peso de Poisson vem de 32 bits uniformes u comparados com os
+ *           limites P(W <= k)·2^32 para k < BOOTSTRAP_POISSON_MAX (sem
+ *           desvios condicionais); cada valor de 64 bits do gerador dá os
+ *           pesos de dois pontos. O erro nas probabilidades é de 2^-32, e W
+ *           passa do máximo com probabilidade menor que 1e-10.
+ *
+ * Exemplo:
+ *    Bootstrap b;
+ *    if (bootstrap_calcula(&b, &pool, X, Y, N, A, B, MSE, 1000, 0.95, semente) == 0)
+ *        printf("IC de B: [%f, %f]\n", b.infB, b.supB);
+ *    bootstrap_libera(&b);
+ */
+#ifndef _BOOTSTRAP_REGRESSAO_H_
+#define _BOOTSTRAP_REGRESSAO_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "timer.h"
+#include "aleatorio.h"
+#include "pool_threads.h"
+#include "nucleos_simd.h"
+
+#define BOOTSTRAP_PEDACO 16384       // Pontos por pedaço do pool
+#define BOOTSTRAP_BLOCO 1024         // Pontos por bloco (d, e e pesos: 24 KB, cabem na L1)
+#define BOOTSTRAP_POISSON_MAX 12     // Maior peso gerado
+#define BOOTSTRAP_SOMAS 5            // Σw, Σw·d, Σw·e, Σw·d², Σw·d·e
+#define BOOTSTRAP_LADRILHOS_THREAD 4 // Ladrilhos por thread buscados ao dividir as réplicas
+
+typedef struct {
+    const double *X, *Y;
+    long N;
+    double A, B;            // Reta dos dados (os resíduos são em relação a ela)
+    double cx;              // Centro de x
+    int R;
+    uint64_t *sementes;     // Semente de cada réplica
+    uint32_t limites[BOOTSTRAP_POISSON_MAX];  // P(W <= k)·2^32
+    long numPedacos;
+    int numGrupos;          // Grupos de réplicas; o ladrilho k é o pedaço k / numGrupos, grupo k % numGrupos
+    double *parciais;       // (R + 1) x 5 somas por pedaço; a posição R tem peso 1
+    double *repA, *repB;    // Reta de cada réplica (NaN se degenerada)
+
+    // Resultados
+    int validas;                          // Réplicas com reta definida
+    double erroPadraoA, erroPadraoB;      // Desvio padrão das réplicas
+    double analiticoA, analiticoB;        // Fórmula clássica
+    double confianca;
+    double infA, supA, infB, supB;        // Intervalo percentil
+    double tempo;
+} Bootstrap;
+
+// ==================== FASES ====================
+static inline void bootstrap_media_pedaco(long inicio, long fim, long pedaco, void *contexto) {
+    Bootstrap *b = (Bootstrap *)contexto;
+    double soma[4] = {0};
+    long i = inicio;
+    for (; i + 4 <= fim; i += 4)
+        for (int k = 0; k < 4; k++)
+            soma[k] += b->X[i + k];
+    for (; i < fim; i++)
+        soma[0] += b->X[i];
+    b->parciais[pedaco] = (soma[0] + soma[1]) + (soma[2] + soma[3]);
+}
+
+// Ladrilho k (pool_executa_pedacos_trabalho com pedaços de 1): as posições
+// [r0, r1) de 0..R (R = dados originais) sobre os pontos do pedaço k / numGrupos
+static inline void bootstrap_ladrilho(long primeiro, long ultimo, long ladrilho, void *contexto) {
+    Bootstrap *b = (Bootstrap *)contexto;
+    (void)primeiro; (void)ultimo;  // [ladrilho, ladrilho + 1)
+    int R = b->R;
+    long pedaco = ladrilho / b->numGrupos;
+    int grupo = (int)(ladrilho % b->numGrupos);
+    int r0 = (int)((long)grupo * (R + 1) / b->numGrupos);
+    int r1 = (int)((long)(grupo + 1) * (R + 1) / b->numGrupos);
+    long inicio = pedaco * BOOTSTRAP_PEDACO;
+    long fim = (inicio + BOOTSTRAP_PEDACO < b->N) ? inicio + BOOTSTRAP_PEDACO : b->N;
+    double *somas = b->parciais + pedaco * (R + 1) * BOOTSTRAP_SOMAS;
+    double d[BOOTSTRAP_BLOCO], e[BOOTSTRAP_BLOCO], w[BOOTSTRAP_BLOCO];
+    double bloco[BOOTSTRAP_SOMAS];
+
+    memset(somas + r0 * BOOTSTRAP_SOMAS, 0, (r1 - r0) * BOOTSTRAP_SOMAS * sizeof(double));
+    for (long ini = inicio; ini < fim; ini += BOOTSTRAP_BLOCO) {
+        long n = (fim - ini < BOOTSTRAP_BLOCO) ? fim - ini : BOOTSTRAP_BLOCO;
+        for (long i = 0; i < n; i++) {
+            double x = b->X[ini + i];
+            d[i] = x - b->cx;
+            e[i] = (b->Y[ini + i] - b->A) - b->B * x;
+        }
+
+        for (int r = r0; r < r1; r++) {
+            if (r == R) {
+                // Posição R: os dados originais (Sxx dos erros padrão analíticos)
+                for (long i = 0; i < n; i++)
+                    w[i] = 1.0;
+            } else {
+                nucleo_pesos_poisson(b->sementes[r], ini / 2, n, b->limites, BOOTSTRAP_POISSON_MAX, w);
+            }
+            nucleo_somas_pesadas(d, e, w, n, bloco);
+            for (int q = 0; q < BOOTSTRAP_SOMAS; q++)
+                somas[r * BOOTSTRAP_SOMAS + q] += bloco[q];
+        }
+    }
+}
+
+// ==================== RESUMO DAS RÉPLICAS ====================
+static inline int bootstrap_compara(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Quantil p (interpolação linear entre posições) de v ordenado
+static inline double bootstrap_quantil(const double *v, int n, double p) {
+    double h = (n - 1) * p;
+    int k = (int)h;
+    if (k + 1 >= n)
+        return v[n - 1];
+    return v[k] + (h - k) * (v[k + 1] - v[k]);
+}
+
+// Desvio padrão e intervalo percentil das réplicas válidas de rep
+static inline void bootstrap_resume(const double *rep, int R, double confianca, double *temp,
+                                    int *validas, double *erroPadrao, double *inf, double *sup) {
+    int n = 0;
+    double media = 0, soma2 = 0;
+    for (int r = 0; r < R; r++)
+        if (rep[r] == rep[r])
+            temp[n++] = rep[r];
+    for (int r = 0; r < n; r++)
+        media += temp[r];
+    media /= (n > 0) ? n : 1;
+    for (int r = 0; r < n; r++)
+        soma2 += (temp[r] - media) * (temp[r] - media);
+    *validas = n;
+    *erroPadrao = (n > 1) ? sqrt(soma2 / (n - 1)) : NAN;
+    if (n == 0) {
+        *inf = *sup = NAN;
+        return;
+    }
+    qsort(temp, n, sizeof(double), bootstrap_compara);
+    *inf = bootstrap_quantil(temp, n, 0.5 * (1 - confianca));
+    *sup = bootstrap_quantil(temp, n, 0.5 * (1 + confianca));
+}
+
+// ==================== BOOTSTRAP ====================
+// R réplicas de Poisson em torno da reta (A, B) dos dados, com MSE o erro
+// quadrático médio dela. Retorna 0 ou -1 (sem memória ou N < 3)
+static inline int bootstrap_calcula(Bootstrap *b, PoolThreads *pool, const double *X, const double *Y, long N,
+                                    double A, double B, double MSE, int R, double confianca, uint64_t semente) {
+    double inicio, fim;
+    GET_TIME(inicio);
+    memset(b, 0, sizeof(*b));
+    if (N < 3 || R < 1)
+        return -1;
+    b->X = X;
+    b->Y = Y;
+    b->N = N;
+    b->A = A;
+    b->B = B;
+    b->R = R;
+    b->confianca = confianca;
+    b->numPedacos = (N + BOOTSTRAP_PEDACO - 1) / BOOTSTRAP_PEDACO;
+    b->sementes = malloc(R * sizeof(uint64_t));
+    b->parciais = malloc(b->numPedacos * (R + 1) * BOOTSTRAP_SOMAS * sizeof(double));
+    b->repA = malloc(3 * R * sizeof(double));  // repA, repB e espaço para ordenar
+    if (!b->sementes || !b->parciais || !b->repA)
+        return -1;
+    b->repB = b->repA + R;
+
+    // P(W <= k) = Σ_{j<=k} e^-1/j!
+    double termo = exp(-1.0), acumulada = 0;
+    for (int k = 0; k < BOOTSTRAP_POISSON_MAX; k++) {
+        acumulada += termo;
+        termo /= k + 1;
+        double limite = ldexp(acumulada, 32);
+        b->limites[k] = (limite < 4294967295.0) ? (uint32_t)limite : 4294967295u;
+    }
+    for (int r = 0; r < R; r++)
+        b->sementes[r] = aleat_u64(semente, r);
+
+    // Centro de x, depois as somas das réplicas
+    pool_executa_pedacos(pool, N, BOOTSTRAP_PEDACO, bootstrap_media_pedaco, b);
+    double somaX = 0;
+    for (long k = 0; k < b->numPedacos; k++)
+        somaX += b->parciais[k];
+    b->cx = somaX / N;
+
+    // Réplicas divididas em grupos só quando os pedaços não bastam para as threads
+    long desejados = (long)BOOTSTRAP_LADRILHOS_THREAD * pool->numThreads;
+    long grupos = (b->numPedacos >= desejados) ? 1 : (desejados + b->numPedacos - 1) / b->numPedacos;
+    b->numGrupos = (grupos < R + 1) ? (int)grupos : R + 1;
+    pool_executa_pedacos_trabalho(pool, b->numPedacos * b->numGrupos, 1, N * (R + 1L),
+                                  bootstrap_ladrilho, b);
+
+    double *s = calloc((R + 1) * BOOTSTRAP_SOMAS, sizeof(double));
+    if (!s)
+        return -1;
+    for (long k = 0; k < b->numPedacos; k++) {
+        const double *p = b->parciais + k * (R + 1) * BOOTSTRAP_SOMAS;
+        for (long q = 0; q < (R + 1) * BOOTSTRAP_SOMAS; q++)
+            s[q] += p[q];
+    }
+
+    // Cada réplica: e = a + b·d por mínimos quadrados ponderados
+    for (int r = 0; r <= R; r++) {
+        const double *t = s + r * BOOTSTRAP_SOMAS;
+        double sdd = t[3] - t[1] * t[1] / t[0];
+        double sde = t[4] - t[1] * t[2] / t[0];
+        double inc = (t[0] > 1 && sdd > 0) ? sde / sdd : NAN;
+        double a = (t[2] - inc * t[1]) / t[0];
+        if (r < R) {
+            b->repA[r] = A + a - inc * b->cx;
+            b->repB[r] = B + inc;
+        } else {
+            // Analíticos: s² = SSE/(N-2); ep(B) = s/√Sxx; ep(A) = s·√(1/N + x̄²/Sxx)
+            double s2 = MSE * N / (N - 2);
+            double mediaX = b->cx + t[1] / N;
+            b->analiticoB = sqrt(s2 / sdd);
+            b->analiticoA = sqrt(s2 * (1.0 / N + mediaX * mediaX / sdd));
+        }
+    }
+    free(s);
+
+    double *temp = b->repA + 2 * R;
+    int validasB;
+    bootstrap_resume(b->repA, R, confianca, temp, &b->validas, &b->erroPadraoA, &b->infA, &b->supA);
+    bootstrap_resume(b->repB, R, confianca, temp, &validasB, &b->erroPadraoB, &b->infB, &b->supB);
+    GET_TIME(fim);
+    b->tempo = fim - inicio;
+    return 0;
+}
+
+static inline void bootstrap_libera(Bootstrap *b) {
+    free(b->sementes);
+    free(b->parciais);
+    free(b->repA);
+    b->sementes = NULL;
+    b->parciais = b->repA = b->repB = NULL;
+}
+
+#endif
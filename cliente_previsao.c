@@ -0,0 +1,201 @@
+/* File:     cliente_previsao.c
+ *
+ * Purpose:  Cliente do servidor de previsão (servidor_previsao.c).
+ *
+ *           Modo simples: manda os x da linha de comando em uma requisição
+ *           e mostra os y.
+ *
+ *           Modo carga (--carga): abre <conexoes> conexões, cada uma em uma
+ *           thread, e manda <requisicoes> requisições de <lote> valores em
+ *           sequência (espera cada resposta antes da próxima). Mede o tempo
+ *           de ida e volta de cada requisição e mostra p50/p99/p99.9/máximo
+ *           e a vazão total.
+ *
+ * Compile:  gcc -O2 -o cliente_previsao cliente_previsao.c -lpthread
+ * Usage:    ./cliente_previsao <socket> <x1> [x2 ...]
+ *           ./cliente_previsao <socket> --carga <conexoes> <requisicoes> [lote]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "protocolo_previsao.h"
+
+typedef struct {
+    const char *caminho;
+    long requisicoes;
+    int lote;
+    uint64_t *latencias;   // Uma por requisição
+    int erro;
+} ArgsCarga;
+
+// Conecta ao socket do servidor. Retorna o descritor ou -1
+static int conecta(const char *caminho) {
+    struct sockaddr_un endereco = {.sun_family = AF_UNIX};
+    if (strlen(caminho) >= sizeof(endereco.sun_path))
+        return -1;
+    strcpy(endereco.sun_path, caminho);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    if (connect(fd, (struct sockaddr *)&endereco, sizeof(endereco)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Uma requisição completa: envia n x e recebe n y. Retorna 0 ou -1
+static int requisita(int fd, const double *x, double *y, uint32_t n) {
+    CabecalhoPrevisao cab = {n, PROTO_OK}, resp;
+    if (proto_escreve_tudo(fd, &cab, sizeof(cab)) != 0 ||
+        proto_escreve_tudo(fd, x, n * sizeof(double)) != 0 ||
+        proto_le_tudo(fd, &resp, sizeof(resp)) != 0 ||
+        resp.status != PROTO_OK || resp.n != n)
+        return -1;
+    return proto_le_tudo(fd, y, n * sizeof(double));
+}
+
+// ==================== GERADOR DE CARGA ====================
+static void *thread_carga(void *arg) {
+    ArgsCarga *args = (ArgsCarga *)arg;
+    double *x = malloc(args->lote * sizeof(double));
+    double *y = malloc(args->lote * sizeof(double));
+    int fd = conecta(args->caminho);
+
+    if (fd < 0 || !x || !y) {
+        args->erro = 1;
+    } else {
+        for (int i = 0; i < args->lote; i++)
+            x[i] = i * 0.1;
+        for (long r = 0; r < args->requisicoes; r++) {
+            uint64_t inicio = proto_agora_ns();
+            if (requisita(fd, x, y, args->lote) != 0) {
+                args->erro = 1;
+                break;
+            }
+            args->latencias[r] = proto_agora_ns() - inicio;
+        }
+    }
+    if (fd >= 0)
+        close(fd);
+    free(x);
+    free(y);
+    return NULL;
+}
+
+static int modo_carga(const char *caminho, int conexoes, long requisicoes, int lote) {
+    pthread_t threads[conexoes];
+    ArgsCarga args[conexoes];
+    long total = (long)conexoes * requisicoes;
+    uint64_t *latencias = malloc(total * sizeof(uint64_t));
+
+    if (!latencias) {
+        fprintf(stderr, "Erro ao alocar memoria\n");
+        return 1;
+    }
+
+    uint64_t inicio = proto_agora_ns();
+    int criadas = 0;
+    for (int t = 0; t < conexoes; t++) {
+        args[t].caminho = caminho;
+        args[t].requisicoes = requisicoes;
+        args[t].lote = lote;
+        args[t].latencias = latencias + t * requisicoes;
+        args[t].erro = 0;
+        if (pthread_create(&threads[t], NULL, thread_carga, &args[t]) != 0)
+            break;
+        criadas++;
+    }
+    int erro = 0;
+    for (int t = 0; t < criadas; t++) {
+        pthread_join(threads[t], NULL);
+        erro |= args[t].erro;
+    }
+    double segundos = (proto_agora_ns() - inicio) / 1e9;
+
+    if (criadas < conexoes) {
+        fprintf(stderr, "Erro: so foi possivel criar %d de %d conexoes\n", criadas, conexoes);
+        free(latencias);
+        return 1;
+    }
+    if (erro) {
+        fprintf(stderr, "Erro: falha na comunicacao com o servidor em %s\n", caminho);
+        free(latencias);
+        return 1;
+    }
+
+    qsort(latencias, total, sizeof(uint64_t), proto_compara_u64);
+    printf("=== CARGA ===\n");
+    printf("Conexoes: %d, requisicoes: %ld, lote: %d valores\n", conexoes, total, lote);
+    printf("Vazao: %.0f requisicoes/s, %.2f milhoes de valores/s\n",
+           total / segundos, total * (double)lote / segundos / 1e6);
+    printf("Latencia (ida e volta): p50 %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us\n",
+           proto_percentil(latencias, total, 0.50) / 1e3,
+           proto_percentil(latencias, total, 0.99) / 1e3,
+           proto_percentil(latencias, total, 0.999) / 1e3,
+           latencias[total - 1] / 1e3);
+    free(latencias);
+    return 0;
+}
+
+// ==================== PROGRAMA PRINCIPAL ====================
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        printf("Uso: %s <socket> <x1> [x2 ...]\n", argv[0]);
+        printf("     %s <socket> --carga <conexoes> <requisicoes> [lote]\n", argv[0]);
+        return 1;
+    }
+
+    if (strcmp(argv[2], "--carga") == 0) {
+        int conexoes = (argc >= 4) ? atoi(argv[3]) : 1;
+        long requisicoes = (argc >= 5) ? atol(argv[4]) : 10000;
+        int lote = (argc >= 6) ? atoi(argv[5]) : 1;
+        if (conexoes < 1 || requisicoes < 1 || lote < 1 || lote > PROTO_MAX_LOTE) {
+            fprintf(stderr, "Erro: parametros de carga invalidos (lote de 1 a %d)\n", PROTO_MAX_LOTE);
+            return 1;
+        }
+        return modo_carga(argv[1], conexoes, requisicoes, lote);
+    }
+
+    // Modo simples: todos os x em uma requisição
+    int n = argc - 2;
+    if (n > PROTO_MAX_LOTE) {
+        fprintf(stderr, "Erro: no maximo %d valores por requisicao\n", PROTO_MAX_LOTE);
+        return 1;
+    }
+    double *x = malloc(n * sizeof(double)), *y = malloc(n * sizeof(double));
+    if (!x || !y) {
+        fprintf(stderr, "Erro ao alocar memoria\n");
+        return 1;
+    }
+    for (int i = 0; i < n; i++) {
+        char *fim;
+        x[i] = strtod(argv[i + 2], &fim);
+        if (fim == argv[i + 2]) {
+            fprintf(stderr, "Valor invalido: %s\n", argv[i + 2]);
+            return 1;
+        }
+    }
+
+    int fd = conecta(argv[1]);
+    if (fd < 0) {
+        perror("Erro ao conectar ao servidor");
+        return 1;
+    }
+    if (requisita(fd, x, y, n) != 0) {
+        fprintf(stderr, "Erro na requisicao\n");
+        close(fd);
+        return 1;
+    }
+    close(fd);
+
+    for (int i = 0; i < n; i++)
+        printf("%.6f -> %.6f\n", x[i], y[i]);
+    free(x);
+    free(y);
+    return 0;
+}
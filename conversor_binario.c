@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "leitor_csv.h"
+#include "formato_binario.h"
+#include "timer.h"
+
+// Converte o binário (de qualquer tipo) de volta para CSV, no mesmo formato do gerador_dados.c
+int binario_para_csv(const char *entrada, const char *saida) {
+    void *X, *Y;
+    CabecalhoBinario cab;
+    long N = carrega_binario_colunas(entrada, &X, &Y, &cab);
+    if (N < 0)
+        return 1;
+    double centroX, passoX, centroY, passoY;
+    binario_fixo_escala(cab.minX, cab.maxX, &centroX, &passoX);
+    binario_fixo_escala(cab.minY, cab.maxY, &centroY, &passoY);
+
+    FILE *arquivo = fopen(saida, "w");
+    if (!arquivo) {
+        perror("Erro ao criar o arquivo");
+        libera_binario_colunas(X, N, cab.tipo);
+        return 1;
+    }
+    fprintf(arquivo, "x,y\n");
+    for (long i = 0; i < N; i++) {
+        fprintf(arquivo, "%.6f,%.6f\n", binario_le_valor(cab.tipo, X, i, centroX, passoX),
+                binario_le_valor(cab.tipo, Y, i, centroY, passoY));
+    }
+    fclose(arquivo);
+    libera_binario_colunas(X, N, cab.tipo);
+
+    printf("Arquivo '%s' gerado com %ld amostras\n", saida, N);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        printf("Uso: %s <entrada.csv|entrada.bin> <saida.bin> [num_threads] [--tipo f64|f32|fx32]\n",
+               argv[0]);
+        printf("     %s --para-csv <entrada.bin> <saida.csv>\n", argv[0]);
+        printf("Exemplo: %s dados.csv dados.bin 4\n", argv[0]);
+        printf("         %s dados.csv dados_fx32.bin 4 --tipo fx32  (colunas em ponto fixo de 32 bits)\n",
+               argv[0]);
+        return 1;
+    }
+
+    if (strcmp(argv[1], "--para-csv") == 0) {
+        if (argc < 4) {
+            printf("Uso: %s --para-csv <entrada.bin> <saida.csv>\n", argv[0]);
+            return 1;
+        }
+        return binario_para_csv(argv[2], argv[3]);
+    }
+
+    char *entrada = argv[1];
+    char *saida = argv[2];
+    int numThreads = 1;
+    uint32_t tipo = BINARIO_FLOAT64;
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--tipo") == 0 && i + 1 < argc) {
+            tipo = binario_tipo_de_nome(argv[++i]);
+            if (tipo == 0) {
+                fprintf(stderr, "Tipo desconhecido: %s (use f64, f32 ou fx32)\n", argv[i]);
+                return 1;
+            }
+        } else {
+            numThreads = atoi(argv[i]);
+        }
+    }
+    double *X, *Y;
+    double inicio, fim;
+
+    GET_TIME(inicio);
+
+    // Mesmo leitor das regressões: o binário guarda exatamente os doubles que o CSV produziria.
+    // Um binário f64 também serve de entrada (para gerar as versões reduzidas)
+    int entradaBinaria = eh_arquivo_binario(entrada);
+    long N = entradaBinaria ? carrega_binario(entrada, &X, &Y, NULL)
+                            : carrega_csv_mmap(entrada, numThreads, &X, &Y);
+    if (N < 0)
+        return 1;
+
+    double erroX, erroY;
+    int erro = grava_binario_tipo(saida, X, Y, N, tipo, &erroX, &erroY) != 0;
+    if (entradaBinaria) libera_binario(X, N); else colunas_libera(X);
+    if (erro)
+        return 1;
+
+    GET_TIME(fim);
+
+    printf("Arquivo '%s' gerado com %ld amostras em %s (%.3f segundos)\n", saida, N,
+           binario_nome_tipo(tipo), fim - inicio);
+    if (tipo != BINARIO_FLOAT64)
+        printf("Maior erro de representacao: X %.3e, Y %.3e\n", erroX, erroY);
+    return 0;
+}
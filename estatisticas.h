@@ -0,0 +1,135 @@
+/* File:     estatisticas.h
+ *
+ * Purpose:  Momentos centrados de um conjunto de pontos (x,y) e a fórmula de
+ *           combinação de Chan, Golub e LeVeque para juntar dois conjuntos.
+ *
+ *           Em vez de Σx² e Σxy (que crescem com x² e perdem precisão na
+ *           fórmula B = (nΣxy - ΣxΣy)/(nΣx² - (Σx)²)), cada conjunto guarda
+ *           as médias e as somas dos desvios em relação a elas. A regressão
+ *           sai direto dos momentos: B = Sxy/Sxx e A = ȳ - B·x̄.
+ *
+ *           momentos_bloco calcula os momentos de um bloco pequeno (que cabe
+ *           na cache) em duas passadas; momentos_combina junta dois blocos.
+ *           Combinando sempre os mesmos blocos na mesma ordem, o resultado
+ *           não depende de quantas threads calcularam os blocos.
+ *
+ *           Para o MSE, cada conjunto pode levar junto a soma dos quadrados
+ *           dos resíduos em relação à sua própria reta (SSE). Em relação a
+ *           outra reta (A, B), a soma passa a ser
+ *             SSE + (B - B_k)²·Sxx + n·(A + B·x̄ - ȳ)²
+ *           (os termos cruzados somem porque a reta do conjunto é a de
+ *           mínimos quadrados). momentos_combina_sse usa isso para juntar
+ *           conjuntos sem reler os pontos e sem a subtração Syy - Sxy²/Sxx,
+ *           que perde quase todos os dígitos quando o ajuste é bom.
+ */
+#ifndef _ESTATISTICAS_H_
+#define _ESTATISTICAS_H_
+
+// Momentos de um conjunto de pontos
+typedef struct {
+    long n;                  // Número de pontos
+    double mediaX, mediaY;   // x̄ e ȳ
+    double Sxx, Sxy, Syy;    // Σ(x-x̄)², Σ(x-x̄)(y-ȳ), Σ(y-ȳ)²
+} Momentos;
+
+// Momentos de n pontos consecutivos (duas passadas: médias, depois desvios)
+static inline void momentos_bloco(const double *vx, const double *vy, long n, Momentos *m) {
+    double somaX = 0, somaY = 0;
+    for (long i = 0; i < n; i++) {
+        somaX += vx[i];
+        somaY += vy[i];
+    }
+
+    m->n = n;
+    m->mediaX = (n > 0) ? somaX / n : 0.0;
+    m->mediaY = (n > 0) ? somaY / n : 0.0;
+
+    double dX = 0, dY = 0, Sxx = 0, Sxy = 0, Syy = 0;
+    for (long i = 0; i < n; i++) {
+        double dx = vx[i] - m->mediaX;
+        double dy = vy[i] - m->mediaY;
+        dX  += dx;
+        dY  += dy;
+        Sxx += dx * dx;
+        Sxy += dx * dy;
+        Syy += dy * dy;
+    }
+
+    // Correção da "two-pass corrigida": remove o erro de arredondamento das médias
+    if (n > 0) {
+        Sxx -= dX * dX / n;
+        Sxy -= dX * dY / n;
+        Syy -= dY * dY / n;
+    }
+    m->Sxx = Sxx;
+    m->Sxy = Sxy;
+    m->Syy = Syy;
+}
+
+// a = a ∪ b (Chan et al.): desloca as médias e soma os termos de correção
+static inline void momentos_combina(Momentos *a, const Momentos *b) {
+    if (b->n == 0)
+        return;
+    if (a->n == 0) {
+        *a = *b;
+        return;
+    }
+
+    double n = (double)a->n + (double)b->n;
+    double dx = b->mediaX - a->mediaX;
+    double dy = b->mediaY - a->mediaY;
+    double fator = (double)a->n * (double)b->n / n;
+
+    a->mediaX += dx * (b->n / n);
+    a->mediaY += dy * (b->n / n);
+    a->Sxx += b->Sxx + dx * dx * fator;
+    a->Sxy += b->Sxy + dx * dy * fator;
+    a->Syy += b->Syy + dy * dy * fator;
+    a->n += b->n;
+}
+
+// Coeficientes da reta y = A + B*x a partir dos momentos
+static inline void momentos_coeficientes(const Momentos *m, double *A, double *B) {
+    *B = m->Sxy / m->Sxx;
+    *A = m->mediaY - *B * m->mediaX;
+}
+
+// Inclinação da reta de mínimos quadrados (0 se todos os x são iguais)
+static inline double momentos_inclinacao(const Momentos *m) {
+    return (m->Sxx > 0) ? m->Sxy / m->Sxx : 0.0;
+}
+
+// SSE de n pontos em relação à reta dos seus momentos m: Σ((y-ȳ) - B(x-x̄))²
+static inline double momentos_sse_bloco(const double *vx, const double *vy, long n, const Momentos *m) {
+    double B = momentos_inclinacao(m), sse = 0;
+    for (long i = 0; i < n; i++) {
+        double r = (vy[i] - m->mediaY) - B * (vx[i] - m->mediaX);
+        sse += r * r;
+    }
+    return sse;
+}
+
+// (a, sseA) = (a, sseA) ∪ (b, sseB): momentos de Chan e SSE em relação à nova reta
+static inline void momentos_combina_sse(Momentos *a, double *sseA, const Momentos *b, double sseB) {
+    if (b->n == 0)
+        return;
+    if (a->n == 0) {
+        *a = *b;
+        *sseA = sseB;
+        return;
+    }
+
+    Momentos c = *a;
+    momentos_combina(&c, b);
+    double B = momentos_inclinacao(&c);
+    double dBa = B - momentos_inclinacao(a), dBb = B - momentos_inclinacao(b);
+    // Distância vertical entre a nova reta e o centro de cada conjunto
+    double da = (c.mediaY - a->mediaY) - B * (c.mediaX - a->mediaX);
+    double db = (c.mediaY - b->mediaY) - B * (c.mediaX - b->mediaX);
+
+    *sseA = (*sseA + dBa * dBa * a->Sxx + a->n * da * da) +
+            (sseB  + dBb * dBb * b->Sxx + b->n * db * db);
+    *a = c;
+}
+
+#endif
@@ -0,0 +1,55 @@
+/* File:     formata_fixo6.h
+ *
+ * Purpose:  Formatação de doubles com 6 casas decimais, com o mesmo texto do
+ *           printf("%.6f") e sem passar pelo printf no caso comum. Usada na
+ *           previsão em lote (previsao_lote.h) e no gerador de dados.
+ *
+ * Exemplo:
+ *    char texto[FIXO6_MAX_TEXTO];
+ *    int tam = formata_fixo6(3.25, texto);   // "3.250000", tam = 8
+ */
+#ifndef _FORMATA_FIXO6_H_
+#define _FORMATA_FIXO6_H_
+
+#include <stdio.h>
+#include <math.h>
+#include "soma_compensada.h"
+
+#define FIXO6_MAX_TEXTO 330  // Maior "%.6f" de um double (DBL_MAX tem 309 dígitos)
+
+// Escreve v como printf("%.6f") faria e retorna o número de caracteres.
+// Caminho rápido: v*10^6 = p + e exatamente (TwoProduct); se o valor exato
+// não está perto de um empate, o inteiro mais próximo r é o arredondamento
+// do printf e basta imprimir r/10^6 e r%10^6. Empates, |v| >= 2^53/10^6,
+// inf e nan vão para o snprintf.
+static inline int formata_fixo6(double v, char *s) {
+    if (fabs(v) < 9007199254.0) {
+        double e, p = comp_two_prod(v, 1e6, &e);
+        double r = (double)(long long)(p + (p >= 0 ? 0.5 : -0.5));
+        double resto = (p - r) + e;
+        if (fabs(resto) < 0.4999999) {
+            unsigned long long q = (unsigned long long)fabs(r);
+            unsigned long long inteiro = q / 1000000, frac = q % 1000000;
+            char digitos[24];
+            int n = 0, k = 0;
+
+            if (signbit(v))
+                s[n++] = '-';  // Como o printf, inclusive "-0.000000"
+            do {
+                digitos[k++] = (char)('0' + inteiro % 10);
+                inteiro /= 10;
+            } while (inteiro);
+            while (k)
+                s[n++] = digitos[--k];
+            s[n++] = '.';
+            for (int c = 5; c >= 0; c--) {
+                s[n + c] = (char)('0' + frac % 10);
+                frac /= 10;
+            }
+            return n + 6;
+        }
+    }
+    return snprintf(s, FIXO6_MAX_TEXTO, "%.6f", v);
+}
+
+#endif
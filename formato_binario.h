@@ -0,0 +1,355 @@
+/* File:     formato_binario.h
+ *
+ * Purpose:  Formato binário colunar para os conjuntos de dados (x,y), para
+ *           não pagar a conversão do CSV a cada execução.
+ *
+ *           Layout do arquivo (inteiros e doubles na ordem de bytes nativa,
+ *           e = tamanho de um elemento do tipo do cabeçalho):
+ *             [0, 64)              cabeçalho CabecalhoBinario
+ *             [64, 64 + eN)        coluna X
+ *             [64 + eN, 64 + c)    zeros até c = eN arredondado para 64
+ *             [64 + c, 64 + c + eN) coluna Y
+ *
+ *           O cabeçalho ocupa exatamente uma linha de cache e a coluna X é
+ *           completada até um múltiplo de 64 bytes, então as duas colunas
+ *           começam em linha de cache quando o arquivo é mapeado (o mapa
+ *           começa numa página). A versão 1 não tinha o enchimento e Y só
+ *           ficava alinhada com eN múltiplo de 64; ela não é mais aceita.
+ *
+ *           As colunas podem ser gravadas em precisão reduzida (metade dos
+ *           bytes): float, ou inteiros de 32 bits em ponto fixo, com
+ *           v = centro + q·passo e centro/passo tirados da faixa [min, max]
+ *           do próprio cabeçalho. carrega_binario só aceita double;
+ *           carrega_binario_colunas devolve as colunas em qualquer tipo.
+ *
+ * Exemplo:
+ *    #include "formato_binario.h"
+ *    . . .
+ *    if (eh_arquivo_binario(nomeArquivo))
+ *        N = carrega_binario(nomeArquivo, &X, &Y, NULL);
+ *    . . .
+ *    libera_binario(X, N);
+ */
+#ifndef _FORMATO_BINARIO_H_
+#define _FORMATO_BINARIO_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#define BINARIO_MAGICA  "RLBIN\0\0\0"  // 8 bytes no início do arquivo
+#define BINARIO_VERSAO  2              // 2: coluna X completada até 64 bytes
+#define BINARIO_ALINHAMENTO 64         // Início de cada coluna no arquivo
+#define BINARIO_FLOAT64 1              // Tipo das colunas: double
+#define BINARIO_FLOAT32 2              // float
+#define BINARIO_FIXO32  3              // int32 em ponto fixo: v = centro + q·passo
+
+#define BINARIO_FIXO_MAX 2147483646.0  // |q| máximo (o extremo da faixa)
+
+// Cabeçalho de 64 bytes gravado no início do arquivo
+typedef struct {
+    char magica[8];          // BINARIO_MAGICA
+    uint32_t versao;         // BINARIO_VERSAO
+    uint32_t tipo;           // Tipo dos elementos das colunas (BINARIO_FLOAT64, ...)
+    uint64_t n;              // Número de pontos
+    double minX, maxX;       // Faixa dos valores de X
+    double minY, maxY;       // Faixa dos valores de Y
+    uint64_t reservado;      // Completa os 64 bytes
+} CabecalhoBinario;
+
+// Tamanho em bytes de um elemento do tipo informado no cabeçalho (0 = desconhecido)
+static inline size_t binario_tam_elemento(uint32_t tipo) {
+    switch (tipo) {
+        case BINARIO_FLOAT64: return sizeof(double);
+        case BINARIO_FLOAT32: return sizeof(float);
+        case BINARIO_FIXO32:  return sizeof(int32_t);
+        default:              return 0;
+    }
+}
+
+// Nome curto do tipo (o mesmo usado nas opções --tipo)
+static inline const char *binario_nome_tipo(uint32_t tipo) {
+    switch (tipo) {
+        case BINARIO_FLOAT64: return "f64";
+        case BINARIO_FLOAT32: return "f32";
+        case BINARIO_FIXO32:  return "fx32";
+        default:              return "?";
+    }
+}
+
+// Tipo a partir do nome curto (0 = desconhecido)
+static inline uint32_t binario_tipo_de_nome(const char *nome) {
+    for (uint32_t tipo = BINARIO_FLOAT64; tipo <= BINARIO_FIXO32; tipo++)
+        if (strcmp(nome, binario_nome_tipo(tipo)) == 0)
+            return tipo;
+    return 0;
+}
+
+// ==================== PONTO FIXO ====================
+// Centro e passo do ponto fixo de uma coluna com valores em [min, max]: o
+// centro da faixa vira q = 0 e os extremos ficam em ±BINARIO_FIXO_MAX. Com
+// q centrado em 0 a conversão para double é a de int32 com sinal, que tem
+// instrução vetorial própria (a de uint32 não tem antes do AVX-512).
+static inline void binario_fixo_escala(double min, double max, double *centro, double *passo) {
+    *centro = 0.5 * (min + max);
+    *passo = (max > min) ? (max - min) / (2 * BINARIO_FIXO_MAX) : 1.0;
+}
+
+static inline int32_t binario_fixo_codifica(double v, double centro, double passo) {
+    double q = nearbyint((v - centro) / passo);
+    if (q > BINARIO_FIXO_MAX) q = BINARIO_FIXO_MAX;
+    if (q < -BINARIO_FIXO_MAX) q = -BINARIO_FIXO_MAX;
+    return (int32_t)q;
+}
+
+// Elemento i de uma coluna do tipo informado, de volta em double
+static inline double binario_le_valor(uint32_t tipo, const void *coluna, long i, double centro, double passo) {
+    switch (tipo) {
+        case BINARIO_FLOAT32: return (double)((const float *)coluna)[i];
+        case BINARIO_FIXO32:  return centro + passo * (double)((const int32_t *)coluna)[i];
+        default:              return ((const double *)coluna)[i];
+    }
+}
+
+// Converte n doubles para o tipo informado em destino. Retorna o maior erro
+// de representação |v - valor convertido de volta|
+static inline double binario_codifica_coluna(uint32_t tipo, const double *v, long n,
+                                             double centro, double passo, void *destino) {
+    double erroMax = 0;
+    for (long i = 0; i < n; i++) {
+        if (tipo == BINARIO_FLOAT32)
+            ((float *)destino)[i] = (float)v[i];
+        else if (tipo == BINARIO_FIXO32)
+            ((int32_t *)destino)[i] = binario_fixo_codifica(v[i], centro, passo);
+        else
+            ((double *)destino)[i] = v[i];
+        double erro = fabs(v[i] - binario_le_valor(tipo, destino, i, centro, passo));
+        if (erro > erroMax)
+            erroMax = erro;
+    }
+    return erroMax;
+}
+
+// Bytes da coluna X no arquivo (n elementos mais o enchimento até 64); Y
+// começa em sizeof(CabecalhoBinario) + binario_tam_coluna(n, e)
+static inline uint64_t binario_tam_coluna(uint64_t n, size_t tamElemento) {
+    return (n * tamElemento + BINARIO_ALINHAMENTO - 1) / BINARIO_ALINHAMENTO * BINARIO_ALINHAMENTO;
+}
+
+// Tamanho do arquivo com n elementos por coluna
+static inline uint64_t binario_tam_arquivo(uint64_t n, size_t tamElemento) {
+    return sizeof(CabecalhoBinario) + binario_tam_coluna(n, tamElemento) + n * tamElemento;
+}
+
+// Confere o N do cabeçalho contra o tamanho do arquivo. N é limitado antes de
+// qualquer multiplicação: um cabeçalho corrompido com N perto de 2^64 faria
+// 2·N·elemento dar a volta e passar na comparação
+static inline int binario_tamanho_valido(const CabecalhoBinario *cab, size_t tamElemento, uint64_t tamArquivo) {
+    if (tamElemento == 0 || tamArquivo < sizeof(*cab))
+        return 0;
+    if (cab->n > (tamArquivo - sizeof(*cab)) / (2 * tamElemento))
+        return 0;
+    return binario_tam_arquivo(cab->n, tamElemento) <= tamArquivo;
+}
+
+// Converte n doubles de v para o tipo informado no próprio lugar: o elemento
+// i vai para os bytes [e·i, e·(i+1)) do início de v (e = 4 bytes nos tipos
+// reduzidos), e os bytes depois de e·n deixam de ser usados. Cada bloco passa
+// por um buffer local e só então é copiado: a cópia alcança apenas doubles
+// de blocos já lidos. Retorna o maior erro de representação
+#define BINARIO_BLOCO_NO_LUGAR 4096
+
+static inline double binario_codifica_no_lugar(uint32_t tipo, double *v, long n, double centro, double passo) {
+    double bloco[BINARIO_BLOCO_NO_LUGAR];  // Cabe qualquer tipo de até 8 bytes
+    size_t tamElemento = binario_tam_elemento(tipo);
+    double erroMax = 0;
+    for (long i = 0; i < n; i += BINARIO_BLOCO_NO_LUGAR) {
+        long tam = (n - i < BINARIO_BLOCO_NO_LUGAR) ? n - i : BINARIO_BLOCO_NO_LUGAR;
+        double erro = binario_codifica_coluna(tipo, v + i, tam, centro, passo, bloco);
+        if (erro > erroMax)
+            erroMax = erro;
+        memcpy((char *)v + i * tamElemento, bloco, tam * tamElemento);
+    }
+    return erroMax;
+}
+
+// Verifica se o arquivo começa com a assinatura do formato binário
+static inline int eh_arquivo_binario(const char *nomeArquivo) {
+    char magica[8];
+    int fd = open(nomeArquivo, O_RDONLY);
+    if (fd < 0)
+        return 0;
+    ssize_t lidos = pread(fd, magica, sizeof(magica), 0);
+    close(fd);
+    return lidos == sizeof(magica) && memcmp(magica, BINARIO_MAGICA, sizeof(magica)) == 0;
+}
+
+// Preenche o cabeçalho (assinatura, N e faixas) a partir das colunas
+static inline void binario_monta_cabecalho(CabecalhoBinario *cab, const double *X, const double *Y, long N) {
+    memset(cab, 0, sizeof(*cab));
+    memcpy(cab->magica, BINARIO_MAGICA, sizeof(cab->magica));
+    cab->versao = BINARIO_VERSAO;
+    cab->tipo = BINARIO_FLOAT64;
+    cab->n = (uint64_t)N;
+    if (N > 0) {
+        cab->minX = cab->maxX = X[0];
+        cab->minY = cab->maxY = Y[0];
+    }
+    for (long i = 1; i < N; i++) {
+        if (X[i] < cab->minX) cab->minX = X[i];
+        if (X[i] > cab->maxX) cab->maxX = X[i];
+        if (Y[i] < cab->minY) cab->minY = Y[i];
+        if (Y[i] > cab->maxY) cab->maxY = Y[i];
+    }
+}
+
+// ==================== GRAVAÇÃO ====================
+#define BINARIO_BLOCO_CONVERSAO 65536  // Elementos convertidos por fwrite
+
+// Grava uma coluna no tipo do cabeçalho, convertendo em blocos. Retorna o
+// maior erro de representação, ou -1 se a escrita falhar
+static inline double binario_grava_coluna(FILE *arquivo, uint32_t tipo, const double *v, long n,
+                                          double centro, double passo) {
+    if (tipo == BINARIO_FLOAT64)
+        return fwrite(v, sizeof(double), n, arquivo) == (size_t)n ? 0.0 : -1.0;
+
+    static double bloco[BINARIO_BLOCO_CONVERSAO];  // Cabe qualquer tipo de 4 bytes
+    double erroMax = 0;
+    for (long i = 0; i < n; i += BINARIO_BLOCO_CONVERSAO) {
+        long tam = (n - i < BINARIO_BLOCO_CONVERSAO) ? n - i : BINARIO_BLOCO_CONVERSAO;
+        double erro = binario_codifica_coluna(tipo, v + i, tam, centro, passo, bloco);
+        if (erro > erroMax)
+            erroMax = erro;
+        if (fwrite(bloco, binario_tam_elemento(tipo), tam, arquivo) != (size_t)tam)
+            return -1.0;
+    }
+    return erroMax;
+}
+
+// Grava cabeçalho + coluna X + enchimento + coluna Y com as colunas no tipo informado.
+// Retorna 0 em sucesso ou -1 em erro; erroX/erroY (opcionais) recebem o maior
+// erro de representação de cada coluna
+static inline int grava_binario_tipo(const char *nomeArquivo, const double *X, const double *Y, long N,
+                                     uint32_t tipo, double *erroX, double *erroY) {
+    CabecalhoBinario cab;
+    binario_monta_cabecalho(&cab, X, Y, N);
+    cab.tipo = tipo;
+    double centroX, passoX, centroY, passoY;
+    binario_fixo_escala(cab.minX, cab.maxX, &centroX, &passoX);
+    binario_fixo_escala(cab.minY, cab.maxY, &centroY, &passoY);
+
+    FILE *arquivo = fopen(nomeArquivo, "wb");
+    if (!arquivo) {
+        perror("Erro ao criar o arquivo");
+        return -1;
+    }
+    static const char zeros[BINARIO_ALINHAMENTO];
+    size_t enchimento = binario_tam_coluna(N, binario_tam_elemento(tipo)) - N * binario_tam_elemento(tipo);
+    double eX = -1, eY = -1;
+    int ok = fwrite(&cab, sizeof(cab), 1, arquivo) == 1 &&
+             (eX = binario_grava_coluna(arquivo, tipo, X, N, centroX, passoX)) >= 0 &&
+             fwrite(zeros, 1, enchimento, arquivo) == enchimento &&
+             (eY = binario_grava_coluna(arquivo, tipo, Y, N, centroY, passoY)) >= 0;
+    if (fclose(arquivo) != 0)
+        ok = 0;
+    if (erroX) *erroX = eX;
+    if (erroY) *erroY = eY;
+    if (!ok) {
+        fprintf(stderr, "Erro ao gravar o arquivo %s\n", nomeArquivo);
+        return -1;
+    }
+    return 0;
+}
+
+// Grava cabeçalho + coluna X + coluna Y em double
+static inline int grava_binario(const char *nomeArquivo, const double *X, const double *Y, long N) {
+    return grava_binario_tipo(nomeArquivo, X, Y, N, BINARIO_FLOAT64, NULL, NULL);
+}
+
+// ==================== LEITURA ====================
+// Mapeia o arquivo e aponta X e Y direto para as colunas, no tipo gravado
+// (sem conversão nem cópia). As páginas são privadas: escrever em X/Y não
+// altera o arquivo. Retorna N ou -1 em erro. A memória deve ser liberada com
+// libera_binario_colunas (cab.tipo diz o tipo e, no ponto fixo, a faixa).
+static inline long carrega_binario_colunas(const char *nomeArquivo, void **pX, void **pY,
+                                           CabecalhoBinario *pCab) {
+    struct stat info;
+    CabecalhoBinario cab;
+
+    int fd = open(nomeArquivo, O_RDONLY);
+    if (fd < 0) {
+        perror("Erro ao abrir o arquivo");
+        return -1;
+    }
+    if (fstat(fd, &info) != 0 || pread(fd, &cab, sizeof(cab), 0) != sizeof(cab) ||
+        memcmp(cab.magica, BINARIO_MAGICA, sizeof(cab.magica)) != 0) {
+        fprintf(stderr, "Erro: %s nao e um arquivo binario valido\n", nomeArquivo);
+        close(fd);
+        return -1;
+    }
+    size_t tamElemento = binario_tam_elemento(cab.tipo);
+    if (cab.versao != BINARIO_VERSAO || !binario_tamanho_valido(&cab, tamElemento, info.st_size)) {
+        fprintf(stderr, "Erro: cabecalho de %s incompativel (versao %u, tipo %u, N %llu)\n",
+                nomeArquivo, cab.versao, cab.tipo, (unsigned long long)cab.n);
+        if (cab.versao < BINARIO_VERSAO)
+            fprintf(stderr, "Versao antiga: gere o arquivo de novo (gerador_dados ou conversor_binario)\n");
+        close(fd);
+        return -1;
+    }
+
+    size_t tamanho = binario_tam_arquivo(cab.n, tamElemento);
+    char *mapa = mmap(NULL, tamanho, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapa == MAP_FAILED) {
+        perror("Erro ao mapear o arquivo");
+        return -1;
+    }
+    madvise(mapa, tamanho, MADV_SEQUENTIAL);
+
+    *pX = mapa + sizeof(cab);
+    *pY = mapa + sizeof(cab) + binario_tam_coluna(cab.n, tamElemento);
+    if (pCab)
+        *pCab = cab;
+    return (long)cab.n;
+}
+
+// Desfaz o mapeamento criado por carrega_binario_colunas (X é o ponteiro retornado)
+static inline void libera_binario_colunas(void *X, long N, uint32_t tipo) {
+    char *mapa = (char *)X - sizeof(CabecalhoBinario);
+    munmap(mapa, binario_tam_arquivo(N, binario_tam_elemento(tipo)));
+}
+
+// Como carrega_binario_colunas, mas só aceita colunas em double
+static inline long carrega_binario(const char *nomeArquivo, double **pX, double **pY,
+                                   CabecalhoBinario *pCab) {
+    CabecalhoBinario cab;
+    void *vx, *vy;
+    long N = carrega_binario_colunas(nomeArquivo, &vx, &vy, &cab);
+    if (N < 0)
+        return -1;
+    if (cab.tipo != BINARIO_FLOAT64) {
+        fprintf(stderr, "Erro: %s guarda as colunas em %s; este programa precisa de f64 "
+                "(use o motor em %s ou converta com conversor_binario --tipo f64)\n",
+                nomeArquivo, binario_nome_tipo(cab.tipo), binario_nome_tipo(cab.tipo));
+        libera_binario_colunas(vx, N, cab.tipo);
+        return -1;
+    }
+    *pX = (double *)vx;
+    *pY = (double *)vy;
+    if (pCab)
+        *pCab = cab;
+    return N;
+}
+
+// Desfaz o mapeamento criado por carrega_binario (X é o ponteiro retornado)
+static inline void libera_binario(double *X, long N) {
+    libera_binario_colunas(X, N, BINARIO_FLOAT64);
+}
+
+#endif
@@ -1,41 +1,326 @@
+/* File:     gerador_dados.c
+ *
+ * Purpose:  Gera conjuntos de dados y = 2 + 3.5·x + ruído para os testes,
+ *           em CSV ("x,y" com 6 casas) ou direto no formato binário.
+ *
+ *           Os números aleatórios são baseados em contador (aleatorio.h): o
+ *           ruído do ponto j depende só de (semente, j), então o arquivo é o
+ *           mesmo para uma semente com qualquer número de threads.
+ *
+ *           CSV: o arquivo é escrito em rodadas. Em cada rodada cada thread
+ *           formata GERADOR_LINHAS linhas (formata_fixo6, sem printf); com os
+ *           tamanhos, a posição de cada parte no arquivo é conhecida e as
+ *           threads gravam em paralelo com pwrite. Binário: cada thread grava
+ *           seu trecho das colunas X e Y direto na posição final.
+ *
+ *           Opções:
+ *             --threads T         threads (padrão: CPUs disponíveis)
+ *             --semente S         semente (padrão 1)
+ *             --gauss             ruído normal com desvio padrão "ruido"
+ *                                 (padrão: uniforme em [-ruido, +ruido])
+ *             --outliers F        fração F dos pontos deslocada em até
+ *                                 ±GERADOR_OUTLIER·max(ruido, 1)
+ *             --embaralhar        x em ordem aleatória (mesmos pontos, outra ordem)
+ *             --binario           grava no formato binário (formato_binario.h)
+ *
+ * Compile:  gcc -O2 -o gerador_dados gerador_dados.c -lpthread -lm
+ * Usage:    ./gerador_dados <arquivo_saida> <num_amostras> [ruido] [opções]
+ */
+#define _GNU_SOURCE  // pool_threads.h (afinidade das threads)
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "timer.h"
+#include "aleatorio.h"
+#include "formata_fixo6.h"
+#include "formato_binario.h"
+#include "pool_threads.h"
 
+#define GERADOR_LINHAS  65536  // Linhas por thread em cada rodada (e por trecho no binário)
+#define GERADOR_OUTLIER 50.0   // Deslocamento máximo de um outlier, em múltiplos do ruído
+
+// Parâmetros reais da regressão (y = a + b*x)
+#define GERADOR_A 2.0
+#define GERADOR_B 3.5
+
+// Configuração da geração
+long N;
+int numThreads;
+double ruido = 0.0;
+uint64_t semente = 1, sementePermutacao;
+int usaGauss = 0, embaralhar = 0;
+double fracaoOutliers = 0.0;
+
+// Uma parte (thread) de uma rodada
+typedef struct {
+    long id;
+    long inicio, fim;        // Linhas desta parte
+    char *texto;             // CSV formatado
+    size_t tam, cap;
+    double *x, *y;           // Binário: trecho das colunas
+    double minY, maxY;
+    off_t posicao;           // Onde o texto vai no arquivo
+    int fd, erro;
+} ParteGerador;
+
+// ==================== PONTO i ====================
+// A linha i tem o ponto j (j = i, ou a posição de i na permutação). Os
+// contadores 4j..4j+3 são do ponto j: ruído (1 ou 2 valores) e outlier (2)
+static inline void gera_ponto(long i, double *px, double *py) {
+    uint64_t j = embaralhar ? aleat_permuta(i, N, sementePermutacao) : (uint64_t)i;
+    double x = (double)j / 10.0;
+    double e = usaGauss ? ruido * aleat_normal(semente, 2 * j)
+                        : ruido * (2.0 * aleat_uniforme(semente, 4 * j) - 1.0);
+    if (fracaoOutliers > 0 && aleat_uniforme(semente, 4 * j + 2) < fracaoOutliers) {
+        double escala = GERADOR_OUTLIER * (ruido > 1.0 ? ruido : 1.0);
+        e += escala * (2.0 * aleat_uniforme(semente, 4 * j + 3) - 1.0);
+    }
+    *px = x;
+    *py = GERADOR_A + GERADOR_B * x + e;
+}
+
+// ==================== CSV ====================
+// Formata as linhas da parte (no máximo 2·FIXO6_MAX_TEXTO + 2 bytes cada)
+void *formata_parte(void *arg) {
+    ParteGerador *parte = (ParteGerador *)arg;
+    parte->tam = 0;
+
+    for (long i = parte->inicio; i < parte->fim; i++) {
+        if (parte->tam + 2 * FIXO6_MAX_TEXTO + 2 > parte->cap) {
+            size_t nova = parte->cap * 2 + 2 * FIXO6_MAX_TEXTO + 2;
+            char *maior = realloc(parte->texto, nova);
+            if (!maior) {
+                parte->erro = 1;
+                return NULL;
+            }
+            parte->texto = maior;
+            parte->cap = nova;
+        }
+        double x, y;
+        gera_ponto(i, &x, &y);
+        char *s = parte->texto + parte->tam;
+        s += formata_fixo6(x, s);
+        *s++ = ',';
+        s += formata_fixo6(y, s);
+        *s++ = '\n';
+        parte->tam = s - parte->texto;
+    }
+    return NULL;
+}
+
+static int grava_tudo(int fd, const char *dados, size_t tam, off_t pos) {
+    while (tam > 0) {
+        ssize_t gravados = pwrite(fd, dados, tam, pos);
+        if (gravados <= 0)
+            return -1;
+        dados += gravados;
+        pos += gravados;
+        tam -= gravados;
+    }
+    return 0;
+}
+
+void *grava_parte(void *arg) {
+    ParteGerador *parte = (ParteGerador *)arg;
+    if (parte->tam > 0 && grava_tudo(parte->fd, parte->texto, parte->tam, parte->posicao) != 0)
+        parte->erro = 1;
+    return NULL;
+}
+
+// Retorna o tamanho final do arquivo ou -1 em erro
+static off_t gera_csv(int fd, PoolThreads *pool, ParteGerador *partes) {
+    const char cabecalho[] = "x,y\n";
+    if (grava_tudo(fd, cabecalho, sizeof(cabecalho) - 1, 0) != 0)
+        return -1;
+    off_t posicao = sizeof(cabecalho) - 1;
+
+    long porRodada = (long)numThreads * GERADOR_LINHAS;
+    for (long base = 0; base < N; base += porRodada) {
+        for (int t = 0; t < numThreads; t++) {
+            long ini = base + (long)t * GERADOR_LINHAS;
+            partes[t].inicio = (ini < N) ? ini : N;
+            partes[t].fim = (ini + GERADOR_LINHAS < N) ? ini + GERADOR_LINHAS : N;
+        }
+        pool_executa(pool, porRodada, formata_parte, partes, sizeof(ParteGerador));
+
+        // Posição de cada parte: logo depois da anterior
+        for (int t = 0; t < numThreads; t++) {
+            if (partes[t].erro)
+                return -1;
+            partes[t].posicao = posicao;
+            posicao += partes[t].tam;
+        }
+        pool_executa(pool, porRodada, grava_parte, partes, sizeof(ParteGerador));
+        for (int t = 0; t < numThreads; t++) {
+            if (partes[t].erro)
+                return -1;
+        }
+    }
+    return posicao;
+}
+
+// ==================== BINÁRIO ====================
+// Cada parte gera um trecho contíguo, GERADOR_LINHAS pontos por vez
+void *gera_trecho_binario(void *arg) {
+    ParteGerador *parte = (ParteGerador *)arg;
+    off_t colunaX = sizeof(CabecalhoBinario), colunaY = colunaX + binario_tam_coluna(N, sizeof(double));
+
+    for (long ini = parte->inicio; ini < parte->fim && !parte->erro; ini += GERADOR_LINHAS) {
+        long n = (ini + GERADOR_LINHAS < parte->fim) ? GERADOR_LINHAS : parte->fim - ini;
+        for (long k = 0; k < n; k++) {
+            gera_ponto(ini + k, &parte->x[k], &parte->y[k]);
+            if (parte->y[k] < parte->minY) parte->minY = parte->y[k];
+            if (parte->y[k] > parte->maxY) parte->maxY = parte->y[k];
+        }
+        if (grava_tudo(parte->fd, (char *)parte->x, n * sizeof(double), colunaX + ini * sizeof(double)) != 0 ||
+            grava_tudo(parte->fd, (char *)parte->y, n * sizeof(double), colunaY + ini * sizeof(double)) != 0)
+            parte->erro = 1;
+    }
+    return NULL;
+}
+
+static off_t gera_binario(int fd, PoolThreads *pool, ParteGerador *partes) {
+    for (int t = 0; t < numThreads; t++) {
+        partes[t].inicio = t * N / numThreads;
+        partes[t].fim = (t + 1) * N / numThreads;
+        partes[t].minY = INFINITY;
+        partes[t].maxY = -INFINITY;
+        partes[t].x = malloc(2 * GERADOR_LINHAS * sizeof(double));
+        partes[t].y = partes[t].x + GERADOR_LINHAS;
+        if (!partes[t].x)
+            return -1;
+    }
+    pool_executa(pool, N, gera_trecho_binario, partes, sizeof(ParteGerador));
+
+    // Cabeçalho por último, com as faixas (os x são sempre 0, 0.1, ..., (N-1)/10)
+    CabecalhoBinario cab;
+    memset(&cab, 0, sizeof(cab));
+    memcpy(cab.magica, BINARIO_MAGICA, sizeof(cab.magica));
+    cab.versao = BINARIO_VERSAO;
+    cab.tipo = BINARIO_FLOAT64;
+    cab.n = (uint64_t)N;
+    cab.minX = 0.0;
+    cab.maxX = (N > 0) ? (double)(N - 1) / 10.0 : 0.0;
+    cab.minY = INFINITY;
+    cab.maxY = -INFINITY;
+    for (int t = 0; t < numThreads; t++) {
+        if (partes[t].erro)
+            return -1;
+        if (partes[t].minY < cab.minY) cab.minY = partes[t].minY;
+        if (partes[t].maxY > cab.maxY) cab.maxY = partes[t].maxY;
+    }
+    if (N == 0)
+        cab.minY = cab.maxY = 0.0;
+    if (grava_tudo(fd, (char *)&cab, sizeof(cab), 0) != 0)
+        return -1;
+    return binario_tam_arquivo(N, sizeof(double));
+}
+
+// ==================== PROGRAMA PRINCIPAL ====================
 int main(int argc, char *argv[]) {
+    double inicio, fim;
+
     if (argc < 3) {
-        printf("Uso: %s <arquivo_saida.csv> <num_amostras> [ruido]\n", argv[0]);
+        printf("Uso: %s <arquivo_saida> <num_amostras> [ruido] [--threads T] [--semente S]\n"
+               "          [--gauss] [--outliers <fracao>] [--embaralhar] [--binario]\n", argv[0]);
         printf("Exemplo: %s dados.csv 100000 0.5\n", argv[0]);
         return 1;
     }
 
     char *nomeArquivo = argv[1];
-    long N = atol(argv[2]);
-    double ruido = (argc >= 4) ? atof(argv[3]) : 0.0;
+    N = atol(argv[2]);
+    numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int binario = 0;
+    int i = 3;
+    if (argc > 3 && strncmp(argv[3], "--", 2) != 0)
+        ruido = atof(argv[i++]);
+    for (; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            numThreads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) {
+            semente = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--gauss") == 0) {
+            usaGauss = 1;
+        } else if (strcmp(argv[i], "--outliers") == 0 && i + 1 < argc) {
+            fracaoOutliers = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--embaralhar") == 0) {
+            embaralhar = 1;
+        } else if (strcmp(argv[i], "--binario") == 0) {
+            binario = 1;
+        } else {
+            fprintf(stderr, "Opcao desconhecida: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (N < 0)
+        N = 0;
+    if (numThreads < 1)
+        numThreads = 1;
+    sementePermutacao = aleat_mistura(semente ^ 0x5045524D55544143ULL);  // Sequência própria
 
-    FILE *arquivo = fopen(nomeArquivo, "w");
-    if (!arquivo) {
+    int fd = open(nomeArquivo, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
         perror("Erro ao criar o arquivo");
         return 1;
     }
 
-    srand(time(NULL));
+    // Reserva o espaço de uma vez (no CSV, uma estimativa; o excesso é cortado no fim)
+    off_t estimativa;
+    if (binario) {
+        estimativa = binario_tam_arquivo(N, sizeof(double));
+    } else {
+        char amostra[2 * FIXO6_MAX_TEXTO];
+        double x, y;
+        gera_ponto(N > 0 ? N - 1 : 0, &x, &y);
+        estimativa = 4 + N * (off_t)(formata_fixo6(x, amostra) + formata_fixo6(y, amostra) + 2);
+    }
+    if (estimativa > 0)
+        posix_fallocate(fd, 0, estimativa);  // Só uma otimização: ignora falhas
+
+    ParteGerador *partes = calloc(numThreads, sizeof(ParteGerador));
+    if (!partes) {
+        fprintf(stderr, "Erro ao alocar memória\n");
+        return 1;
+    }
+    for (int t = 0; t < numThreads; t++) {
+        partes[t].id = t;
+        partes[t].fd = fd;
+    }
 
-    // Cabeçalho
-    fprintf(arquivo, "x,y\n");
+    PoolThreads pool;
+    if (pool_inicializa(&pool, numThreads) != 0) {
+        fprintf(stderr, "Erro ao alocar memória\n");
+        free(partes);
+        close(fd);
+        return 1;
+    }
 
-    // Parâmetros reais da regressão (ex: y = a + b*x)
-    double a = 2.0;
-    double b = 3.5;
+    GET_TIME(inicio);
+    off_t tamanho = binario ? gera_binario(fd, &pool, partes) : gera_csv(fd, &pool, partes);
+    int erro = tamanho < 0 || ftruncate(fd, tamanho) != 0;
+    if (close(fd) != 0)
+        erro = 1;
+    GET_TIME(fim);
+    pool_destroi(&pool);
 
-    for (long i = 0; i < N; i++) {
-        double x = (double)i / 10.0; // valores de X crescentes
-        double ruidoAleatorio = ruido * ((rand() % 1000) / 1000.0 - 0.5) * 2; // [-ruido, +ruido]
-        double y = a + b * x + ruidoAleatorio;
-        fprintf(arquivo, "%.6f,%.6f\n", x, y);
+    for (int t = 0; t < numThreads; t++) {
+        free(partes[t].texto);
+        free(partes[t].x);
+    }
+    free(partes);
+
+    if (erro) {
+        fprintf(stderr, "Erro ao gravar o arquivo %s\n", nomeArquivo);
+        return 1;
     }
 
-    fclose(arquivo);
-    printf("Arquivo '%s' gerado com %ld amostras (ruido = %.2f)\n", nomeArquivo, N, ruido);
+    printf("Arquivo '%s' gerado com %ld amostras (ruido = %.2f%s)\n", nomeArquivo, N, ruido,
+           usaGauss ? ", normal" : "");
+    printf("Threads: %d, semente: %llu, tempo: %f segundos (%.1f milhoes de linhas/s, %.1f MB/s)\n",
+           numThreads, (unsigned long long)semente, fim - inicio,
+           (fim > inicio) ? N / (fim - inicio) / 1e6 : 0.0,
+           (fim > inicio) ? tamanho / (fim - inicio) / 1e6 : 0.0);
     return 0;
 }
@@ -0,0 +1,318 @@
+/* File:     instrumentacao.h
+ *
+ * Purpose:  Registro do tempo de cada fase do programa (leitura, conversão,
+ *           somas, redução, MSE...) e, nas fases executadas pelo pool, do
+ *           início, fim e espera de cada thread, com relatório em texto e
+ *           em JSON (lido pelo benchmark.py).
+ *
+ *           Os tempos vêm de GET_TIME (CLOCK_MONOTONIC, ver timer.h). Por
+ *           thread, em relação à fase (pool->inicioFase/fimFase):
+ *             partida = início da parte - início da fase (acordar a thread)
+ *             execução = fim da parte - início da parte
+ *             espera = fim da fase - fim da parte (parada na barreira)
+ *           O desbalanceamento da fase é a maior execução dividida pela média.
+ *           Nas fases de pool_executa_pedacos também ficam os pedaços que cada
+ *           thread executou e quantos deles roubou de outras filas.
+ *
+ *           Com usaPerf, cada fase medida com instr_abre/instr_fecha também
+ *           guarda ciclos, instruções e faltas no último nível de cache (LLC)
+ *           de todas as threads do processo (perf_event_open com inherit,
+ *           aberto antes de criar as threads). Sem permissão (veja
+ *           /proc/sys/kernel/perf_event_paranoid) ou sem PMU, os contadores
+ *           ficam indisponíveis e só os tempos são registrados. As faltas de
+ *           TLB de dados (leituras) são um contador à parte, opcional: nem
+ *           toda PMU tem o evento, e sem ele os outros continuam valendo.
+ *
+ *           As faltas de página de cada fase (getrusage, sem precisar de
+ *           permissão) são sempre registradas: mostram o efeito das páginas
+ *           grandes de memoria_colunas.h no primeiro toque das colunas.
+ *
+ * Exemplo:
+ *    Instrumentacao instr;
+ *    instr_inicia(&instr, usaPerf);        // Antes de criar qualquer thread
+ *    . . .
+ *    int f = instr_abre(&instr, "somas");
+ *    pool_executa(&pool, N, calcula_somas, NULL, 0);
+ *    instr_fecha(&instr, f, 16.0 * N);
+ *    instr_threads(&instr, f, &pool);
+ *    . . .
+ *    instr_relatorio(&instr, stdout);
+ *    instr_grava_json(&instr, "metricas.json", N, numThreads);
+ *    instr_libera(&instr);
+ */
+#ifndef _INSTRUMENTACAO_H_
+#define _INSTRUMENTACAO_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "timer.h"
+#include "pool_threads.h"
+#include "memoria_colunas.h"
+
+#define INSTR_MAX_FASES 16
+#define INSTR_NUM_PERF  3  // Ciclos, instruções e faltas no LLC
+
+static const char *instr_nomes_perf[INSTR_NUM_PERF] = {"ciclos", "instrucoes", "faltas_llc"};
+
+typedef struct {
+    const char *nome;
+    double inicio, fim;        // Instantes (GET_TIME)
+    double bytes;              // Bytes processados pela fase (0 = não se aplica)
+    int numThreads;            // Partes com tempos por thread (0 = sem detalhe)
+    double *partida, *execucao, *espera;  // Tempos de cada parte (segundos)
+    long *pedacos, *roubados;  // Pedaços executados e roubados por parte (0 fora de pool_executa_pedacos)
+    int temPerf;               // Contadores válidos nesta fase
+    uint64_t perf[INSTR_NUM_PERF];        // Contagens durante a fase
+    uint64_t perfInicio[INSTR_NUM_PERF];  // Leitura dos contadores em instr_abre
+    int temTlb;                // Faltas de dTLB válidas nesta fase
+    uint64_t tlb, tlbInicio;
+    long faltas, faltasInicio; // Faltas de página durante a fase
+} FaseInstr;
+
+typedef struct {
+    double origem;             // Instante de instr_inicia (início do programa)
+    int numFases;
+    FaseInstr fases[INSTR_MAX_FASES];
+    int fdPerf[INSTR_NUM_PERF];  // -1 = contador indisponível
+    int fdTlb;                 // Faltas de dTLB em leituras (-1 = indisponível)
+    int usaPerf;
+} Instrumentacao;
+
+// ==================== CONTADORES DE HARDWARE ====================
+// Abre um contador do processo inteiro (inclusive threads criadas depois)
+static inline int instr_abre_contador(uint32_t tipo, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = tipo;
+    attr.config = config;
+    attr.inherit = 1;          // Soma as threads criadas depois da abertura
+    attr.exclude_kernel = 1;   // Permitido com perf_event_paranoid <= 2
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+// Lê os contadores abertos; retorna 0 se algum não pôde ser lido
+static inline int instr_le_contadores(const Instrumentacao *I, uint64_t *valores) {
+    for (int k = 0; k < INSTR_NUM_PERF; k++) {
+        if (I->fdPerf[k] < 0 || read(I->fdPerf[k], &valores[k], sizeof(uint64_t)) != sizeof(uint64_t))
+            return 0;
+    }
+    return 1;
+}
+
+// ==================== REGISTRO DAS FASES ====================
+static inline void instr_inicia(Instrumentacao *I, int usaPerf) {
+    memset(I, 0, sizeof(*I));
+    GET_TIME(I->origem);
+    const uint64_t eventos[INSTR_NUM_PERF] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES
+    };
+    I->usaPerf = 0;
+    for (int k = 0; k < INSTR_NUM_PERF; k++)
+        I->fdPerf[k] = usaPerf ? instr_abre_contador(PERF_TYPE_HARDWARE, eventos[k]) : -1;
+    I->fdTlb = usaPerf ? instr_abre_contador(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB |
+                                             (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)) : -1;
+    if (usaPerf) {
+        I->usaPerf = 1;
+        for (int k = 0; k < INSTR_NUM_PERF; k++)
+            if (I->fdPerf[k] < 0)
+                I->usaPerf = 0;
+        if (!I->usaPerf)
+            fprintf(stderr, "Aviso: contadores de hardware indisponiveis (perf_event_open); "
+                            "so os tempos serao registrados\n");
+    }
+}
+
+// Fase medida por outra parte do código (ex.: leitor_tempos); retorna o índice ou -1
+static inline int instr_registra(Instrumentacao *I, const char *nome, double inicio, double fim, double bytes) {
+    if (I->numFases == INSTR_MAX_FASES)
+        return -1;
+    FaseInstr *f = &I->fases[I->numFases];
+    memset(f, 0, sizeof(*f));
+    f->nome = nome;
+    f->inicio = inicio;
+    f->fim = fim;
+    f->bytes = bytes;
+    return I->numFases++;
+}
+
+// Começa uma fase agora; retorna o índice (para instr_fecha) ou -1
+static inline int instr_abre(Instrumentacao *I, const char *nome) {
+    double agora;
+    GET_TIME(agora);
+    int idx = instr_registra(I, nome, agora, agora, 0);
+    if (idx < 0)
+        return idx;
+    FaseInstr *f = &I->fases[idx];
+    f->faltasInicio = memoria_faltas();
+    if (I->usaPerf)
+        f->temPerf = instr_le_contadores(I, f->perfInicio);
+    f->temTlb = I->fdTlb >= 0 && read(I->fdTlb, &f->tlbInicio, sizeof(uint64_t)) == sizeof(uint64_t);
+    return idx;
+}
+
+static inline void instr_fecha(Instrumentacao *I, int idx, double bytes) {
+    if (idx < 0)
+        return;
+    FaseInstr *f = &I->fases[idx];
+    GET_TIME(f->fim);
+    f->bytes = bytes;
+    f->faltas = memoria_faltas() - f->faltasInicio;
+    uint64_t tlb;
+    if (f->temTlb && read(I->fdTlb, &tlb, sizeof(uint64_t)) == sizeof(uint64_t))
+        f->tlb = tlb - f->tlbInicio;
+    else
+        f->temTlb = 0;
+    uint64_t agora[INSTR_NUM_PERF];
+    if (f->temPerf && instr_le_contadores(I, agora)) {
+        for (int k = 0; k < INSTR_NUM_PERF; k++)
+            f->perf[k] = agora[k] - f->perfInicio[k];
+    } else {
+        f->temPerf = 0;
+    }
+}
+
+// Copia os tempos por thread da última fase executada pelo pool
+static inline void instr_threads(Instrumentacao *I, int idx, const PoolThreads *pool) {
+    if (idx < 0)
+        return;
+    FaseInstr *f = &I->fases[idx];
+    int n = pool->numThreads;
+    free(f->partida);
+    free(f->pedacos);
+    f->partida = malloc(3 * n * sizeof(double));
+    f->pedacos = malloc(2 * n * sizeof(long));
+    if (!f->partida || !f->pedacos) {
+        free(f->partida);
+        free(f->pedacos);
+        f->partida = NULL;
+        f->pedacos = NULL;
+        f->numThreads = 0;
+        return;
+    }
+    f->roubados = f->pedacos + n;
+    f->execucao = f->partida + n;
+    f->espera = f->execucao + n;
+    for (int t = 0; t < n; t++) {
+        f->partida[t] = pool->inicioParte[t] - pool->inicioFase;
+        f->execucao[t] = pool->fimParte[t] - pool->inicioParte[t];
+        f->espera[t] = pool->fimFase - pool->fimParte[t];
+        f->pedacos[t] = pool->filas ? pool->filas[t].executados : 0;
+        f->roubados[t] = pool->filas ? pool->filas[t].roubados : 0;
+    }
+    f->numThreads = n;
+}
+
+// Maior execução / execução média das threads da fase (1 = perfeitamente balanceada)
+static inline double instr_desbalanceamento(const FaseInstr *f) {
+    double soma = 0, maior = 0;
+    for (int t = 0; t < f->numThreads; t++) {
+        soma += f->execucao[t];
+        if (f->execucao[t] > maior)
+            maior = f->execucao[t];
+    }
+    return (soma > 0) ? maior * f->numThreads / soma : 1.0;
+}
+
+// ==================== RELATÓRIOS ====================
+static inline void instr_relatorio(const Instrumentacao *I, FILE *saida) {
+    fprintf(saida, "\n=== FASES ===\n");
+    for (int i = 0; i < I->numFases; i++) {
+        const FaseInstr *f = &I->fases[i];
+        double duracao = f->fim - f->inicio;
+        fprintf(saida, "%-10s %f segundos (inicio em %f)", f->nome, duracao, f->inicio - I->origem);
+        if (f->bytes > 0 && duracao > 0)
+            fprintf(saida, ", %.2f GB/s", f->bytes / duracao / 1e9);
+        if (f->temPerf)
+            fprintf(saida, ", %.0f Mciclos, IPC %.2f, %.2f M faltas LLC",
+                    f->perf[0] / 1e6, f->perf[0] ? (double)f->perf[1] / f->perf[0] : 0.0,
+                    f->perf[2] / 1e6);
+        if (f->temTlb)
+            fprintf(saida, ", %.2f M faltas dTLB", f->tlb / 1e6);
+        if (f->faltas > 0)
+            fprintf(saida, ", %ld faltas de pagina", f->faltas);
+        fprintf(saida, "\n");
+        if (f->numThreads > 0) {
+            double partidaMax = 0, esperaMax = 0;
+            long pedacos = 0, roubados = 0;
+            for (int t = 0; t < f->numThreads; t++) {
+                if (f->partida[t] > partidaMax) partidaMax = f->partida[t];
+                if (f->espera[t] > esperaMax) esperaMax = f->espera[t];
+                pedacos += f->pedacos[t];
+                roubados += f->roubados[t];
+            }
+            fprintf(saida, "           %d threads: desbalanceamento %.2f, partida ate %.1f us, "
+                    "espera ate %.1f us", f->numThreads, instr_desbalanceamento(f),
+                    partidaMax * 1e6, esperaMax * 1e6);
+            if (pedacos > 0)
+                fprintf(saida, ", %ld de %ld pedacos roubados", roubados, pedacos);
+            fprintf(saida, "\n");
+        }
+    }
+    if (!I->usaPerf)
+        fprintf(saida, "Contadores de hardware: nao medidos\n");
+}
+
+// Grava as fases em JSON; retorna 0 em sucesso
+static inline int instr_grava_json(const Instrumentacao *I, const char *arquivo, long N, int numThreads) {
+    FILE *f = fopen(arquivo, "w");
+    if (!f) {
+        perror("Erro ao criar o arquivo de metricas");
+        return -1;
+    }
+    fprintf(f, "{\n  \"pontos\": %ld,\n  \"threads\": %d,\n  \"perf\": %s,\n  \"fases\": [",
+            N, numThreads, I->usaPerf ? "true" : "false");
+    for (int i = 0; i < I->numFases; i++) {
+        const FaseInstr *fase = &I->fases[i];
+        double duracao = fase->fim - fase->inicio;
+        fprintf(f, "%s\n    {\"nome\": \"%s\", \"inicio\": %.9f, \"duracao\": %.9f, \"bytes\": %.0f",
+                i ? "," : "", fase->nome, fase->inicio - I->origem, duracao, fase->bytes);
+        if (fase->bytes > 0 && duracao > 0)
+            fprintf(f, ", \"bytes_por_s\": %.0f", fase->bytes / duracao);
+        if (fase->temPerf)
+            for (int k = 0; k < INSTR_NUM_PERF; k++)
+                fprintf(f, ", \"%s\": %llu", instr_nomes_perf[k], (unsigned long long)fase->perf[k]);
+        if (fase->temTlb)
+            fprintf(f, ", \"faltas_dtlb\": %llu", (unsigned long long)fase->tlb);
+        fprintf(f, ", \"faltas_pagina\": %ld", fase->faltas);
+        if (fase->numThreads > 0) {
+            fprintf(f, ", \"desbalanceamento\": %.4f,\n     \"por_thread\": [",
+                    instr_desbalanceamento(fase));
+            for (int t = 0; t < fase->numThreads; t++)
+                fprintf(f, "%s{\"thread\": %d, \"partida\": %.9f, \"execucao\": %.9f, \"espera\": %.9f, "
+                        "\"pedacos\": %ld, \"roubados\": %ld}",
+                        t ? ", " : "", t, fase->partida[t], fase->execucao[t], fase->espera[t],
+                        fase->pedacos[t], fase->roubados[t]);
+            fprintf(f, "]");
+        }
+        fprintf(f, "}");
+    }
+    fprintf(f, "\n  ]\n}\n");
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+static inline void instr_libera(Instrumentacao *I) {
+    for (int i = 0; i < I->numFases; i++) {
+        free(I->fases[i].partida);
+        free(I->fases[i].pedacos);
+        I->fases[i].partida = NULL;
+        I->fases[i].pedacos = NULL;
+    }
+    for (int k = 0; k < INSTR_NUM_PERF; k++) {
+        if (I->fdPerf[k] >= 0)
+            close(I->fdPerf[k]);
+        I->fdPerf[k] = -1;
+    }
+    if (I->fdTlb >= 0)
+        close(I->fdTlb);
+    I->fdTlb = -1;
+}
+
+#endif
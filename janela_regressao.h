@@ -0,0 +1,192 @@
+/* File:     janela_regressao.h
+ *
+ * Purpose:  Regressão sobre um fluxo de pontos, atualizada a cada ponto em
+ *           O(1) e com memória limitada:
+ *             - janela deslizante: só os últimos W pontos (buffer circular);
+ *             - decaimento exponencial (EWMA): o peso de um ponto cai pela
+ *               metade a cada "meia-vida" pontos; não guarda pontos.
+ *
+ *           Os momentos são atualizados pela fórmula de Welford (e a inversa
+ *           dela para tirar o ponto mais antigo da janela). Para o MSE não
+ *           sair de Syy - Sxy²/Sxx, que perde quase todos os dígitos quando
+ *           o ajuste é bom (ver estatisticas.h), os momentos não são de y e
+ *           sim do resíduo e = y - B0·x em relação a uma inclinação de
+ *           referência B0. Com B0 perto da inclinação atual, See e Sxe são
+ *           da ordem do SSE e a subtração See - Sxe²/Sxx fica exata.
+ *           janela_reancora troca B0 pela inclinação atual (transformação
+ *           exata dos momentos) a cada JANELA_REANCORA pontos.
+ *
+ *           Na janela deslizante, somar e tirar pontos acumula arredondamento;
+ *           a cada W pontos os momentos são recalculados do buffer em duas
+ *           passadas, o que custa O(1) amortizado por ponto.
+ *
+ * Exemplo:
+ *    JanelaRegressao j;
+ *    janela_inicializa(&j, 100000);       // ou janela_inicializa_ewma(&j, 50000)
+ *    while (le_ponto(&x, &y)) {
+ *        janela_adiciona(&j, x, y);
+ *        if (++n % 10000 == 0) {
+ *            janela_resultado(&j, &A, &B, &MSE);
+ *            . . .
+ *        }
+ *    }
+ *    janela_libera(&j);
+ */
+#ifndef _JANELA_REGRESSAO_H_
+#define _JANELA_REGRESSAO_H_
+
+#include <stdlib.h>
+#include <math.h>
+
+#define JANELA_REANCORA 1024  // Pontos entre trocas da inclinação de referência
+
+typedef struct {
+    long capacidade;         // W (0 = decaimento exponencial)
+    double *x, *y;           // Buffer circular com os pontos da janela
+    long inicio, ocupados;   // Posição do mais antigo e quantos pontos há
+    long desdeRecalculo;     // Pontos adicionados desde o último recálculo
+    double lambda;           // Fator de decaimento por ponto (EWMA)
+    double peso;             // Número de pontos ou soma dos pesos (EWMA)
+    double B0;               // Inclinação de referência: e = y - B0*x
+    double mediaX, mediaE;   // x̄ e ē
+    double Sxx, Sxe, See;    // Σ(x-x̄)², Σ(x-x̄)(e-ē), Σ(e-ē)² (ponderadas no EWMA)
+} JanelaRegressao;
+
+// Janela dos últimos W pontos. Retorna 0 ou -1 se faltar memória
+static inline int janela_inicializa(JanelaRegressao *j, long W) {
+    *j = (JanelaRegressao){0};
+    j->capacidade = W;
+    j->x = malloc(W * sizeof(double));
+    j->y = malloc(W * sizeof(double));
+    if (!j->x || !j->y) {
+        free(j->x);
+        free(j->y);
+        return -1;
+    }
+    return 0;
+}
+
+// Decaimento exponencial: o peso de um ponto cai pela metade a cada meiaVida pontos
+static inline void janela_inicializa_ewma(JanelaRegressao *j, double meiaVida) {
+    *j = (JanelaRegressao){0};
+    j->lambda = pow(0.5, 1.0 / meiaVida);
+}
+
+static inline void janela_libera(JanelaRegressao *j) {
+    free(j->x);
+    free(j->y);
+}
+
+// Troca B0 pela inclinação atual. Com e' = e - δx e δ = Sxe/Sxx:
+//   ē' = ē - δx̄,  Sxe' = Sxe - δSxx = 0,  See' = See - δSxe
+static inline void janela_reancora(JanelaRegressao *j) {
+    if (!(j->Sxx > 0))
+        return;
+    double delta = j->Sxe / j->Sxx;
+    j->B0 += delta;
+    j->mediaE -= delta * j->mediaX;
+    j->See -= delta * j->Sxe;
+    if (j->See < 0)
+        j->See = 0;
+    j->Sxe = 0;
+}
+
+// Recalcula os momentos dos pontos do buffer em duas passadas (como momentos_bloco)
+static inline void janela_recalcula(JanelaRegressao *j) {
+    long n = j->ocupados, W = j->capacidade;
+    double somaX = 0, somaE = 0;
+    for (long k = 0, i = j->inicio; k < n; k++, i = (i + 1 == W) ? 0 : i + 1) {
+        somaX += j->x[i];
+        somaE += j->y[i] - j->B0 * j->x[i];
+    }
+    double mx = somaX / n, me = somaE / n;
+
+    double dX = 0, dE = 0, Sxx = 0, Sxe = 0, See = 0;
+    for (long k = 0, i = j->inicio; k < n; k++, i = (i + 1 == W) ? 0 : i + 1) {
+        double dx = j->x[i] - mx;
+        double de = (j->y[i] - j->B0 * j->x[i]) - me;
+        dX  += dx;
+        dE  += de;
+        Sxx += dx * dx;
+        Sxe += dx * de;
+        See += de * de;
+    }
+
+    j->peso = n;
+    j->mediaX = mx;
+    j->mediaE = me;
+    j->Sxx = Sxx - dX * dX / n;
+    j->Sxe = Sxe - dX * dE / n;
+    j->See = See - dE * dE / n;
+}
+
+// Welford ponderado: os pesos antigos são multiplicados por fator (1 na janela)
+static inline void janela_soma_ponto(JanelaRegressao *j, double x, double e, double fator) {
+    j->peso = fator * j->peso + 1.0;
+    double dx = x - j->mediaX, de = e - j->mediaE;
+    j->mediaX += dx / j->peso;
+    j->mediaE += de / j->peso;
+    j->Sxx = fator * j->Sxx + dx * (x - j->mediaX);
+    j->Sxe = fator * j->Sxe + dx * (e - j->mediaE);
+    j->See = fator * j->See + de * (e - j->mediaE);
+}
+
+// Inversa de janela_soma_ponto (fator 1): tira um ponto que está na janela
+static inline void janela_tira_ponto(JanelaRegressao *j, double x, double e) {
+    j->peso -= 1.0;
+    if (j->peso <= 0) {
+        j->peso = j->mediaX = j->mediaE = j->Sxx = j->Sxe = j->See = 0;
+        return;
+    }
+    double dx = x - j->mediaX, de = e - j->mediaE;
+    j->mediaX -= dx / j->peso;
+    j->mediaE -= de / j->peso;
+    j->Sxx -= dx * (x - j->mediaX);
+    j->Sxe -= dx * (e - j->mediaE);
+    j->See -= de * (e - j->mediaE);
+}
+
+static inline void janela_adiciona(JanelaRegressao *j, double x, double y) {
+    if (j->capacidade == 0) {
+        janela_soma_ponto(j, x, y - j->B0 * x, j->lambda);
+        if (++j->desdeRecalculo == JANELA_REANCORA) {
+            janela_reancora(j);
+            j->desdeRecalculo = 0;
+        }
+        return;
+    }
+
+    long W = j->capacidade, fim = j->inicio + j->ocupados;
+    if (fim >= W)
+        fim -= W;
+    if (j->ocupados == W) {
+        // Janela cheia: o novo ponto ocupa a posição do mais antigo
+        janela_tira_ponto(j, j->x[fim], j->y[fim] - j->B0 * j->x[fim]);
+        j->inicio = (fim + 1 == W) ? 0 : fim + 1;
+    } else {
+        j->ocupados++;
+    }
+    j->x[fim] = x;
+    j->y[fim] = y;
+    janela_soma_ponto(j, x, y - j->B0 * x, 1.0);
+
+    j->desdeRecalculo++;
+    if (j->desdeRecalculo % JANELA_REANCORA == 0)
+        janela_reancora(j);
+    if (j->desdeRecalculo >= W) {
+        janela_reancora(j);
+        janela_recalcula(j);
+        j->desdeRecalculo = 0;
+    }
+}
+
+// Coeficientes e MSE dos pontos da janela (ponderados no EWMA)
+static inline void janela_resultado(const JanelaRegressao *j, double *A, double *B, double *MSE) {
+    double delta = (j->Sxx > 0) ? j->Sxe / j->Sxx : 0.0;
+    double sse = j->See - delta * j->Sxe;
+    *B = j->B0 + delta;
+    *A = j->mediaE - delta * j->mediaX;  // ȳ - B·x̄ = ē + B0·x̄ - B·x̄
+    *MSE = (j->peso > 0 && sse > 0) ? sse / j->peso : 0.0;
+}
+
+#endif
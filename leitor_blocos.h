@@ -0,0 +1,381 @@
+/* File:     leitor_blocos.h
+ *
+ * Purpose:  Passada por um arquivo (CSV ou binário) maior que a memória, em
+ *           blocos de tamanho fixo, com leitura antecipada.
+ *
+ *           Uma thread de leitura enche dois buffers alternadamente: enquanto
+ *           as threads do pool convertem e processam o bloco k, o bloco k+1
+ *           já está sendo lido do disco. A memória usada é só a dos dois
+ *           buffers e dos lotes de cada thread, independente do arquivo.
+ *
+ *           CSV: cada bloco termina no último '\n' lido; o resto (início de
+ *           uma linha) é copiado para o começo do próximo buffer. As threads
+ *           dividem o bloco em faixas alinhadas em linhas e entregam os pontos
+ *           em lotes de até LEITOR_LOTE (como percorre_csv_paralelo).
+ *
+ *           Binário: cada bloco traz o mesmo trecho das colunas X e Y (duas
+ *           leituras) e cada thread recebe uma fatia contígua dele.
+ *
+ *           Se a thread de leitura não puder ser criada, a passada continua
+ *           sem leitura antecipada: cada bloco é lido pela thread chamadora
+ *           logo antes do seu cálculo (toda a leitura vira espera).
+ *
+ *           A função de processamento é a mesma do modo fluxo (LeitorProcessaLote)
+ *           e a thread t recebe sempre o contexto t.
+ *
+ * Exemplo:
+ *    ResumoBlocos resumo;
+ *    N = percorre_blocos(nomeArquivo, &pool, blocos_capacidade(limite, numThreads),
+ *                        lote_somas, parciais, sizeof(Parcial), &resumo);
+ */
+#ifndef _LEITOR_BLOCOS_H_
+#define _LEITOR_BLOCOS_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "timer.h"
+#include "leitor_csv.h"
+#include "formato_binario.h"
+#include "pool_threads.h"
+
+#define BLOCOS_MINIMO (1 << 20)  // Menor buffer aceito (bytes)
+
+// Medidas de uma passada
+typedef struct {
+    long blocos;            // Blocos processados
+    double bytes;           // Bytes lidos do arquivo
+    double tempo;           // Duração da passada (segundos)
+    double esperaLeitura;   // Tempo em que o cálculo ficou parado esperando o disco
+} ResumoBlocos;
+
+typedef struct {
+    char *dados;
+    size_t usados;   // CSV: bytes com linhas completas; binário: 16 * pontos
+    long pontos;     // Binário: pontos no bloco
+    size_t resto;    // CSV: bytes depois de usados (início da linha do próximo bloco)
+    int cheio;       // Pronto para o cálculo
+    int ultimo;      // Último bloco do arquivo
+} BufferBloco;
+
+typedef struct {
+    int fd, binario;
+    off_t tamanho, pos;        // CSV: tamanho do arquivo e próxima posição a ler
+    long N, proximo;           // Binário: pontos no arquivo e próximo ponto a ler
+    size_t capacidade;         // Bytes de cada buffer
+    BufferBloco buf[2];
+    pthread_mutex_t trava;
+    pthread_cond_t mudou;
+    int erro, cancelado;
+} LeitorBlocos;
+
+// Argumento de cada parte do pool
+typedef struct {
+    const BufferBloco *bloco;
+    int binario, numThreads;
+    long id;
+    double *loteX, *loteY;         // Lotes do CSV (LEITOR_LOTE pontos)
+    LeitorProcessaLote processa;
+    void *contexto;
+    long validos;                  // Pontos entregues (acumulado na passada)
+} ArgsBlocos;
+
+// Tamanho de cada um dos dois buffers para caber em limite bytes junto com
+// os lotes das threads. Retorna 0 se o limite for pequeno demais
+static inline size_t blocos_capacidade(size_t limite, int numThreads) {
+    size_t lotes = (size_t)numThreads * 2 * LEITOR_LOTE * sizeof(double);
+    if (limite < lotes + 2 * (size_t)BLOCOS_MINIMO)
+        return 0;
+    return ((limite - lotes) / 2) & ~(size_t)4095;  // Múltiplo de página (e de 16)
+}
+
+// ==================== THREAD DE LEITURA ANTECIPADA ====================
+static inline int blocos_le_tudo(int fd, char *destino, size_t tam, off_t pos) {
+    while (tam > 0) {
+        ssize_t lidos = pread(fd, destino, tam, pos);
+        if (lidos <= 0)
+            return -1;
+        destino += lidos;
+        pos += lidos;
+        tam -= lidos;
+    }
+    return 0;
+}
+
+// Enche o buffer b com o próximo bloco. Retorna 0 ou -1 em erro
+static inline int blocos_enche(LeitorBlocos *L, BufferBloco *b, const BufferBloco *anterior) {
+    if (L->binario) {
+        long k = (long)(L->capacidade / (2 * sizeof(double)));
+        if (k > L->N - L->proximo)
+            k = L->N - L->proximo;
+        off_t baseX = sizeof(CabecalhoBinario) + L->proximo * sizeof(double);
+        off_t baseY = baseX + binario_tam_coluna(L->N, sizeof(double));
+        if (blocos_le_tudo(L->fd, b->dados, k * sizeof(double), baseX) != 0 ||
+            blocos_le_tudo(L->fd, b->dados + k * sizeof(double), k * sizeof(double), baseY) != 0)
+            return -1;
+        L->proximo += k;
+        b->pontos = k;
+        b->usados = 2 * k * sizeof(double);
+        b->ultimo = (L->proximo == L->N);
+        return 0;
+    }
+
+    // CSV: começa com o resto do bloco anterior (linha incompleta)
+    size_t resto = anterior ? anterior->resto : 0;
+    if (resto > 0)
+        memcpy(b->dados, anterior->dados + anterior->usados, resto);
+    size_t quer = L->capacidade - resto;
+    if ((off_t)quer > L->tamanho - L->pos)
+        quer = L->tamanho - L->pos;
+    if (quer > 0 && blocos_le_tudo(L->fd, b->dados + resto, quer, L->pos) != 0)
+        return -1;
+    L->pos += quer;
+    size_t total = resto + quer;
+
+    b->ultimo = (L->pos >= L->tamanho);
+    if (b->ultimo) {
+        b->usados = total;   // A última linha pode não ter '\n'
+        b->resto = 0;
+        return 0;
+    }
+    size_t usados = total;
+    while (usados > 0 && b->dados[usados - 1] != '\n')
+        usados--;
+    if (usados == 0) {
+        fprintf(stderr, "Erro: linha maior que o bloco de %zu bytes\n", L->capacidade);
+        return -1;
+    }
+    b->usados = usados;
+    b->resto = total - usados;
+    return 0;
+}
+
+static inline void *blocos_thread_leitura(void *arg) {
+    LeitorBlocos *L = (LeitorBlocos *)arg;
+    const BufferBloco *anterior = NULL;
+
+    for (long k = 0;; k++) {
+        BufferBloco *b = &L->buf[k & 1];
+
+        pthread_mutex_lock(&L->trava);
+        while (b->cheio && !L->cancelado)
+            pthread_cond_wait(&L->mudou, &L->trava);
+        int cancelado = L->cancelado;
+        pthread_mutex_unlock(&L->trava);
+        if (cancelado)
+            break;
+
+        // O buffer anterior ainda não é sobrescrito: só no bloco k+1
+        int erro = blocos_enche(L, b, anterior) != 0;
+
+        pthread_mutex_lock(&L->trava);
+        if (erro) {
+            L->erro = 1;
+            b->ultimo = 1;
+        }
+        b->cheio = 1;
+        pthread_cond_broadcast(&L->mudou);
+        pthread_mutex_unlock(&L->trava);
+        if (b->ultimo)
+            break;
+        anterior = b;
+    }
+    return NULL;
+}
+
+// ==================== PROCESSAMENTO DE UM BLOCO ====================
+// Início da faixa t de T de um bloco CSV (a faixa T é o fim do bloco)
+static inline const char *blocos_limite(const BufferBloco *b, long t, long T) {
+    const char *dados = b->dados, *fimDados = b->dados + b->usados;
+    if (t == 0)
+        return dados;
+    if (t == T)
+        return fimDados;
+    const char *alvo = dados + (size_t)((double)b->usados * t / T);
+    if (alvo == dados)
+        return dados;
+    const char *nl = memchr(alvo - 1, '\n', fimDados - (alvo - 1));
+    return nl ? nl + 1 : fimDados;
+}
+
+static inline void *blocos_processa_parte(void *arg) {
+    ArgsBlocos *args = (ArgsBlocos *)arg;
+    const BufferBloco *b = args->bloco;
+    long id = args->id, T = args->numThreads;
+
+    if (args->binario) {
+        const double *vx = (const double *)b->dados, *vy = vx + b->pontos;
+        long inicio = id * b->pontos / T, fim = (id + 1) * b->pontos / T;
+        if (fim > inicio) {
+            args->processa(vx + inicio, vy + inicio, fim - inicio, args->contexto);
+            args->validos += fim - inicio;
+        }
+        return NULL;
+    }
+
+    // Faixa desta parte: os dois limites são avançados até o início de uma linha
+    const char *p = blocos_limite(b, id, T);
+    const char *fim = blocos_limite(b, id + 1, T);
+
+    long n = 0;
+    while (p < fim) {
+        const char *nl = memchr(p, '\n', fim - p);
+        if (!nl)
+            nl = fim;
+        if (leitor_converte_linha_rapida(p, nl, &args->loteX[n], &args->loteY[n]) &&
+            ++n == LEITOR_LOTE) {
+            args->processa(args->loteX, args->loteY, n, args->contexto);
+            args->validos += n;
+            n = 0;
+        }
+        p = nl + 1;
+    }
+    if (n > 0) {
+        args->processa(args->loteX, args->loteY, n, args->contexto);
+        args->validos += n;
+    }
+    return NULL;
+}
+
+// ==================== PASSADA PELO ARQUIVO ====================
+// Uma passada pelo arquivo com buffers de capacidade bytes. A parte t do pool
+// chama processa com (char *)contextos + t * tamContexto. Retorna o total de
+// pontos ou -1 em erro. resumo pode ser NULL
+static inline long percorre_blocos(const char *nomeArquivo, PoolThreads *pool, size_t capacidade,
+                                   LeitorProcessaLote processa, void *contextos, size_t tamContexto,
+                                   ResumoBlocos *resumo) {
+    LeitorBlocos L = {0};
+    struct stat info;
+    int T = pool->numThreads;
+    double inicio, fim, antes, depois, espera = 0;
+
+    GET_TIME(inicio);
+    L.fd = open(nomeArquivo, O_RDONLY);
+    if (L.fd < 0) {
+        perror("Erro ao abrir o arquivo");
+        return -1;
+    }
+    if (fstat(L.fd, &info) != 0 || info.st_size == 0) {
+        fprintf(stderr, "Erro: arquivo vazio\n");
+        close(L.fd);
+        return -1;
+    }
+    posix_fadvise(L.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    L.tamanho = info.st_size;
+    L.capacidade = capacidade;
+    L.binario = eh_arquivo_binario(nomeArquivo);
+    if (L.binario) {
+        CabecalhoBinario cab;
+        if (pread(L.fd, &cab, sizeof(cab), 0) != sizeof(cab) || cab.versao != BINARIO_VERSAO ||
+            binario_tam_elemento(cab.tipo) != sizeof(double) ||
+            !binario_tamanho_valido(&cab, sizeof(double), info.st_size)) {
+            fprintf(stderr, "Erro: cabecalho de %s incompativel\n", nomeArquivo);
+            close(L.fd);
+            return -1;
+        }
+        L.N = (long)cab.n;
+    } else {
+        L.pos = leitor_proxima_linha(L.fd, 0, L.tamanho);  // Pula o cabeçalho
+    }
+
+    L.buf[0].dados = malloc(capacidade);
+    L.buf[1].dados = malloc(capacidade);
+    ArgsBlocos *args = calloc(T, sizeof(ArgsBlocos));
+    double *lotes = malloc((size_t)T * 2 * LEITOR_LOTE * sizeof(double));
+    if (!L.buf[0].dados || !L.buf[1].dados || !args || !lotes) {
+        fprintf(stderr, "Erro ao alocar os buffers de leitura\n");
+        free(L.buf[0].dados); free(L.buf[1].dados); free(args); free(lotes);
+        close(L.fd);
+        return -1;
+    }
+    for (int t = 0; t < T; t++) {
+        args[t].binario = L.binario;
+        args[t].numThreads = T;
+        args[t].id = t;
+        args[t].loteX = lotes + (size_t)t * 2 * LEITOR_LOTE;
+        args[t].loteY = args[t].loteX + LEITOR_LOTE;
+        args[t].processa = processa;
+        args[t].contexto = (char *)contextos + t * tamContexto;
+    }
+    pthread_mutex_init(&L.trava, NULL);
+    pthread_cond_init(&L.mudou, NULL);
+
+    pthread_t leitora;
+    int comLeitora = pthread_create(&leitora, NULL, blocos_thread_leitura, &L) == 0;
+    if (!comLeitora)
+        fprintf(stderr, "Aviso: thread de leitura nao criada; blocos lidos sem leitura antecipada\n");
+
+    long blocos = 0;
+    double bytes = 0;
+    for (long k = 0;; k++) {
+        BufferBloco *b = &L.buf[k & 1];
+
+        GET_TIME(antes);
+        if (!comLeitora) {
+            // O bloco anterior (outro buffer) ainda guarda o resto da última linha
+            if (blocos_enche(&L, b, k > 0 ? &L.buf[(k - 1) & 1] : NULL) != 0)
+                L.erro = 1;
+            b->cheio = 1;
+        }
+        pthread_mutex_lock(&L.trava);
+        while (!b->cheio)
+            pthread_cond_wait(&L.mudou, &L.trava);
+        int erro = L.erro;
+        pthread_mutex_unlock(&L.trava);
+        GET_TIME(depois);
+        espera += depois - antes;
+        if (erro)
+            break;
+
+        for (int t = 0; t < T; t++)
+            args[t].bloco = b;
+        long trabalho = L.binario ? b->pontos : (long)(b->usados / 16);
+        pool_executa(pool, trabalho, blocos_processa_parte, args, sizeof(ArgsBlocos));
+        blocos++;
+        bytes += b->usados;
+
+        int ultimo = b->ultimo;
+        pthread_mutex_lock(&L.trava);
+        b->cheio = 0;
+        pthread_cond_broadcast(&L.mudou);
+        pthread_mutex_unlock(&L.trava);
+        if (ultimo)
+            break;
+    }
+
+    if (comLeitora) {
+        pthread_mutex_lock(&L.trava);
+        L.cancelado = 1;
+        pthread_cond_broadcast(&L.mudou);
+        pthread_mutex_unlock(&L.trava);
+        pthread_join(leitora, NULL);
+    }
+
+    long N = 0;
+    for (int t = 0; t < T; t++)
+        N += args[t].validos;
+    if (L.erro) {
+        fprintf(stderr, "Erro ao ler o arquivo %s\n", nomeArquivo);
+        N = -1;
+    }
+
+    pthread_mutex_destroy(&L.trava);
+    pthread_cond_destroy(&L.mudou);
+    free(L.buf[0].dados);
+    free(L.buf[1].dados);
+    free(args);
+    free(lotes);
+    close(L.fd);
+
+    GET_TIME(fim);
+    if (resumo) {
+        resumo->blocos = blocos;
+        resumo->bytes = bytes;
+        resumo->tempo = fim - inicio;
+        resumo->esperaLeitura = espera;
+    }
+    return N;
+}
+
+#endif
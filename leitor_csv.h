@@ -0,0 +1,774 @@
+/* File:     leitor_csv.h
+ *
+ * Purpose:  Leitura paralela de arquivos CSV no formato "x,y" (com uma
+ *           linha de cabeçalho) diretamente para os arrays X e Y.
+ *
+ *           O arquivo é dividido em numThreads faixas de bytes. Cada faixa
+ *           é ajustada para começar logo após um '\n', de modo que nenhuma
+ *           linha fique dividida entre duas threads. A leitura acontece em
+ *           duas etapas separadas por uma barreira:
+ *             1. cada thread lê sua faixa (pread) e conta as linhas;
+ *             2. com as contagens, cada thread sabe a posição inicial do
+ *                seu pedaço em X/Y e converte as linhas direto para lá.
+ *
+ *           carrega_csv_mmap faz o mesmo sobre o arquivo mapeado em memória
+ *           (sem cópia para buffers) e converte os números com
+ *           leitor_converte_decimal, que não passa pelo strtod/sscanf.
+ *
+ *           percorre_csv_paralelo não materializa X/Y: cada thread lê sua
+ *           faixa em blocos de LEITOR_BLOCO_FLUXO bytes e entrega os pontos
+ *           em lotes de até LEITOR_LOTE a uma função de processamento. A
+ *           memória usada é fixa, independente do tamanho do arquivo.
+ *
+ *           X e Y vêm de colunas_aloca (memoria_colunas.h), já no tamanho
+ *           contado na etapa 1: alinhadas em 64 bytes e, com REGRESSAO_PAGINAS
+ *           thp/hugetlb, em páginas de 2 MB. Devem ser liberadas com
+ *           colunas_libera(X).
+ *
+ *           Os instantes (GET_TIME) do início, da passagem da etapa 1 para a
+ *           2 e do fim da última leitura ficam em leitor_tempos, para separar
+ *           o tempo de leitura do tempo de conversão, junto com as faltas de
+ *           página da leitura (o primeiro toque em X e Y é na conversão).
+ *
+ *           Se pthread_create falha no meio, a leitura segue com as threads
+ *           já criadas: nas leituras com barreira elas esperam num portão
+ *           (mutex) até as faixas e a barreira serem refeitas para o número
+ *           criado; no modo fluxo as faixas sem thread rodam na chamadora.
+ *
+ *           carrega_csv_colunas lê um CSV com qualquer número de colunas
+ *           (x1,...,xp,y; o número vem do cabeçalho) para uma matriz em
+ *           ordem de linha, com as mesmas duas etapas sobre o arquivo mapeado.
+ *
+ * Exemplo:
+ *    #include "leitor_csv.h"
+ *    . . .
+ *    N = carrega_csv_paralelo(nomeArquivo, numThreads, &X, &Y);
+ *    if (N < 0) return 1;
+ */
+#ifndef _LEITOR_CSV_H_
+#define _LEITOR_CSV_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "timer.h"
+#include "memoria_colunas.h"
+
+#define LEITOR_BLOCO_BUSCA 256  // Bytes lidos por vez ao procurar o fim de uma linha
+#define LEITOR_MAX_NUMERO  64   // Maior número (em caracteres) repassado ao strtod
+#define LEITOR_BLOCO_FLUXO (1 << 20)  // Buffer de cada thread no modo fluxo (bytes)
+#define LEITOR_LOTE        4096       // Pontos entregues por chamada no modo fluxo
+
+// Estado compartilhado entre as threads de leitura
+typedef struct {
+    int fd;                  // Descritor do arquivo CSV
+    const char *mapa;        // Arquivo mapeado (modo mmap) ou NULL (modo pread)
+    int numThreads;          // Número de threads de leitura
+    off_t *limites;          // Faixa da thread t: [limites[t], limites[t+1])
+    long *linhas;            // Linhas encontradas na faixa de cada thread (-1 = erro)
+    long *validos;           // Pontos convertidos com sucesso por cada thread
+    double *X, *Y;           // Arrays de saída (alocados pela thread 0)
+    int erro;                // Diferente de zero se alguma etapa falhou
+    double inicioConversao;  // Instante em que a etapa 2 começou (GET_TIME)
+    pthread_barrier_t barreira;
+    pthread_mutex_t portao;  // Travado enquanto as threads são criadas (leitor_cria_threads)
+} LeitorCSV;
+
+// Instantes da última leitura com leitor_carrega: leitura = [inicio, conversao),
+// conversão = [conversao, fim); faltas = faltas de página do processo no período
+static struct {
+    double inicio, conversao, fim;
+    long faltas;
+} leitor_tempos;
+
+// Argumento de cada thread de leitura
+typedef struct {
+    LeitorCSV *leitor;
+    long id;
+} ArgsLeitor;
+
+// Cria até n threads funcao(args + t·tamArg) e retorna quantas foram criadas.
+// Na primeira falha de pthread_create as demais não são tentadas: o chamador
+// divide o trabalho entre as criadas (ou faz tudo na própria thread)
+static inline int leitor_cria_threads(pthread_t *threads, int n, void *(*funcao)(void *),
+                                      void *args, size_t tamArg) {
+    int criadas = 0;
+    while (criadas < n &&
+           pthread_create(&threads[criadas], NULL, funcao, (char *)args + criadas * tamArg) == 0)
+        criadas++;
+    if (criadas < n)
+        fprintf(stderr, "Aviso: so foi possivel criar %d de %d threads de leitura\n", criadas, n);
+    return criadas;
+}
+
+// Retorna a posição logo após o primeiro '\n' em [pos, tamanho), ou tamanho
+static inline off_t leitor_proxima_linha(int fd, off_t pos, off_t tamanho) {
+    char bloco[LEITOR_BLOCO_BUSCA];
+
+    while (pos < tamanho) {
+        ssize_t lidos = pread(fd, bloco, sizeof(bloco), pos);
+        if (lidos <= 0)
+            return tamanho;
+        char *nl = memchr(bloco, '\n', lidos);
+        if (nl)
+            return pos + (nl - bloco) + 1;
+        pos += lidos;
+    }
+    return tamanho;
+}
+
+// Regra de todos os caminhos de leitura: x seguido direto da vírgula, y, e
+// depois de y só espaços até o fim da linha. "3.5abc" e "4,8 9" invalidam a
+// linha (o sscanf("%lf,%lf") antigo aceitava as duas). Retorna 1 se p, logo
+// após y, chega ao fim da linha ('\n', '\0' ou fim) passando só por espaços
+static inline int leitor_resto_vazio(const char *p, const char *fim) {
+    while (p < fim && (*p == ' ' || *p == '\t' || *p == '\r'))
+        p++;
+    return p == fim || *p == '\n' || *p == '\0';
+}
+
+// Converte uma linha "x,y" terminada em '\0' com strtod (regra de leitor_resto_vazio)
+static inline int leitor_converte_linha(const char *linha, double *x, double *y) {
+    char *fimX, *fimY;
+
+    *x = strtod(linha, &fimX);
+    if (fimX == linha || *fimX != ',')
+        return 0;
+    *y = strtod(fimX + 1, &fimY);
+    if (fimY == fimX + 1)
+        return 0;
+    return leitor_resto_vazio(fimY, fimY + strlen(fimY));
+}
+
+// Potências de 10 representáveis exatamente em double
+static const double leitor_pot10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Converte um número decimal em [p, fim) sem depender de '\0' nem do locale.
+// Retorna a posição logo após o número ou NULL se não houver número.
+//
+// Caminho rápido: "[-]ddd.ddd" com no máximo 19 dígitos vira mantissa inteira
+// m e k casas decimais. Se m <= 2^53 e k <= 22, tanto m quanto 10^k são
+// exatos em double e a divisão IEEE (corretamente arredondada) dá exatamente
+// o mesmo resultado do strtod. Todo o resto (expoente, inf, nan, hexa,
+// mantissas longas) é repassado ao strtod.
+static inline const char *leitor_converte_decimal(const char *p, const char *fim, double *valor) {
+    const char *inicio = p;
+    uint64_t mantissa = 0;
+    int digitos = 0, casas = 0, negativo = 0;
+
+    while (p < fim && (*p == ' ' || *p == '\t'))
+        p++;
+    if (p < fim && (*p == '-' || *p == '+'))
+        negativo = (*p++ == '-');
+
+    while (p < fim && (unsigned)(*p - '0') < 10 && digitos < 19) {
+        mantissa = mantissa * 10 + (unsigned)(*p++ - '0');
+        digitos++;
+    }
+    if (p < fim && *p == '.') {
+        p++;
+        while (p < fim && (unsigned)(*p - '0') < 10 && digitos < 19) {
+            mantissa = mantissa * 10 + (unsigned)(*p++ - '0');
+            digitos++;
+            casas++;
+        }
+    }
+
+    int especial = (p < fim) && ((unsigned)(*p - '0') < 10 || *p == 'e' || *p == 'E' ||
+                                 *p == 'x' || *p == 'X');
+    if (digitos > 0 && !especial && mantissa <= (1ULL << 53) && casas <= 22) {
+        double v = (double)mantissa / leitor_pot10[casas];
+        *valor = negativo ? -v : v;
+        return p;
+    }
+
+    // Caminho lento: copia o campo (até ',' ou fim da linha) e usa strtod.
+    // Um campo que não cabe em campo é recusado: cortá-lo mudaria o valor
+    char campo[LEITOR_MAX_NUMERO];
+    int tam = 0;
+    while (inicio + tam < fim && tam < LEITOR_MAX_NUMERO - 1 &&
+           inicio[tam] != ',' && inicio[tam] != '\n')
+        tam++;
+    if (inicio + tam < fim && inicio[tam] != ',' && inicio[tam] != '\n')
+        return NULL;
+    memcpy(campo, inicio, tam);
+    campo[tam] = '\0';
+
+    char *fimCampo;
+    *valor = strtod(campo, &fimCampo);
+    return (fimCampo == campo) ? NULL : inicio + (fimCampo - campo);
+}
+
+// Converte a linha "x,y" em [p, fim) com leitor_converte_decimal, com a mesma
+// regra de leitor_converte_linha (leitor_resto_vazio depois de y)
+static inline int leitor_converte_linha_rapida(const char *p, const char *fim, double *x, double *y) {
+    p = leitor_converte_decimal(p, fim, x);
+    if (!p || p >= fim || *p != ',')
+        return 0;
+    p = leitor_converte_decimal(p + 1, fim, y);
+    if (!p)
+        return 0;
+    return leitor_resto_vazio(p, fim);
+}
+
+// ==================== FUNÇÃO EXECUTADA POR CADA THREAD DE LEITURA ====================
+static inline void *leitor_thread(void *arg) {
+    ArgsLeitor *args = (ArgsLeitor *)arg;
+    LeitorCSV *L = args->leitor;
+    long id = args->id;
+
+    // Espera as faixas e a barreira valerem para as threads realmente criadas
+    pthread_mutex_lock(&L->portao);
+    pthread_mutex_unlock(&L->portao);
+
+    off_t inicio = L->limites[id];
+    size_t tam = (size_t)(L->limites[id + 1] - inicio);
+
+    // ETAPA 1: obtém a faixa (no mapa ou lida para um buffer local) e conta as linhas
+    char *buf = L->mapa ? (char *)L->mapa + inicio : malloc(tam + 1);
+    long linhas = -1;
+    if (buf) {
+        size_t lidos = L->mapa ? tam : 0;
+        while (lidos < tam) {
+            ssize_t r = pread(L->fd, buf + lidos, tam - lidos, inicio + lidos);
+            if (r <= 0)
+                break;
+            lidos += r;
+        }
+        if (lidos == tam) {
+            if (!L->mapa)
+                buf[tam] = '\0';
+            linhas = 0;
+            for (char *p = buf; (p = memchr(p, '\n', buf + tam - p)) != NULL; p++)
+                linhas++;
+            if (tam > 0 && buf[tam - 1] != '\n')
+                linhas++;  // Última linha do arquivo sem '\n'
+        }
+    }
+    L->linhas[id] = linhas;
+
+    pthread_barrier_wait(&L->barreira);
+
+    // Thread 0 soma as contagens e aloca X/Y com o tamanho exato
+    if (id == 0) {
+        long total = 0;
+        for (int t = 0; t < L->numThreads; t++) {
+            if (L->linhas[t] < 0)
+                L->erro = 1;
+            else
+                total += L->linhas[t];
+        }
+        if (!L->erro) {
+            void *X, *Y;
+            if (colunas_aloca(total, sizeof(double), &X, &Y) != 0) {
+                L->erro = 1;
+            } else {
+                L->X = X;
+                L->Y = Y;
+            }
+        }
+    }
+
+    pthread_barrier_wait(&L->barreira);
+    if (id == 0)
+        GET_TIME(L->inicioConversao);
+
+    // ETAPA 2: converte as linhas direto para a fatia desta thread em X/Y
+    long n = 0;
+    if (!L->erro) {
+        long deslocamento = 0;  // Posição inicial da fatia = linhas das threads anteriores
+        for (long t = 0; t < id; t++)
+            deslocamento += L->linhas[t];
+
+        double *X = L->X + deslocamento;
+        double *Y = L->Y + deslocamento;
+        char *p = buf, *fimBuf = buf + tam;
+        while (p < fimBuf) {
+            char *nl = memchr(p, '\n', fimBuf - p);
+            if (!nl)
+                nl = fimBuf;
+            if (L->mapa) {
+                // Conversão no próprio mapa, limitada ao fim da linha
+                if (leitor_converte_linha_rapida(p, nl, &X[n], &Y[n]))
+                    n++;
+            } else {
+                *nl = '\0';  // Isola a linha para o strtod não avançar na próxima
+                if (leitor_converte_linha(p, &X[n], &Y[n]))
+                    n++;
+            }
+            p = nl + 1;
+        }
+    }
+    L->validos[id] = n;
+
+    if (!L->mapa)
+        free(buf);
+    return NULL;
+}
+
+// Pula o cabeçalho e divide o restante do arquivo em numThreads faixas
+// iguais, cada uma alinhada ao início de uma linha (limites tem numThreads+1 posições)
+static inline void leitor_divide_faixas(int fd, off_t tamanho, int numThreads, off_t *limites) {
+    // PULA CABEÇALHO - os dados começam após o primeiro '\n'
+    off_t dados = leitor_proxima_linha(fd, 0, tamanho);
+
+    limites[0] = dados;
+    limites[numThreads] = tamanho;
+    for (int t = 1; t < numThreads; t++) {
+        off_t alvo = dados + (off_t)((double)(tamanho - dados) * t / numThreads);
+        off_t limite = (alvo > dados) ? leitor_proxima_linha(fd, alvo - 1, tamanho) : dados;
+        limites[t] = (limite > limites[t - 1]) ? limite : limites[t - 1];
+    }
+}
+
+// ==================== LEITURA PARALELA DO ARQUIVO ====================
+// Retorna o número de pontos lidos (X e Y alocados com colunas_aloca) ou -1 em erro
+static inline long leitor_carrega(const char *nomeArquivo, int numThreads, int usaMmap,
+                                  double **pX, double **pY) {
+    LeitorCSV L;
+    struct stat info;
+
+    if (numThreads < 1)
+        numThreads = 1;
+
+    GET_TIME(leitor_tempos.inicio);
+    long faltasInicio = memoria_faltas();
+    L.fd = open(nomeArquivo, O_RDONLY);
+    if (L.fd < 0) {
+        perror("Erro ao abrir o arquivo");
+        return -1;
+    }
+    if (fstat(L.fd, &info) != 0 || info.st_size == 0) {
+        fprintf(stderr, "Erro: arquivo vazio\n");
+        close(L.fd);
+        return -1;
+    }
+
+    off_t tamanho = info.st_size;
+    L.mapa = NULL;
+    if (usaMmap) {
+        void *mapa = mmap(NULL, tamanho, PROT_READ, MAP_PRIVATE, L.fd, 0);
+        if (mapa == MAP_FAILED) {
+            perror("Erro ao mapear o arquivo");
+            close(L.fd);
+            return -1;
+        }
+        madvise(mapa, tamanho, MADV_SEQUENTIAL);
+        L.mapa = mapa;
+    }
+    L.numThreads = numThreads;
+    L.limites = malloc((numThreads + 1) * sizeof(off_t));
+    L.linhas = malloc(numThreads * sizeof(long));
+    L.validos = malloc(numThreads * sizeof(long));
+    L.X = L.Y = NULL;
+    L.erro = 0;
+    L.inicioConversao = 0;
+    if (!L.limites || !L.linhas || !L.validos) {
+        fprintf(stderr, "Erro ao alocar memória inicial\n");
+        free(L.limites); free(L.linhas); free(L.validos);
+        if (L.mapa) munmap((void *)L.mapa, tamanho);
+        close(L.fd);
+        return -1;
+    }
+
+    // Cria as threads de leitura (com uma só thread, lê na própria thread
+    // chamadora). Faixas e barreira só são montadas depois, para as criadas
+    pthread_t threads[numThreads];
+    ArgsLeitor args[numThreads];
+    for (long t = 0; t < numThreads; t++) {
+        args[t].leitor = &L;
+        args[t].id = t;
+    }
+    pthread_mutex_init(&L.portao, NULL);
+    pthread_mutex_lock(&L.portao);
+    int criadas = (numThreads > 1) ? leitor_cria_threads(threads, numThreads, leitor_thread,
+                                                          args, sizeof(ArgsLeitor)) : 0;
+    if (criadas < numThreads)
+        numThreads = (criadas > 0) ? criadas : 1;
+    L.numThreads = numThreads;
+    leitor_divide_faixas(L.fd, tamanho, numThreads, L.limites);
+    pthread_barrier_init(&L.barreira, NULL, numThreads);
+    pthread_mutex_unlock(&L.portao);
+    if (criadas == 0) {
+        leitor_thread(&args[0]);
+    } else {
+        for (int t = 0; t < criadas; t++) {
+            pthread_join(threads[t], NULL);
+        }
+    }
+    pthread_barrier_destroy(&L.barreira);
+    pthread_mutex_destroy(&L.portao);
+    if (L.mapa)
+        munmap((void *)L.mapa, tamanho);
+    close(L.fd);
+
+    long N = -1;
+    if (L.erro) {
+        fprintf(stderr, "Erro ao ler o arquivo %s\n", nomeArquivo);
+        colunas_libera(L.X);
+    } else {
+        // Linhas inválidas deixam lacunas no fim de cada fatia: compacta os pedaços
+        N = 0;
+        long deslocamento = 0;
+        for (int t = 0; t < numThreads; t++) {
+            if (deslocamento != N) {
+                memmove(L.X + N, L.X + deslocamento, L.validos[t] * sizeof(double));
+                memmove(L.Y + N, L.Y + deslocamento, L.validos[t] * sizeof(double));
+            }
+            N += L.validos[t];
+            deslocamento += L.linhas[t];
+        }
+        *pX = L.X;
+        *pY = L.Y;
+    }
+
+    free(L.limites);
+    free(L.linhas);
+    free(L.validos);
+    GET_TIME(leitor_tempos.fim);
+    leitor_tempos.faltas = memoria_faltas() - faltasInicio;
+    leitor_tempos.conversao = L.inicioConversao > 0 ? L.inicioConversao : leitor_tempos.fim;
+    return N;
+}
+
+// Leitura com pread + strtod em buffers de cada thread
+static inline long carrega_csv_paralelo(const char *nomeArquivo, int numThreads,
+                                        double **pX, double **pY) {
+    return leitor_carrega(nomeArquivo, numThreads, 0, pX, pY);
+}
+
+// Leitura sem cópia sobre o arquivo mapeado, com o conversor decimal próprio
+static inline long carrega_csv_mmap(const char *nomeArquivo, int numThreads,
+                                    double **pX, double **pY) {
+    return leitor_carrega(nomeArquivo, numThreads, 1, pX, pY);
+}
+
+// ==================== LEITURA EM FLUXO (SEM MATERIALIZAR X/Y) ====================
+// Função chamada para cada lote de pontos convertidos por uma thread
+typedef void (*LeitorProcessaLote)(const double *X, const double *Y, long n, void *contexto);
+
+// Argumento de cada thread no modo fluxo
+typedef struct {
+    int fd;
+    off_t inicio, fim;             // Faixa de bytes desta thread
+    LeitorProcessaLote processa;   // Recebe os lotes convertidos
+    void *contexto;                // Repassado a processa (um por thread)
+    long validos;                  // Pontos convertidos (-1 em erro)
+} ArgsFluxo;
+
+static inline void *leitor_thread_fluxo(void *arg) {
+    ArgsFluxo *args = (ArgsFluxo *)arg;
+    char *buf = malloc(LEITOR_BLOCO_FLUXO);
+    double *loteX = malloc(2 * LEITOR_LOTE * sizeof(double));
+    double *loteY = loteX + LEITOR_LOTE;
+    long n = 0, total = 0;
+    size_t resto = 0;        // Início de linha incompleta guardado no começo de buf
+    off_t pos = args->inicio;
+
+    if (!buf || !loteX) {
+        free(buf); free(loteX);
+        args->validos = -1;
+        return NULL;
+    }
+
+    while (pos < args->fim) {
+        size_t quer = LEITOR_BLOCO_FLUXO - resto;
+        if ((off_t)quer > args->fim - pos)
+            quer = args->fim - pos;
+        ssize_t lidos = pread(args->fd, buf + resto, quer, pos);
+        if (lidos <= 0) {
+            total = -1;
+            break;
+        }
+        pos += lidos;
+        int ultimo = (pos >= args->fim);
+
+        // Converte as linhas completas; no último bloco também a linha final sem '\n'
+        char *p = buf, *fimBuf = buf + resto + lidos;
+        while (p < fimBuf) {
+            char *nl = memchr(p, '\n', fimBuf - p);
+            if (!nl) {
+                if (!ultimo)
+                    break;
+                nl = fimBuf;
+            }
+            if (leitor_converte_linha_rapida(p, nl, &loteX[n], &loteY[n]) && ++n == LEITOR_LOTE) {
+                args->processa(loteX, loteY, n, args->contexto);
+                total += n;
+                n = 0;
+            }
+            p = nl + 1;
+        }
+        if (ultimo)
+            break;
+
+        resto = fimBuf - p;
+        if (resto == LEITOR_BLOCO_FLUXO) {
+            // Linha maior que o buffer: não é um ponto válido, pula até a próxima
+            pos = leitor_proxima_linha(args->fd, pos, args->fim);
+            resto = 0;
+        } else {
+            memmove(buf, p, resto);
+        }
+    }
+    if (total >= 0 && n > 0) {
+        args->processa(loteX, loteY, n, args->contexto);
+        total += n;
+    }
+    args->validos = total;
+
+    free(buf);
+    free(loteX);
+    return NULL;
+}
+
+// Lê o CSV em paralelo sem guardar os pontos. A thread t chama processa com
+// o contexto (char *)contextos + t * tamContexto. Retorna o total de pontos ou -1
+static inline long percorre_csv_paralelo(const char *nomeArquivo, int numThreads,
+                                         LeitorProcessaLote processa,
+                                         void *contextos, size_t tamContexto) {
+    struct stat info;
+
+    if (numThreads < 1)
+        numThreads = 1;
+
+    int fd = open(nomeArquivo, O_RDONLY);
+    if (fd < 0) {
+        perror("Erro ao abrir o arquivo");
+        return -1;
+    }
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        fprintf(stderr, "Erro: arquivo vazio\n");
+        close(fd);
+        return -1;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    off_t limites[numThreads + 1];
+    leitor_divide_faixas(fd, info.st_size, numThreads, limites);
+
+    pthread_t threads[numThreads];
+    ArgsFluxo args[numThreads];
+    for (long t = 0; t < numThreads; t++) {
+        args[t].fd = fd;
+        args[t].inicio = limites[t];
+        args[t].fim = limites[t + 1];
+        args[t].processa = processa;
+        args[t].contexto = (char *)contextos + t * tamContexto;
+        args[t].validos = 0;
+    }
+    // Faixas que ficaram sem thread (pthread_create falhou) rodam aqui,
+    // enquanto as criadas trabalham
+    int criadas = (numThreads > 1) ? leitor_cria_threads(threads, numThreads, leitor_thread_fluxo,
+                                                          args, sizeof(ArgsFluxo)) : 0;
+    for (int t = criadas; t < numThreads; t++) {
+        leitor_thread_fluxo(&args[t]);
+    }
+    for (int t = 0; t < criadas; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    close(fd);
+
+    long N = 0;
+    for (int t = 0; t < numThreads; t++) {
+        if (args[t].validos < 0) {
+            fprintf(stderr, "Erro ao ler o arquivo %s\n", nomeArquivo);
+            return -1;
+        }
+        N += args[t].validos;
+    }
+    return N;
+}
+
+// ==================== LEITURA DE VÁRIAS COLUNAS ====================
+// Estado compartilhado entre as threads de carrega_csv_colunas
+typedef struct {
+    const char *mapa;        // Arquivo mapeado
+    int numThreads;
+    int numColunas;          // Valores por linha
+    off_t *limites;          // Faixa da thread t: [limites[t], limites[t+1])
+    long *linhas;            // Linhas encontradas na faixa de cada thread
+    long *validos;           // Linhas convertidas com sucesso por cada thread
+    double *dados;           // Matriz de saída, linhas x numColunas (alocada pela thread 0)
+    int erro;
+    pthread_barrier_t barreira;
+    pthread_mutex_t portao;  // Como em LeitorCSV
+} LeitorColunas;
+
+typedef struct {
+    LeitorColunas *leitor;
+    long id;
+} ArgsColunas;
+
+// Converte a linha em [p, fim) com exatamente n valores separados por ','
+static inline int leitor_converte_colunas(const char *p, const char *fim, int n, double *valores) {
+    for (int c = 0; c < n; c++) {
+        p = leitor_converte_decimal(p, fim, &valores[c]);
+        if (!p)
+            return 0;
+        if (c < n - 1) {
+            if (p >= fim || *p != ',')
+                return 0;
+            p++;
+        }
+    }
+    while (p < fim && (*p == ' ' || *p == '\t' || *p == '\r'))
+        p++;
+    return p == fim;  // Colunas a mais invalidam a linha
+}
+
+static inline void *leitor_thread_colunas(void *arg) {
+    ArgsColunas *args = (ArgsColunas *)arg;
+    LeitorColunas *L = args->leitor;
+    long id = args->id;
+    pthread_mutex_lock(&L->portao);  // Faixas e barreira prontas (ver leitor_thread)
+    pthread_mutex_unlock(&L->portao);
+    const char *buf = L->mapa + L->limites[id];
+    const char *fimBuf = L->mapa + L->limites[id + 1];
+
+    // ETAPA 1: conta as linhas da faixa
+    long linhas = 0;
+    for (const char *p = buf; (p = memchr(p, '\n', fimBuf - p)) != NULL; p++)
+        linhas++;
+    if (fimBuf > buf && fimBuf[-1] != '\n')
+        linhas++;
+    L->linhas[id] = linhas;
+
+    pthread_barrier_wait(&L->barreira);
+
+    if (id == 0) {
+        long total = 0;
+        for (int t = 0; t < L->numThreads; t++)
+            total += L->linhas[t];
+        L->dados = malloc((total > 0 ? total : 1) * L->numColunas * sizeof(double));
+        if (!L->dados)
+            L->erro = 1;
+    }
+
+    pthread_barrier_wait(&L->barreira);
+
+    // ETAPA 2: converte as linhas direto para a fatia desta thread
+    long n = 0;
+    if (!L->erro) {
+        long deslocamento = 0;
+        for (long t = 0; t < id; t++)
+            deslocamento += L->linhas[t];
+
+        double *saida = L->dados + deslocamento * L->numColunas;
+        const char *p = buf;
+        while (p < fimBuf) {
+            const char *nl = memchr(p, '\n', fimBuf - p);
+            if (!nl)
+                nl = fimBuf;
+            if (leitor_converte_colunas(p, nl, L->numColunas, saida + n * L->numColunas))
+                n++;
+            p = nl + 1;
+        }
+    }
+    L->validos[id] = n;
+    return NULL;
+}
+
+// Lê um CSV com cabeçalho e numColunas colunas numéricas (contadas no
+// cabeçalho) para *pDados, em ordem de linha. Linhas com outro número de
+// colunas são ignoradas. Retorna o número de linhas lidas ou -1 em erro
+static inline long carrega_csv_colunas(const char *nomeArquivo, int numThreads,
+                                       double **pDados, int *pNumColunas) {
+    LeitorColunas L;
+    struct stat info;
+
+    if (numThreads < 1)
+        numThreads = 1;
+
+    int fd = open(nomeArquivo, O_RDONLY);
+    if (fd < 0) {
+        perror("Erro ao abrir o arquivo");
+        return -1;
+    }
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        fprintf(stderr, "Erro: arquivo vazio\n");
+        close(fd);
+        return -1;
+    }
+    off_t tamanho = info.st_size;
+    void *mapa = mmap(NULL, tamanho, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapa == MAP_FAILED) {
+        perror("Erro ao mapear o arquivo");
+        close(fd);
+        return -1;
+    }
+    madvise(mapa, tamanho, MADV_SEQUENTIAL);
+
+    // Número de colunas = vírgulas do cabeçalho + 1
+    L.mapa = mapa;
+    L.numColunas = 1;
+    for (const char *p = L.mapa; p < L.mapa + tamanho && *p != '\n'; p++)
+        L.numColunas += (*p == ',');
+
+    off_t limites[numThreads + 1];
+    long linhas[numThreads], validos[numThreads];
+    L.numThreads = numThreads;
+    L.limites = limites;
+    L.linhas = linhas;
+    L.validos = validos;
+    L.dados = NULL;
+    L.erro = 0;
+
+    // Mesma ordem de leitor_carrega: threads, depois faixas e barreira para as criadas
+    pthread_t threads[numThreads];
+    ArgsColunas args[numThreads];
+    for (long t = 0; t < numThreads; t++) {
+        args[t].leitor = &L;
+        args[t].id = t;
+    }
+    pthread_mutex_init(&L.portao, NULL);
+    pthread_mutex_lock(&L.portao);
+    int criadas = (numThreads > 1) ? leitor_cria_threads(threads, numThreads, leitor_thread_colunas,
+                                                          args, sizeof(ArgsColunas)) : 0;
+    if (criadas < numThreads)
+        numThreads = (criadas > 0) ? criadas : 1;
+    L.numThreads = numThreads;
+    leitor_divide_faixas(fd, tamanho, numThreads, limites);
+    pthread_barrier_init(&L.barreira, NULL, numThreads);
+    pthread_mutex_unlock(&L.portao);
+    if (criadas == 0) {
+        leitor_thread_colunas(&args[0]);
+    } else {
+        for (int t = 0; t < criadas; t++) {
+            pthread_join(threads[t], NULL);
+        }
+    }
+    pthread_barrier_destroy(&L.barreira);
+    pthread_mutex_destroy(&L.portao);
+    munmap(mapa, tamanho);
+    close(fd);
+
+    if (L.erro) {
+        fprintf(stderr, "Erro ao alocar memória para %s\n", nomeArquivo);
+        return -1;
+    }
+
+    // Compacta as lacunas deixadas pelas linhas inválidas
+    long N = 0, deslocamento = 0;
+    for (int t = 0; t < numThreads; t++) {
+        if (deslocamento != N)
+            memmove(L.dados + N * L.numColunas, L.dados + deslocamento * L.numColunas,
+                    validos[t] * L.numColunas * sizeof(double));
+        N += validos[t];
+        deslocamento += linhas[t];
+    }
+    *pDados = L.dados;
+    *pNumColunas = L.numColunas;
+    return N;
+}
+
+#endif
@@ -0,0 +1,250 @@
+/* File:     memoria_colunas.h
+ *
+ * Purpose:  Memória das colunas X e Y. Em vez de dois malloc (sem garantia
+ *           de alinhamento, em páginas de 4 KB), colunas_aloca reserva de uma
+ *           vez uma região mapeada com as duas colunas, já no tamanho final
+ *           (contado pelo leitor ou lido do cabeçalho binário):
+ *             [0, 64)              cabeçalho CabecalhoColunas
+ *             [64, 64 + c)         coluna X   (c = n·elemento, múltiplo de 64)
+ *             [64 + c, 64 + 2c)    coluna Y
+ *           As duas colunas começam em linha de cache (loads vetoriais
+ *           alinhados) e, com páginas grandes, a região começa em 2 MB.
+ *
+ *           O tipo de página vem da variável de ambiente REGRESSAO_PAGINAS:
+ *             normal   páginas de 4 KB (MADV_NOHUGEPAGE, mesmo com THP "always")
+ *             thp      páginas grandes transparentes (MADV_HUGEPAGE) - padrão
+ *             hugetlb  páginas grandes explícitas (MAP_HUGETLB; precisam estar
+ *                      reservadas em /proc/sys/vm/nr_hugepages)
+ *           Se o pedido não puder ser atendido cai para o seguinte
+ *           (hugetlb -> thp -> normal); colunas_paginas diz o que foi obtido
+ *           e colunas_kb_grandes quanto da região está de fato em páginas de
+ *           2 MB (/proc/self/smaps). Com páginas de 2 MB, 160 MB de colunas
+ *           ocupam 80 entradas de TLB em vez de 40960, e o primeiro toque
+ *           (na conversão do leitor) gera 512 vezes menos faltas de página.
+ *
+ *           ArenaMemoria é o caso em que o tamanho final não é conhecido: o
+ *           espaço de endereços é reservado de uma vez (PROT_NONE, sem
+ *           ocupar memória) e liberado para uso em passos de 2 MB conforme
+ *           cresce. Os dados nunca mudam de lugar, então crescer não copia
+ *           nada (ao contrário de realloc dobrando a capacidade).
+ *
+ * Exemplo:
+ *    double *X, *Y;
+ *    if (colunas_aloca(N, sizeof(double), (void **)&X, (void **)&Y) != 0) return -1;
+ *    . . .
+ *    printf("%s, %ld KB em paginas grandes\n", colunas_paginas(X), colunas_kb_grandes(X));
+ *    colunas_libera(X);                    // Libera X e Y
+ *
+ *    ArenaMemoria arena;
+ *    arena_reserva(&arena, maximo);        // Só endereços
+ *    if (arena_garante(&arena, usados + novos) != 0) . . .
+ *    arena_libera(&arena);
+ */
+#ifndef _MEMORIA_COLUNAS_H_
+#define _MEMORIA_COLUNAS_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+
+#ifndef MAP_HUGETLB
+#define MAP_HUGETLB 0x40000
+#endif
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0x4000
+#endif
+
+#define MEMORIA_PAGINA_GRANDE (2UL * 1024 * 1024)
+#define MEMORIA_LINHA 64
+
+#define MEMORIA_NORMAL  0
+#define MEMORIA_THP     1
+#define MEMORIA_HUGETLB 2
+
+static const char *memoria_nomes[] = {"normal", "thp", "hugetlb"};
+
+// Primeiros 64 bytes da região: o suficiente para liberá-la a partir de X
+typedef struct {
+    char *base;
+    size_t tamanho;
+    int paginas;  // Tipo de página obtido (MEMORIA_*)
+} __attribute__((aligned(MEMORIA_LINHA))) CabecalhoColunas;
+
+static inline size_t memoria_arredonda(size_t bytes, size_t multiplo) {
+    return (bytes + multiplo - 1) / multiplo * multiplo;
+}
+
+// Tipo de página pedido em REGRESSAO_PAGINAS (thp se ausente ou desconhecido)
+static inline int memoria_modo_pedido(void) {
+    const char *pedido = getenv("REGRESSAO_PAGINAS");
+    if (pedido) {
+        for (int m = MEMORIA_NORMAL; m <= MEMORIA_HUGETLB; m++)
+            if (strcmp(pedido, memoria_nomes[m]) == 0)
+                return m;
+    }
+    return MEMORIA_THP;
+}
+
+// Faltas de página (sem E/S) do processo até agora
+static inline long memoria_faltas(void) {
+    struct rusage uso;
+    return getrusage(RUSAGE_SELF, &uso) == 0 ? uso.ru_minflt : 0;
+}
+
+// ==================== MAPEAMENTO ====================
+// Mapeia tamanho bytes anônimos no tipo pedido, caindo para o seguinte se
+// não der. Retorna a região (alinhada em 2 MB, exceto em normal) ou NULL
+static inline char *memoria_mapeia(size_t tamanho, int modo, int *obtido) {
+    if (modo == MEMORIA_HUGETLB) {
+        size_t grande = memoria_arredonda(tamanho, MEMORIA_PAGINA_GRANDE);
+        void *p = mmap(NULL, grande, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            *obtido = MEMORIA_HUGETLB;
+            return p;
+        }
+        modo = MEMORIA_THP;  // Sem páginas reservadas
+    }
+    if (modo == MEMORIA_THP) {
+        // Mapeia 2 MB a mais e corta as pontas para começar em 2 MB
+        size_t folga = tamanho + MEMORIA_PAGINA_GRANDE;
+        char *p = mmap(NULL, folga, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p != MAP_FAILED) {
+            char *alinhado = (char *)memoria_arredonda((uintptr_t)p, MEMORIA_PAGINA_GRANDE);
+            size_t fimMapeado = memoria_arredonda(tamanho, 4096);
+            if (alinhado > p)
+                munmap(p, alinhado - p);
+            if (p + folga > alinhado + fimMapeado)
+                munmap(alinhado + fimMapeado, p + folga - (alinhado + fimMapeado));
+            *obtido = (madvise(alinhado, tamanho, MADV_HUGEPAGE) == 0) ? MEMORIA_THP : MEMORIA_NORMAL;
+            return alinhado;
+        }
+    }
+    void *p = mmap(NULL, tamanho, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+        return NULL;
+    madvise(p, tamanho, MADV_NOHUGEPAGE);
+    *obtido = MEMORIA_NORMAL;
+    return p;
+}
+
+// ==================== COLUNAS ====================
+// Aloca as colunas X e Y de n elementos de tamElemento bytes, alinhadas em
+// 64 bytes e na mesma região. Retorna 0 ou -1 (sem memória)
+static inline int colunas_aloca(long n, size_t tamElemento, void **pX, void **pY) {
+    size_t coluna = memoria_arredonda((size_t)(n > 0 ? n : 1) * tamElemento, MEMORIA_LINHA);
+    size_t tamanho = sizeof(CabecalhoColunas) + 2 * coluna;
+    int obtido;
+    char *base = memoria_mapeia(tamanho, memoria_modo_pedido(), &obtido);
+    if (!base)
+        return -1;
+
+    CabecalhoColunas *cab = (CabecalhoColunas *)base;
+    cab->base = base;
+    cab->tamanho = (obtido == MEMORIA_HUGETLB) ? memoria_arredonda(tamanho, MEMORIA_PAGINA_GRANDE)
+                                               : tamanho;
+    cab->paginas = obtido;
+    *pX = base + sizeof(CabecalhoColunas);
+    *pY = base + sizeof(CabecalhoColunas) + coluna;
+    return 0;
+}
+
+// Libera X e Y (X é o ponteiro devolvido por colunas_aloca)
+static inline void colunas_libera(void *X) {
+    if (!X)
+        return;
+    CabecalhoColunas *cab = (CabecalhoColunas *)((char *)X - sizeof(CabecalhoColunas));
+    munmap(cab->base, cab->tamanho);
+}
+
+// Tipo de página obtido para as colunas de X
+static inline const char *colunas_paginas(const void *X) {
+    const CabecalhoColunas *cab = (const CabecalhoColunas *)((const char *)X - sizeof(CabecalhoColunas));
+    return memoria_nomes[cab->paginas];
+}
+
+// KB da região de X que estão em páginas de 2 MB (AnonHugePages ou
+// Private_Hugetlb em /proc/self/smaps); -1 se não foi possível ler
+static inline long colunas_kb_grandes(const void *X) {
+    const CabecalhoColunas *cab = (const CabecalhoColunas *)((const char *)X - sizeof(CabecalhoColunas));
+    FILE *smaps = fopen("/proc/self/smaps", "r");
+    if (!smaps)
+        return -1;
+
+    char linha[512];
+    long total = 0, kb;
+    int dentro = 0;
+    uintptr_t inicio = (uintptr_t)cab->base, fim = inicio + cab->tamanho;
+    while (fgets(linha, sizeof(linha), smaps)) {
+        unsigned long a, b;
+        if (sscanf(linha, "%lx-%lx ", &a, &b) == 2) {
+            dentro = a < fim && b > inicio;  // Cabeçalho de um mapeamento
+        } else if (dentro && (sscanf(linha, "AnonHugePages: %ld kB", &kb) == 1 ||
+                              sscanf(linha, "Private_Hugetlb: %ld kB", &kb) == 1)) {
+            total += kb;
+        }
+    }
+    fclose(smaps);
+    return total;
+}
+
+// Devolve ao sistema as páginas inteiras dentro de [inicio, inicio + bytes),
+// cujo conteúdo não será mais usado (anônimas voltam zeradas; de um arquivo
+// mapeado privado, ao conteúdo do arquivo). Usado depois de reduzir as
+// colunas no lugar (binario_codifica_no_lugar), para a metade final de cada uma
+static inline void memoria_devolve(void *inicio, size_t bytes) {
+    uintptr_t a = memoria_arredonda((uintptr_t)inicio, 4096);
+    uintptr_t b = ((uintptr_t)inicio + bytes) / 4096 * 4096;
+    if (b > a)
+        madvise((void *)a, b - a, MADV_DONTNEED);  // Só economia: ignora falhas
+}
+
+// ==================== ARENA CRESCENTE ====================
+typedef struct {
+    char *base;
+    size_t reservado;      // Espaço de endereços reservado
+    size_t comprometido;   // Início [0, comprometido) liberado para leitura e escrita
+} ArenaMemoria;
+
+// Reserva maximo bytes de endereços, sem ocupar memória. Retorna 0 ou -1
+static inline int arena_reserva(ArenaMemoria *a, size_t maximo) {
+    a->reservado = memoria_arredonda(maximo > 0 ? maximo : 1, MEMORIA_PAGINA_GRANDE);
+    a->comprometido = 0;
+    void *p = mmap(NULL, a->reservado, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (p == MAP_FAILED) {
+        a->base = NULL;
+        return -1;
+    }
+    a->base = p;
+    if (memoria_modo_pedido() != MEMORIA_NORMAL)
+        madvise(a->base, a->reservado, MADV_HUGEPAGE);
+    return 0;
+}
+
+// Garante que [0, bytes) pode ser usado, crescendo em passos de 2 MB.
+// Retorna 0, ou -1 se passar da reserva ou faltar memória
+static inline int arena_garante(ArenaMemoria *a, size_t bytes) {
+    if (bytes <= a->comprometido)
+        return 0;
+    if (bytes > a->reservado)
+        return -1;
+    size_t novo = memoria_arredonda(bytes, MEMORIA_PAGINA_GRANDE);
+    if (novo > a->reservado)
+        novo = a->reservado;
+    if (mprotect(a->base + a->comprometido, novo - a->comprometido, PROT_READ | PROT_WRITE) != 0)
+        return -1;
+    a->comprometido = novo;
+    return 0;
+}
+
+static inline void arena_libera(ArenaMemoria *a) {
+    if (a->base)
+        munmap(a->base, a->reservado);
+    a->base = NULL;
+    a->reservado = a->comprometido = 0;
+}
+
+#endif
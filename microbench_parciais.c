@@ -0,0 +1,126 @@
+/* File:     microbench_parciais.c
+ *
+ * Purpose:  Mede o custo do falso compartilhamento no array de resultados
+ *           parciais (um Parcial por thread), comparando dois layouts:
+ *
+ *             compacto: struct de 40 bytes, como era antes; posições de
+ *                       threads vizinhas dividem a mesma linha de cache
+ *             alinhado: struct alinhada em 64 bytes (LINHA_CACHE), como no
+ *                       regressao-linear-mse.c; cada thread tem sua linha
+ *
+ *           Cada thread acumula diretamente na sua posição do array, o que
+ *           acontece no modo --fluxo (um += por lote) e em qualquer laço que
+ *           escreva no parcial a cada iteração. Com várias threads, o layout
+ *           compacto faz a linha "pular" entre os núcleos a cada escrita.
+ *
+ * Compile:  gcc -O2 -o microbench_parciais microbench_parciais.c -lpthread
+ * Usage:    ./microbench_parciais [max_threads] [iteracoes_por_thread]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "timer.h"
+
+#define LINHA_CACHE 64
+
+// Layout antigo: 5 doubles = 40 bytes, sem preenchimento
+typedef struct {
+    double somaX, somaY, somaX2, somaXY;
+    double somaErroQuad;
+} ParcialCompacto;
+
+// Layout novo: mesma struct ocupando uma linha de cache inteira
+typedef struct {
+    double somaX, somaY, somaX2, somaXY;
+    double somaErroQuad;
+} __attribute__((aligned(LINHA_CACHE))) ParcialAlinhado;
+
+typedef struct {
+    long id;
+    long iteracoes;
+    void *posicao;  // Posição desta thread no array de parciais
+} ArgsBench;
+
+pthread_barrier_t largada;
+
+// volatile obriga o compilador a escrever na memória a cada iteração,
+// como acontece quando cada lote faz parciais[id].campo += ...
+#define CORPO_BENCH(Tipo)                                         \
+    ArgsBench *args = (ArgsBench *)arg;                           \
+    volatile Tipo *p = (volatile Tipo *)args->posicao;            \
+    double x = (double)args->id;                                  \
+    pthread_barrier_wait(&largada);                               \
+    for (long i = 0; i < args->iteracoes; i++) {                  \
+        p->somaX += x;                                            \
+        p->somaY += 1.0;                                          \
+        p->somaX2 += x * x;                                       \
+        p->somaXY += x;                                           \
+        p->somaErroQuad += 0.5;                                   \
+    }                                                             \
+    return NULL;
+
+void *bench_compacto(void *arg) { CORPO_BENCH(ParcialCompacto) }
+void *bench_alinhado(void *arg) { CORPO_BENCH(ParcialAlinhado) }
+
+// Executa uma rodada com numThreads threads e devolve o tempo (s)
+double executa(int numThreads, long iteracoes, void *parciais, size_t tam,
+               void *(*funcao)(void *)) {
+    pthread_t threads[numThreads];
+    ArgsBench args[numThreads];
+    double inicio, fim;
+
+    memset(parciais, 0, numThreads * tam);
+    pthread_barrier_init(&largada, NULL, numThreads + 1);
+    for (long t = 0; t < numThreads; t++) {
+        args[t].id = t;
+        args[t].iteracoes = iteracoes;
+        args[t].posicao = (char *)parciais + t * tam;
+        pthread_create(&threads[t], NULL, funcao, &args[t]);
+    }
+
+    GET_TIME(inicio);
+    pthread_barrier_wait(&largada);  // Todas começam juntas
+    for (int t = 0; t < numThreads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    GET_TIME(fim);
+    pthread_barrier_destroy(&largada);
+    return fim - inicio;
+}
+
+int main(int argc, char *argv[]) {
+    int maxThreads = (argc >= 2) ? atoi(argv[1]) : 16;
+    long iteracoes = (argc >= 3) ? atol(argv[2]) : 10000000;
+
+    if (maxThreads < 1 || iteracoes < 1) {
+        printf("Uso: %s [max_threads] [iteracoes_por_thread]\n", argv[0]);
+        return 1;
+    }
+
+    // Os dois arrays começam alinhados à linha de cache, para que a única
+    // diferença entre eles seja o tamanho de cada posição
+    void *compacto = aligned_alloc(LINHA_CACHE, ((maxThreads * sizeof(ParcialCompacto)) / LINHA_CACHE + 1) * LINHA_CACHE);
+    void *alinhado = aligned_alloc(LINHA_CACHE, maxThreads * sizeof(ParcialAlinhado));
+    if (!compacto || !alinhado) {
+        fprintf(stderr, "Erro ao alocar memoria\n");
+        return 1;
+    }
+
+    printf("sizeof: compacto = %zu bytes, alinhado = %zu bytes\n",
+           sizeof(ParcialCompacto), sizeof(ParcialAlinhado));
+    printf("%8s %14s %14s %10s\n", "threads", "compacto(s)", "alinhado(s)", "razao");
+
+    // 1, 2, 4, ... e por último o próprio maxThreads
+    for (int t = 1; ; t = (t * 2 > maxThreads) ? maxThreads : t * 2) {
+        double tc = executa(t, iteracoes, compacto, sizeof(ParcialCompacto), bench_compacto);
+        double ta = executa(t, iteracoes, alinhado, sizeof(ParcialAlinhado), bench_alinhado);
+        printf("%8d %14.4f %14.4f %9.2fx\n", t, tc, ta, tc / ta);
+        if (t == maxThreads)
+            break;
+    }
+
+    free(compacto);
+    free(alinhado);
+    return 0;
+}
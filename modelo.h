@@ -0,0 +1,106 @@
+/* File:     modelo.h
+ *
+ * Purpose:  Arquivo do modelo ajustado, para não refazer a regressão a cada
+ *           execução: coeficientes, MSE e as estatísticas suficientes.
+ *
+ *           As estatísticas são guardadas como momentos centrados (ver
+ *           estatisticas.h), que não perdem precisão com x grandes. As somas
+ *           brutas saem deles quando necessário:
+ *             Σx = n·x̄    Σx² = Sxx + n·x̄²    Σxy = Sxy + n·x̄·ȳ   (idem para y)
+ *
+ *           Layout (128 bytes, ordem de bytes nativa):
+ *             magica[8] = "RLMOD\0\0\0", versao, reservado, n,
+ *             A, B, MSE, x̄, ȳ, Sxx, Sxy, Syy, preenchimento até 128
+ *
+ * Exemplo:
+ *    Modelo m;
+ *    modelo_de_momentos(&m, &total, A, B, MSE);
+ *    grava_modelo("modelo.bin", &m);
+ *    . . .
+ *    if (carrega_modelo("modelo.bin", &m) == 0)
+ *        y = m.A + m.B * x;
+ */
+#ifndef _MODELO_H_
+#define _MODELO_H_
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "estatisticas.h"
+
+#define MODELO_MAGICA "RLMOD\0\0\0"
+#define MODELO_VERSAO 1
+
+typedef struct {
+    char magica[8];          // MODELO_MAGICA
+    uint32_t versao;         // MODELO_VERSAO
+    uint32_t reservado;
+    uint64_t n;              // Pontos usados no ajuste
+    double A, B;             // y = A + B*x
+    double MSE;
+    double mediaX, mediaY;   // x̄ e ȳ
+    double Sxx, Sxy, Syy;    // Σ(x-x̄)², Σ(x-x̄)(y-ȳ), Σ(y-ȳ)²
+    double preenchimento[5]; // Completa os 128 bytes
+} Modelo;
+
+// Monta o modelo com os coeficientes do ajuste e os momentos de todos os pontos
+static inline void modelo_de_momentos(Modelo *m, const Momentos *total, double A, double B, double MSE) {
+    memset(m, 0, sizeof(*m));
+    memcpy(m->magica, MODELO_MAGICA, sizeof(m->magica));
+    m->versao = MODELO_VERSAO;
+    m->n = (uint64_t)total->n;
+    m->A = A;
+    m->B = B;
+    m->MSE = MSE;
+    m->mediaX = total->mediaX;
+    m->mediaY = total->mediaY;
+    m->Sxx = total->Sxx;
+    m->Sxy = total->Sxy;
+    m->Syy = total->Syy;
+}
+
+// Momentos guardados no modelo (para combinar com novos dados)
+static inline void modelo_momentos(const Modelo *m, Momentos *total) {
+    total->n = (long)m->n;
+    total->mediaX = m->mediaX;
+    total->mediaY = m->mediaY;
+    total->Sxx = m->Sxx;
+    total->Sxy = m->Sxy;
+    total->Syy = m->Syy;
+}
+
+// Retorna 0 em sucesso ou -1 em erro (já informado em stderr)
+static inline int grava_modelo(const char *nomeArquivo, const Modelo *m) {
+    FILE *arquivo = fopen(nomeArquivo, "wb");
+    if (!arquivo) {
+        perror("Erro ao criar o arquivo do modelo");
+        return -1;
+    }
+    int ok = fwrite(m, sizeof(*m), 1, arquivo) == 1;
+    if (fclose(arquivo) != 0)
+        ok = 0;
+    if (!ok) {
+        fprintf(stderr, "Erro ao gravar o modelo em %s\n", nomeArquivo);
+        return -1;
+    }
+    return 0;
+}
+
+// Retorna 0 em sucesso ou -1 se o arquivo não existe ou não é um modelo válido
+static inline int carrega_modelo(const char *nomeArquivo, Modelo *m) {
+    FILE *arquivo = fopen(nomeArquivo, "rb");
+    if (!arquivo) {
+        perror("Erro ao abrir o arquivo do modelo");
+        return -1;
+    }
+    int ok = fread(m, sizeof(*m), 1, arquivo) == 1;
+    fclose(arquivo);
+    if (!ok || memcmp(m->magica, MODELO_MAGICA, sizeof(m->magica)) != 0 ||
+        m->versao != MODELO_VERSAO) {
+        fprintf(stderr, "Erro: %s nao e um arquivo de modelo valido\n", nomeArquivo);
+        return -1;
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,292 @@
+/* File:     motor_regressao.h
+ *
+ * Purpose:  Motor único da regressão linear simples, especializado em tempo
+ *           de compilação. Cada combinação das três opções abaixo usa o seu
+ *           próprio laço interno, com várias cadeias de acumulação
+ *           independentes e sem desvios (a escolha é feita pelo
+ *           pré-processador, não por ifs dentro do laço). Os laços são os
+ *           núcleos de nucleos_simd.h, um por acumulador e tipo, os mesmos
+ *           de regressao-linear-mse.c; o motor só escolhe qual chamar
+ *           (MOTOR_NUCLEO_*) e cuida dos pedaços, da redução e das contas
+ *           finais:
+ *
+ *             MOTOR_ACUMULADOR  MOTOR_SOMAS:     Σx, Σy, Σx², Σxy (só A e B)
+ *                               MOTOR_SSE:       as somas e uma segunda
+ *                                                passada com Σ(y - ŷ)² (MSE)
+ *                               MOTOR_ESTENDIDO: as somas e Σy² na mesma
+ *                                                passada, compensadas (MSE
+ *                                                sem reler, ver soma_compensada.h)
+ *             MOTOR_TIPO        MOTOR_F64:    X e Y em double
+ *                               MOTOR_F32:    em float
+ *                               MOTOR_FIXO32: em int32, ponto fixo
+ *                                             (v = centro + q·passo)
+ *                               Os dois reduzidos leem metade dos bytes por
+ *                               passada; a acumulação é sempre em double
+ *             MOTOR_PARALELO    0: laço direto na thread chamadora;
+ *                               1: pedaços distribuídos pelo pool com roubo
+ *
+ *           Todas as somas são feitas sobre os dados deslocados pelo primeiro
+ *           ponto (x - x0, y - y0): os coeficientes não mudam e Sxx, Sxy e Syy
+ *           deixam de ser a diferença de dois números enormes. O mesmo corte
+ *           em pedaços de MOTOR_PEDACO pontos, reduzidos em ordem, é usado
+ *           nas versões sequencial e paralela: as duas dão o mesmo resultado,
+ *           bit a bit, com qualquer número de threads.
+ *
+ *           No ponto fixo o laço trabalha direto sobre os inteiros q (só a
+ *           conversão int32 -> double, sem a multiplicação pelo passo) e
+ *           motor_calcula desfaz a escala no final: B = B_q·passoY/passoX,
+ *           A = centroY + passoY·A_q - B·centroX e MSE = passoY²·MSE_q.
+ *
+ *           As opções vêm do compilador (-DMOTOR_ACUMULADOR=MOTOR_SSE ...);
+ *           o Makefile gera um executável para cada combinação.
+ *
+ * Exemplo:
+ *    #define MOTOR_ACUMULADOR MOTOR_SSE
+ *    #define MOTOR_PARALELO 1
+ *    #include "motor_regressao.h"
+ *    . . .
+ *    Motor m;
+ *    motor_inicializa(&m, X, Y, N, &pool);   // pool só com MOTOR_PARALELO
+ *    motor_escala(&m, centroX, passoX, centroY, passoY);  // só com MOTOR_FIXO32
+ *    if (motor_calcula(&m) == 0)
+ *        printf("%f %f %f\n", m.A, m.B, m.MSE);
+ *    motor_libera(&m);
+ */
+#ifndef _MOTOR_REGRESSAO_H_
+#define _MOTOR_REGRESSAO_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "timer.h"
+#include "nucleos_simd.h"
+
+#define MOTOR_SOMAS     1
+#define MOTOR_SSE       2
+#define MOTOR_ESTENDIDO 3
+
+#ifndef MOTOR_ACUMULADOR
+#define MOTOR_ACUMULADOR MOTOR_SSE
+#endif
+// Mesmos códigos do campo tipo de formato_binario.h
+#define MOTOR_F64    1
+#define MOTOR_F32    2
+#define MOTOR_FIXO32 3
+
+#ifndef MOTOR_TIPO
+#define MOTOR_TIPO MOTOR_F64
+#endif
+#ifndef MOTOR_PARALELO
+#define MOTOR_PARALELO 1
+#endif
+
+#if MOTOR_ACUMULADOR != MOTOR_SOMAS && MOTOR_ACUMULADOR != MOTOR_SSE && MOTOR_ACUMULADOR != MOTOR_ESTENDIDO
+#error "MOTOR_ACUMULADOR deve ser MOTOR_SOMAS, MOTOR_SSE ou MOTOR_ESTENDIDO"
+#endif
+#if MOTOR_TIPO != MOTOR_F64 && MOTOR_TIPO != MOTOR_F32 && MOTOR_TIPO != MOTOR_FIXO32
+#error "MOTOR_TIPO deve ser MOTOR_F64, MOTOR_F32 ou MOTOR_FIXO32"
+#endif
+
+#if MOTOR_PARALELO
+#include "pool_threads.h"
+#endif
+
+#define MOTOR_PEDACO  16384     // Pontos por pedaço (256 KB de X e Y em double, 128 KB reduzidos)
+#define MOTOR_TEM_MSE (MOTOR_ACUMULADOR != MOTOR_SOMAS)
+
+// Núcleos do tipo escolhido (nucleos_simd.h)
+#if MOTOR_TIPO == MOTOR_F32
+typedef float MotorValor;
+#define MOTOR_NOME_TIPO "float"
+#define MOTOR_NUCLEO_SOMAS      nucleo_somas_f32
+#define MOTOR_NUCLEO_ERRO       nucleo_erro_f32
+#define MOTOR_NUCLEO_ESTENDIDAS nucleo_somas_estendidas_f32
+#elif MOTOR_TIPO == MOTOR_FIXO32
+typedef int32_t MotorValor;
+#define MOTOR_NOME_TIPO "ponto fixo int32"
+#define MOTOR_NUCLEO_SOMAS      nucleo_somas_fx32
+#define MOTOR_NUCLEO_ERRO       nucleo_erro_fx32
+#define MOTOR_NUCLEO_ESTENDIDAS nucleo_somas_estendidas_fx32
+#else
+typedef double MotorValor;
+#define MOTOR_NOME_TIPO "double"
+#define MOTOR_NUCLEO_SOMAS      nucleo_somas
+#define MOTOR_NUCLEO_ERRO       nucleo_erro
+#define MOTOR_NUCLEO_ESTENDIDAS nucleo_somas_estendidas
+#endif
+
+#if MOTOR_ACUMULADOR == MOTOR_SOMAS
+#define MOTOR_NOME_ACUMULADOR "somas"
+#elif MOTOR_ACUMULADOR == MOTOR_SSE
+#define MOTOR_NOME_ACUMULADOR "somas + SSE (duas passadas)"
+#else
+#define MOTOR_NOME_ACUMULADOR "somas estendidas (uma passada)"
+#endif
+
+#define MOTOR_NOME_MODO (MOTOR_PARALELO ? "paralelo" : "sequencial")
+
+// ==================== ACUMULADORES ====================
+// No MOTOR_ESTENDIDO cada soma é compensada (SomaComp): o SSE = Syy - Sxy²/Sxx
+// é a diferença de dois números quase iguais e em double puro perderia os dígitos
+#if MOTOR_ACUMULADOR == MOTOR_ESTENDIDO
+#define MOTOR_NUM_SOMAS 5  // Σx, Σy, Σx², Σxy, Σy²
+typedef SomaComp MotorSoma;
+#define MOTOR_COMBINA(a, b) comp_combina(&(a), (b))
+#else
+#define MOTOR_NUM_SOMAS 4  // Σx, Σy, Σx², Σxy
+typedef double MotorSoma;
+#define MOTOR_COMBINA(a, b) ((a) += (b))
+#endif
+
+// Somas de um pedaço, cada uma em uma linha de cache própria
+typedef struct {
+    MotorSoma s[MOTOR_NUM_SOMAS];
+#if MOTOR_ACUMULADOR == MOTOR_SSE
+    double erro;  // Σ(y - ŷ)² do pedaço
+#endif
+} __attribute__((aligned(64))) MotorSomas;
+
+typedef struct {
+    const MotorValor *X, *Y;
+    long N;
+    double x0, y0;           // Deslocamento (primeiro ponto)
+    double centroX, passoX;  // Ponto fixo: x = centroX + passoX·q (0 e 1 nos outros tipos)
+    double centroY, passoY;
+    double A, B, MSE;        // Resultado (MSE = 0 com MOTOR_SOMAS)
+    double tempoSomas;       // Somas e coeficientes (segundos)
+    double tempoMSE;         // Segunda passada (só MOTOR_SSE)
+    long numPedacos;
+    MotorSomas *pedacos;     // Somas de cada pedaço
+#if MOTOR_PARALELO
+    PoolThreads *pool;
+#endif
+} Motor;
+
+// Funções de cada pedaço: escrevem só na posição do seu pedaço
+static inline void motor_pedaco_somas(long inicio, long fim, long pedaco, void *contexto) {
+    Motor *m = (Motor *)contexto;
+#if MOTOR_ACUMULADOR == MOTOR_ESTENDIDO
+    MOTOR_NUCLEO_ESTENDIDAS(m->X + inicio, m->Y + inicio, fim - inicio, m->x0, m->y0,
+                            m->pedacos[pedaco].s);
+#else
+    MOTOR_NUCLEO_SOMAS(m->X + inicio, m->Y + inicio, fim - inicio, m->x0, m->y0, m->pedacos[pedaco].s);
+#endif
+}
+
+#if MOTOR_ACUMULADOR == MOTOR_SSE
+static inline void motor_pedaco_erro(long inicio, long fim, long pedaco, void *contexto) {
+    Motor *m = (Motor *)contexto;
+    m->pedacos[pedaco].erro = MOTOR_NUCLEO_ERRO(m->X + inicio, m->Y + inicio, fim - inicio, m->A, m->B);
+}
+#endif
+
+// Executa funcao em todos os pedaços: pelo pool (com roubo) ou em sequência
+static inline void motor_percorre(Motor *m, void (*funcao)(long, long, long, void *)) {
+#if MOTOR_PARALELO
+    pool_executa_pedacos(m->pool, m->N, MOTOR_PEDACO, funcao, m);
+#else
+    for (long k = 0; k < m->numPedacos; k++) {
+        long inicio = k * MOTOR_PEDACO;
+        funcao(inicio, (inicio + MOTOR_PEDACO < m->N) ? inicio + MOTOR_PEDACO : m->N, k, m);
+    }
+#endif
+}
+
+// ==================== INTERFACE ====================
+// X e Y precisam continuar válidos até motor_libera; pool é ignorado na versão sequencial.
+// Escolhe também a versão dos núcleos para esta CPU (nucleos_seleciona)
+static inline void motor_inicializa(Motor *m, const MotorValor *X, const MotorValor *Y, long N, void *pool) {
+    nucleos_seleciona();
+    memset(m, 0, sizeof(*m));
+    m->X = X;
+    m->Y = Y;
+    m->N = N;
+    m->x0 = (N > 0) ? (double)X[0] : 0.0;
+    m->y0 = (N > 0) ? (double)Y[0] : 0.0;
+    m->numPedacos = (N + MOTOR_PEDACO - 1) / MOTOR_PEDACO;
+    m->passoX = m->passoY = 1.0;
+#if MOTOR_PARALELO
+    m->pool = (PoolThreads *)pool;
+#else
+    (void)pool;
+#endif
+}
+
+// Escala do ponto fixo (binario_fixo_escala); ignorada nos outros tipos
+static inline void motor_escala(Motor *m, double centroX, double passoX, double centroY, double passoY) {
+    m->centroX = centroX;
+    m->passoX = passoX;
+    m->centroY = centroY;
+    m->passoY = passoY;
+}
+
+// Calcula A, B e (exceto com MOTOR_SOMAS) o MSE. Retorna 0 ou -1 (sem memória)
+static inline int motor_calcula(Motor *m) {
+    double inicio, fim;
+
+    m->pedacos = aligned_alloc(64, (m->numPedacos + 1) * sizeof(MotorSomas));
+    if (!m->pedacos)
+        return -1;
+
+    // ==================== PRIMEIRA PASSADA: SOMAS ====================
+    GET_TIME(inicio);
+    motor_percorre(m, motor_pedaco_somas);
+
+    // Redução em ordem de pedaço (independente de quem executou cada um)
+    MotorSoma t[MOTOR_NUM_SOMAS];
+    memset(t, 0, sizeof(t));
+    for (long k = 0; k < m->numPedacos; k++)
+        for (int c = 0; c < MOTOR_NUM_SOMAS; c++)
+            MOTOR_COMBINA(t[c], m->pedacos[k].s[c]);
+
+    double n = (double)m->N;
+#if MOTOR_ACUMULADOR == MOTOR_ESTENDIDO
+    // As mesmas contas em double-double; SSE = Syy - B·Sxy já na primeira passada
+    DuplaDupla dn = dd_de(n);
+    DuplaDupla sx = dd_de_soma(t[0]), sy = dd_de_soma(t[1]);
+    DuplaDupla sxx = dd_sub(dd_de_soma(t[2]), dd_div(dd_mul(sx, sx), dn));
+    DuplaDupla sxy = dd_sub(dd_de_soma(t[3]), dd_div(dd_mul(sx, sy), dn));
+    DuplaDupla syy = dd_sub(dd_de_soma(t[4]), dd_div(dd_mul(sy, sy), dn));
+    DuplaDupla b = dd_div(sxy, sxx);
+    DuplaDupla sse = dd_sub(syy, dd_mul(b, sxy));
+    m->B = b.hi;
+    m->A = (m->y0 + dd_div(sy, dn).hi) - m->B * (m->x0 + dd_div(sx, dn).hi);
+    m->MSE = (sse.hi > 0 ? sse.hi : 0.0) / n;
+#else
+    // Sxx = Σx'² - (Σx')²/n e Sxy = Σx'y' - Σx'Σy'/n sobre os dados deslocados
+    double mediaX = t[0] / n, mediaY = t[1] / n;
+    double Sxx = t[2] - t[0] * mediaX;
+    double Sxy = t[3] - t[0] * mediaY;
+    m->B = Sxy / Sxx;
+    m->A = (m->y0 + mediaY) - m->B * (m->x0 + mediaX);
+#endif
+    GET_TIME(fim);
+    m->tempoSomas = fim - inicio;
+
+#if MOTOR_ACUMULADOR == MOTOR_SSE
+    // ==================== SEGUNDA PASSADA: Σ(y - ŷ)² ====================
+    GET_TIME(inicio);
+    motor_percorre(m, motor_pedaco_erro);
+    double sse = 0;
+    for (long k = 0; k < m->numPedacos; k++)
+        sse += m->pedacos[k].erro;
+    m->MSE = sse / n;
+    GET_TIME(fim);
+    m->tempoMSE = fim - inicio;
+#endif
+
+#if MOTOR_TIPO == MOTOR_FIXO32
+    // A reta foi ajustada sobre os inteiros q: volta para as unidades de x e y
+    m->B = m->B * m->passoY / m->passoX;
+    m->A = m->centroY + m->passoY * m->A - m->B * m->centroX;
+    m->MSE = m->MSE * m->passoY * m->passoY;
+#endif
+    return 0;
+}
+
+static inline void motor_libera(Motor *m) {
+    free(m->pedacos);
+    m->pedacos = NULL;
+}
+
+#endif
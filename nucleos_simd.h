@@ -0,0 +1,865 @@
+/* File:     nucleos_simd.h
+ *
+ * Purpose:  Núcleos vetorizados dos dois laços da regressão:
+ *             - somas: Σx, Σy, Σx², Σxy (dos pontos deslocados por x0, y0)
+ *             - erro:  Σ(y - (A + B*x))²
+ *             - somas estendidas: as somas e Σy², compensadas (só escalar)
+ *             - previsão: y[i] = A + B*x[i] (modo de previsão em lote)
+ *
+ *           São a única implementação desses acumuladores: o programa
+ *           regressao-linear-mse.c e o motor (motor_regressao.h) chamam os
+ *           mesmos núcleos. Somas, erro e somas estendidas existem para
+ *           colunas em double (nucleo_somas), float (nucleo_somas_f32) e
+ *           int32 em ponto fixo (nucleo_somas_fx32), convertidas para double
+ *           na carga; a acumulação é sempre em double.
+ *
+ *           Cada núcleo mantém várias cadeias de acumulação independentes
+ *           (para não ficar esperando a latência de cada soma) e usa FMA
+ *           para x*x, x*y e o quadrado do resíduo. A versão é escolhida em
+ *           tempo de execução pelos recursos da CPU:
+ *             avx512 -> 8 doubles por registrador, 2 cadeias por soma
+ *             avx2   -> 4 doubles por registrador, 2 cadeias por soma
+ *             escalar -> 4 cadeias por soma, para qualquer CPU
+ *
+ *           O núcleo gram (regressão múltipla) acumula G += BᵀB para um
+ *           bloco B de linhas empacotadas com ld colunas (ld múltiplo de 8,
+ *           bloco e G alinhados em 64 bytes). G é calculado em ladrilhos de
+ *           4x8 (escalar, avx2) ou 8x8 (avx512) que ficam em registradores
+ *           durante todo o bloco; só os ladrilhos do triângulo superior
+ *           (coluna >= linha) são calculados.
+ *
+ *           Os núcleos dos estimadores robustos (regressao_robusta.h) usam
+ *           o resíduo r = (y - A) - B*x sem guardá-lo:
+ *             - inliers: para cada uma de numRetas retas, quantos pontos
+ *               têm |r| <= limiar (o bloco de pontos fica na cache enquanto
+ *               as retas passam por ele); soma em contagem[c]
+ *             - somas_inliers: só dos pontos com |r| <= limiar, n, Σd, Σr,
+ *               Σd², Σdr com d = x - cx (reajuste da reta do RANSAC)
+ *           A comparação vira máscara: avx2 soma a máscara (-1 por inlier)
+ *           em contadores inteiros, avx512 conta os bits da máscara.
+ *
+ *           Os núcleos do bootstrap (bootstrap_regressao.h):
+ *             - pesos_poisson: w[i] = número de limites <= u_i, com u_2p e
+ *               u_2p+1 as metades baixa e alta de aleat_u64(semente,
+ *               contador + p). Nas versões SIMD o SplitMix64 é vetorizado
+ *               (multiplicação de 64 bits montada com _mul_epu32) e as
+ *               metades de 32 bits já ficam, em cada registrador, na ordem
+ *               dos pontos; os pesos são idênticos aos da versão escalar
+ *             - somas_pesadas: Σw, Σw·d, Σw·e, Σw·d², Σw·d·e
+ *
+ *           A variável de ambiente REGRESSAO_SIMD (escalar, avx2, avx512)
+ *           força uma versão, para comparar as três na mesma máquina.
+ *
+ * Note:     Mudar a versão muda a ordem das somas, então os resultados
+ *           podem diferir nos últimos bits entre máquinas diferentes.
+ *
+ * Exemplo:
+ *    nucleos_seleciona();
+ *    double somas[4];
+ *    nucleo_somas(X, Y, n, 0, 0, somas);      // somas = {Σx, Σy, Σx², Σxy}
+ *    nucleo_somas_f32(xf, yf, n, x0, y0, somas);  // Σ(x - x0), ... de colunas float
+ *    double sse = nucleo_erro(X, Y, n, A, B);
+ *    nucleo_previsao(vx, n, A, B, saida);     // saida[i] = A + B*vx[i]
+ *    nucleo_gram(bloco, linhas, ld, G);       // G += blocoᵀ·bloco (triângulo superior)
+ *    nucleo_inliers(vx, vy, n, vA, vB, numRetas, limiar, contagem);
+ *    nucleo_somas_inliers(vx, vy, n, A, B, limiar, cx, somas5);
+ *    nucleo_pesos_poisson(semente, inicio / 2, n, limites, numLimites, w);
+ *    nucleo_somas_pesadas(d, e, w, n, somas5);
+ */
+#ifndef _NUCLEOS_SIMD_H_
+#define _NUCLEOS_SIMD_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "aleatorio.h"
+#include "soma_compensada.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define NUCLEOS_X86 1
+#endif
+
+typedef void (*NucleoSomas)(const double *vx, const double *vy, long n, double x0, double y0,
+                            double somas[4]);
+typedef void (*NucleoSomasF32)(const float *vx, const float *vy, long n, double x0, double y0,
+                               double somas[4]);
+typedef void (*NucleoSomasFx32)(const int32_t *vx, const int32_t *vy, long n, double x0, double y0,
+                                double somas[4]);
+typedef double (*NucleoErro)(const double *vx, const double *vy, long n, double A, double B);
+typedef double (*NucleoErroF32)(const float *vx, const float *vy, long n, double A, double B);
+typedef double (*NucleoErroFx32)(const int32_t *vx, const int32_t *vy, long n, double A, double B);
+typedef void (*NucleoSomasEstendidas)(const double *vx, const double *vy, long n, double x0, double y0,
+                                      SomaComp somas[5]);
+typedef void (*NucleoSomasEstendidasF32)(const float *vx, const float *vy, long n, double x0, double y0,
+                                         SomaComp somas[5]);
+typedef void (*NucleoSomasEstendidasFx32)(const int32_t *vx, const int32_t *vy, long n, double x0,
+                                          double y0, SomaComp somas[5]);
+typedef void (*NucleoPrevisao)(const double *vx, long n, double A, double B, double *saida);
+typedef void (*NucleoGram)(const double *bloco, long linhas, int ld, double *G);
+typedef void (*NucleoInliers)(const double *vx, const double *vy, long n, const double *A,
+                              const double *B, int numRetas, double limiar, long *contagem);
+typedef void (*NucleoSomasInliers)(const double *vx, const double *vy, long n, double A, double B,
+                                   double limiar, double cx, double somas[5]);
+typedef void (*NucleoPesosPoisson)(uint64_t semente, uint64_t contador, long n, const uint32_t *limites,
+                                   int numLimites, double *w);
+typedef void (*NucleoSomasPesadas)(const double *vd, const double *ve, const double *vw, long n,
+                                   double somas[5]);
+
+// ==================== VERSÃO ESCALAR (PORTÁVEL) ====================
+// Os acumuladores da regressão (somas, erro e somas estendidas) existem para
+// os três tipos de coluna de formato_binario.h: double (_f64), float (_f32)
+// e int32 em ponto fixo (_fx32, os inteiros q sem a escala). Os reduzidos
+// são convertidos para double na carga e acumulados em double; cada tipo
+// tem o seu próprio laço, gerado pelas macros NUCLEOS_*(sufixo, Tipo, ...).
+// As somas são dos pontos deslocados (x - x0, y - y0); x0 = y0 = 0 dá as
+// somas dos dados como estão.
+#define NUCLEOS_ESCALAR(sufixo, Tipo)                                                       \
+static inline void somas_escalar##sufixo(const Tipo *vx, const Tipo *vy, long n, double x0, double y0, \
+                                         double somas[4]) {                                \
+    double sx[4] = {0}, sy[4] = {0}, sxx[4] = {0}, sxy[4] = {0};                          \
+    long i = 0;                                                                            \
+                                                                                           \
+    for (; i + 4 <= n; i += 4) {                                                           \
+        for (int k = 0; k < 4; k++) {                                                      \
+            double x = (double)vx[i + k] - x0, y = (double)vy[i + k] - y0;                 \
+            sx[k]  += x;                                                                   \
+            sy[k]  += y;                                                                   \
+            sxx[k] += x * x;                                                               \
+            sxy[k] += x * y;                                                               \
+        }                                                                                  \
+    }                                                                                      \
+    for (; i < n; i++) {                                                                   \
+        double x = (double)vx[i] - x0, y = (double)vy[i] - y0;                             \
+        sx[0]  += x;                                                                       \
+        sy[0]  += y;                                                                       \
+        sxx[0] += x * x;                                                                   \
+        sxy[0] += x * y;                                                                   \
+    }                                                                                      \
+                                                                                           \
+    somas[0] = (sx[0] + sx[1]) + (sx[2] + sx[3]);                                          \
+    somas[1] = (sy[0] + sy[1]) + (sy[2] + sy[3]);                                          \
+    somas[2] = (sxx[0] + sxx[1]) + (sxx[2] + sxx[3]);                                      \
+    somas[3] = (sxy[0] + sxy[1]) + (sxy[2] + sxy[3]);                                      \
+}                                                                                          \
+                                                                                           \
+static inline double erro_escalar##sufixo(const Tipo *vx, const Tipo *vy, long n, double A, double B) { \
+    double se[4] = {0};                                                                    \
+    long i = 0;                                                                            \
+                                                                                           \
+    for (; i + 4 <= n; i += 4) {                                                           \
+        for (int k = 0; k < 4; k++) {                                                      \
+            double r = (double)vy[i + k] - (A + B * (double)vx[i + k]);                    \
+            se[k] += r * r;                                                                \
+        }                                                                                  \
+    }                                                                                      \
+    for (; i < n; i++) {                                                                   \
+        double r = (double)vy[i] - (A + B * (double)vx[i]);                                \
+        se[0] += r * r;                                                                    \
+    }                                                                                      \
+    return (se[0] + se[1]) + (se[2] + se[3]);                                              \
+}                                                                                          \
+                                                                                           \
+/* Σx, Σy, Σx², Σxy, Σy² compensadas (soma_compensada.h), 4 cadeias: o SSE = */            \
+/* Syy - Sxy²/Sxx sai das somas sem a segunda passada. Só existe a versão    */            \
+/* escalar (o compilador vetoriza as cadeias com -march)                     */            \
+static inline void somas_estendidas_escalar##sufixo(const Tipo *vx, const Tipo *vy, long n,      \
+                                                    double x0, double y0, SomaComp somas[5]) {   \
+    SomaComp s[5][4];                                                                      \
+    memset(s, 0, sizeof(s));                                                               \
+    long i = 0;                                                                            \
+                                                                                           \
+    for (; i + 4 <= n; i += 4) {                                                           \
+        for (int k = 0; k < 4; k++) {                                                      \
+            double x = (double)vx[i + k] - x0, y = (double)vy[i + k] - y0;                 \
+            comp_adiciona(&s[0][k], x);                                                    \
+            comp_adiciona(&s[1][k], y);                                                    \
+            comp_adiciona_produto(&s[2][k], x, x);                                         \
+            comp_adiciona_produto(&s[3][k], x, y);                                         \
+            comp_adiciona_produto(&s[4][k], y, y);                                         \
+        }                                                                                  \
+    }                                                                                      \
+    for (; i < n; i++) {                                                                   \
+        double x = (double)vx[i] - x0, y = (double)vy[i] - y0;                             \
+        comp_adiciona(&s[0][0], x);                                                        \
+        comp_adiciona(&s[1][0], y);                                                        \
+        comp_adiciona_produto(&s[2][0], x, x);                                             \
+        comp_adiciona_produto(&s[3][0], x, y);                                             \
+        comp_adiciona_produto(&s[4][0], y, y);                                             \
+    }                                                                                      \
+                                                                                           \
+    for (int c = 0; c < 5; c++) {                                                          \
+        comp_combina(&s[c][0], s[c][1]);                                                   \
+        comp_combina(&s[c][2], s[c][3]);                                                   \
+        comp_combina(&s[c][0], s[c][2]);                                                   \
+        somas[c] = s[c][0];                                                                \
+    }                                                                                      \
+}
+
+NUCLEOS_ESCALAR(_f64, double)
+NUCLEOS_ESCALAR(_f32, float)
+NUCLEOS_ESCALAR(_fx32, int32_t)
+
+static inline void previsao_escalar(const double *vx, long n, double A, double B, double *saida) {
+    for (long i = 0; i < n; i++)
+        saida[i] = A + B * vx[i];
+}
+
+// G[j][k] += Σ_i bloco[i][j]*bloco[i][k], em ladrilhos de 4 linhas x 8 colunas de G
+static inline void gram_escalar(const double *bloco, long linhas, int ld, double *G) {
+    for (int j0 = 0; j0 < ld; j0 += 4) {
+        for (int k0 = j0 & ~7; k0 < ld; k0 += 8) {
+            double acc[4][8] = {{0}};
+            for (long i = 0; i < linhas; i++) {
+                const double *linha = bloco + i * ld;
+                for (int a = 0; a < 4; a++)
+                    for (int b = 0; b < 8; b++)
+                        acc[a][b] += linha[j0 + a] * linha[k0 + b];
+            }
+            for (int a = 0; a < 4; a++)
+                for (int b = 0; b < 8; b++)
+                    G[(j0 + a) * ld + k0 + b] += acc[a][b];
+        }
+    }
+}
+
+// contagem[c] += pontos com |(y - A[c]) - B[c]*x| <= limiar
+static inline void inliers_escalar(const double *vx, const double *vy, long n, const double *A,
+                                   const double *B, int numRetas, double limiar, long *contagem) {
+    for (int c = 0; c < numRetas; c++) {
+        long conta = 0;
+        for (long i = 0; i < n; i++) {
+            double r = (vy[i] - A[c]) - B[c] * vx[i];
+            conta += (r <= limiar) & (r >= -limiar);
+        }
+        contagem[c] += conta;
+    }
+}
+
+// somas = {n, Σd, Σr, Σd², Σdr} dos inliers da reta (A, B), com d = x - cx
+static inline void somas_inliers_escalar(const double *vx, const double *vy, long n, double A, double B,
+                                         double limiar, double cx, double somas[5]) {
+    double s[5] = {0};
+    for (long i = 0; i < n; i++) {
+        double r = (vy[i] - A) - B * vx[i];
+        if (r <= limiar && r >= -limiar) {
+            double d = vx[i] - cx;
+            s[0] += 1.0;
+            s[1] += d;
+            s[2] += r;
+            s[3] += d * d;
+            s[4] += d * r;
+        }
+    }
+    memcpy(somas, s, sizeof(s));
+}
+
+#define NUCLEOS_MAX_LIMITES 16  // Limites aceitos por pesos_poisson
+
+static inline void pesos_poisson_escalar(uint64_t semente, uint64_t contador, long n, const uint32_t *limites,
+                                         int numLimites, double *w) {
+    for (long i = 0; i < n; i += 2) {
+        uint64_t z = aleat_u64(semente, contador + i / 2);
+        uint32_t u[2] = {(uint32_t)z, (uint32_t)(z >> 32)};
+        for (int h = 0; h < 2 && i + h < n; h++) {
+            int peso = 0;
+            for (int k = 0; k < numLimites; k++)
+                peso += u[h] >= limites[k];
+            w[i + h] = peso;
+        }
+    }
+}
+
+// somas = {Σw, Σw·d, Σw·e, Σw·d², Σw·d·e}, 2 cadeias por soma
+static inline void somas_pesadas_escalar(const double *vd, const double *ve, const double *vw, long n,
+                                         double somas[5]) {
+    double s[2][5] = {{0}};
+    long i = 0;
+
+    for (; i + 2 <= n; i += 2) {
+        for (int k = 0; k < 2; k++) {
+            double w = vw[i + k], wd = w * vd[i + k];
+            s[k][0] += w;
+            s[k][1] += wd;
+            s[k][2] += w * ve[i + k];
+            s[k][3] += wd * vd[i + k];
+            s[k][4] += wd * ve[i + k];
+        }
+    }
+    for (; i < n; i++) {
+        double w = vw[i], wd = w * vd[i];
+        s[0][0] += w;
+        s[0][1] += wd;
+        s[0][2] += w * ve[i];
+        s[0][3] += wd * vd[i];
+        s[0][4] += wd * ve[i];
+    }
+    for (int q = 0; q < 5; q++)
+        somas[q] = s[0][q] + s[1][q];
+}
+
+#ifdef NUCLEOS_X86
+// ==================== VERSÃO AVX2 + FMA ====================
+__attribute__((target("avx2,fma")))
+static inline double avx2_soma_horizontal(__m256d v) {
+    __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+}
+
+// Carga de 4 elementos de cada tipo, já convertidos para double
+#define AVX2_CARREGA_F64(p)  _mm256_loadu_pd(p)
+#define AVX2_CARREGA_F32(p)  _mm256_cvtps_pd(_mm_loadu_ps(p))
+#define AVX2_CARREGA_FX32(p) _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i *)(p)))
+
+#define NUCLEOS_AVX2(sufixo, Tipo, CARREGA)                                                 \
+__attribute__((target("avx2,fma")))                                                        \
+static inline void somas_avx2##sufixo(const Tipo *vx, const Tipo *vy, long n, double x0, double y0, \
+                                      double somas[4]) {                                   \
+    __m256d dx = _mm256_set1_pd(x0), dy = _mm256_set1_pd(y0);                              \
+    __m256d sx0 = _mm256_setzero_pd(), sx1 = sx0, sy0 = sx0, sy1 = sx0;                    \
+    __m256d sxx0 = sx0, sxx1 = sx0, sxy0 = sx0, sxy1 = sx0;                                \
+    long i = 0;                                                                            \
+                                                                                           \
+    for (; i + 8 <= n; i += 8) {                                                           \
+        __m256d xa = _mm256_sub_pd(CARREGA(vx + i), dx);                                   \
+        __m256d xb = _mm256_sub_pd(CARREGA(vx + i + 4), dx);                               \
+        __m256d ya = _mm256_sub_pd(CARREGA(vy + i), dy);                                   \
+        __m256d yb = _mm256_sub_pd(CARREGA(vy + i + 4), dy);                               \
+        sx0  = _mm256_add_pd(sx0, xa);                                                     \
+        sx1  = _mm256_add_pd(sx1, xb);                                                     \
+        sy0  = _mm256_add_pd(sy0, ya);                                                     \
+        sy1  = _mm256_add_pd(sy1, yb);                                                     \
+        sxx0 = _mm256_fmadd_pd(xa, xa, sxx0);                                              \
+        sxx1 = _mm256_fmadd_pd(xb, xb, sxx1);                                              \
+        sxy0 = _mm256_fmadd_pd(xa, ya, sxy0);                                              \
+        sxy1 = _mm256_fmadd_pd(xb, yb, sxy1);                                              \
+    }                                                                                      \
+                                                                                           \
+    double resto[4];                                                                       \
+    somas_escalar##sufixo(vx + i, vy + i, n - i, x0, y0, resto);                           \
+    somas[0] = avx2_soma_horizontal(_mm256_add_pd(sx0, sx1)) + resto[0];                   \
+    somas[1] = avx2_soma_horizontal(_mm256_add_pd(sy0, sy1)) + resto[1];                   \
+    somas[2] = avx2_soma_horizontal(_mm256_add_pd(sxx0, sxx1)) + resto[2];                 \
+    somas[3] = avx2_soma_horizontal(_mm256_add_pd(sxy0, sxy1)) + resto[3];                 \
+}                                                                                          \
+                                                                                           \
+__attribute__((target("avx2,fma")))                                                        \
+static inline double erro_avx2##sufixo(const Tipo *vx, const Tipo *vy, long n, double A, double B) { \
+    __m256d a = _mm256_set1_pd(A), b = _mm256_set1_pd(B);                                  \
+    __m256d se0 = _mm256_setzero_pd(), se1 = se0, se2 = se0, se3 = se0;                    \
+    long i = 0;                                                                            \
+                                                                                           \
+    for (; i + 16 <= n; i += 16) {                                                         \
+        /* r = (y - A) - B*x ; se += r*r */                                                \
+        __m256d r0 = _mm256_fnmadd_pd(b, CARREGA(vx + i),      _mm256_sub_pd(CARREGA(vy + i), a));      \
+        __m256d r1 = _mm256_fnmadd_pd(b, CARREGA(vx + i + 4),  _mm256_sub_pd(CARREGA(vy + i + 4), a));  \
+        __m256d r2 = _mm256_fnmadd_pd(b, CARREGA(vx + i + 8),  _mm256_sub_pd(CARREGA(vy + i + 8), a));  \
+        __m256d r3 = _mm256_fnmadd_pd(b, CARREGA(vx + i + 12), _mm256_sub_pd(CARREGA(vy + i + 12), a)); \
+        se0 = _mm256_fmadd_pd(r0, r0, se0);                                                \
+        se1 = _mm256_fmadd_pd(r1, r1, se1);                                                \
+        se2 = _mm256_fmadd_pd(r2, r2, se2);                                                \
+        se3 = _mm256_fmadd_pd(r3, r3, se3);                                                \
+    }                                                                                      \
+                                                                                           \
+    __m256d total = _mm256_add_pd(_mm256_add_pd(se0, se1), _mm256_add_pd(se2, se3));       \
+    return avx2_soma_horizontal(total) + erro_escalar##sufixo(vx + i, vy + i, n - i, A, B); \
+}
+
+NUCLEOS_AVX2(_f64, double, AVX2_CARREGA_F64)
+NUCLEOS_AVX2(_f32, float, AVX2_CARREGA_F32)
+NUCLEOS_AVX2(_fx32, int32_t, AVX2_CARREGA_FX32)
+
+__attribute__((target("avx2,fma")))
+static inline void previsao_avx2(const double *vx, long n, double A, double B, double *saida) {
+    __m256d a = _mm256_set1_pd(A), b = _mm256_set1_pd(B);
+    long i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_pd(saida + i,     _mm256_fmadd_pd(b, _mm256_loadu_pd(vx + i), a));
+        _mm256_storeu_pd(saida + i + 4, _mm256_fmadd_pd(b, _mm256_loadu_pd(vx + i + 4), a));
+    }
+    previsao_escalar(vx + i, n - i, A, B, saida + i);
+}
+
+// Máscara do inlier (todos os bits 1) subtraída de contadores de 64 bits
+__attribute__((target("avx2,fma")))
+static inline void inliers_avx2(const double *vx, const double *vy, long n, const double *A,
+                                const double *B, int numRetas, double limiar, long *contagem) {
+    __m256d t = _mm256_set1_pd(limiar), sinal = _mm256_set1_pd(-0.0);
+
+    for (int c = 0; c < numRetas; c++) {
+        __m256d a = _mm256_set1_pd(A[c]), b = _mm256_set1_pd(B[c]);
+        __m256i c0 = _mm256_setzero_si256(), c1 = c0;
+        long i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256d r0 = _mm256_fnmadd_pd(b, _mm256_loadu_pd(vx + i),     _mm256_sub_pd(_mm256_loadu_pd(vy + i), a));
+            __m256d r1 = _mm256_fnmadd_pd(b, _mm256_loadu_pd(vx + i + 4), _mm256_sub_pd(_mm256_loadu_pd(vy + i + 4), a));
+            __m256d m0 = _mm256_cmp_pd(_mm256_andnot_pd(sinal, r0), t, _CMP_LE_OQ);
+            __m256d m1 = _mm256_cmp_pd(_mm256_andnot_pd(sinal, r1), t, _CMP_LE_OQ);
+            c0 = _mm256_sub_epi64(c0, _mm256_castpd_si256(m0));
+            c1 = _mm256_sub_epi64(c1, _mm256_castpd_si256(m1));
+        }
+        long partes[4];
+        _mm256_storeu_si256((__m256i *)partes, _mm256_add_epi64(c0, c1));
+        contagem[c] += (partes[0] + partes[1]) + (partes[2] + partes[3]);
+        inliers_escalar(vx + i, vy + i, n - i, A + c, B + c, 1, limiar, contagem + c);
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static inline void somas_inliers_avx2(const double *vx, const double *vy, long n, double A, double B,
+                                      double limiar, double cx, double somas[5]) {
+    __m256d a = _mm256_set1_pd(A), b = _mm256_set1_pd(B), c = _mm256_set1_pd(cx);
+    __m256d t = _mm256_set1_pd(limiar), sinal = _mm256_set1_pd(-0.0), um = _mm256_set1_pd(1.0);
+    __m256d sn = _mm256_setzero_pd(), sd = sn, sr = sn, sdd = sn, sdr = sn;
+    long i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = _mm256_loadu_pd(vx + i);
+        __m256d r = _mm256_fnmadd_pd(b, x, _mm256_sub_pd(_mm256_loadu_pd(vy + i), a));
+        __m256d m = _mm256_cmp_pd(_mm256_andnot_pd(sinal, r), t, _CMP_LE_OQ);
+        __m256d d = _mm256_and_pd(m, _mm256_sub_pd(x, c));  // Zero fora dos inliers
+        r = _mm256_and_pd(m, r);
+        sn  = _mm256_add_pd(sn, _mm256_and_pd(m, um));
+        sd  = _mm256_add_pd(sd, d);
+        sr  = _mm256_add_pd(sr, r);
+        sdd = _mm256_fmadd_pd(d, d, sdd);
+        sdr = _mm256_fmadd_pd(d, r, sdr);
+    }
+
+    double resto[5];
+    somas_inliers_escalar(vx + i, vy + i, n - i, A, B, limiar, cx, resto);
+    somas[0] = avx2_soma_horizontal(sn) + resto[0];
+    somas[1] = avx2_soma_horizontal(sd) + resto[1];
+    somas[2] = avx2_soma_horizontal(sr) + resto[2];
+    somas[3] = avx2_soma_horizontal(sdd) + resto[3];
+    somas[4] = avx2_soma_horizontal(sdr) + resto[4];
+}
+
+// a·c (mod 2^64) em cada elemento: lo·lo + (hi·lo + lo·hi) << 32
+__attribute__((target("avx2,fma")))
+static inline __m256i avx2_mul64(__m256i a, uint64_t c) {
+    __m256i cBaixo = _mm256_set1_epi64x((long long)(c & 0xFFFFFFFFu));
+    __m256i cAlto = _mm256_set1_epi64x((long long)(c >> 32));
+    __m256i cruzado = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), cBaixo),
+                                       _mm256_mul_epu32(a, cAlto));
+    return _mm256_add_epi64(_mm256_mul_epu32(a, cBaixo), _mm256_slli_epi64(cruzado, 32));
+}
+
+// aleat_mistura em 4 elementos
+__attribute__((target("avx2,fma")))
+static inline __m256i avx2_mistura(__m256i z) {
+    z = avx2_mul64(_mm256_xor_si256(z, _mm256_srli_epi64(z, 30)), 0xBF58476D1CE4E5B9ULL);
+    z = avx2_mul64(_mm256_xor_si256(z, _mm256_srli_epi64(z, 27)), 0x94D049BB133111EBULL);
+    return _mm256_xor_si256(z, _mm256_srli_epi64(z, 31));
+}
+
+// 8 pesos por iteração; u >= limite sem sinal vira limite > u com o bit de
+// sinal invertido dos dois lados, e peso = numLimites - #(limite > u)
+__attribute__((target("avx2,fma")))
+static inline void pesos_poisson_avx2(uint64_t semente, uint64_t contador, long n, const uint32_t *limites,
+                                      int numLimites, double *w) {
+    __m256i sinal = _mm256_set1_epi32((int)0x80000000u), lim[NUCLEOS_MAX_LIMITES];
+    for (int k = 0; k < numLimites; k++)
+        lim[k] = _mm256_set1_epi32((int)(limites[k] ^ 0x80000000u));
+    uint64_t base = aleat_mistura(semente) + (contador + 1) * ALEAT_GAMA;
+    __m256i z = _mm256_set_epi64x((long long)(base + 3 * ALEAT_GAMA), (long long)(base + 2 * ALEAT_GAMA),
+                                  (long long)(base + ALEAT_GAMA), (long long)base);
+    __m256i passo = _mm256_set1_epi64x((long long)(4 * ALEAT_GAMA));
+    long i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256i u = _mm256_xor_si256(avx2_mistura(z), sinal);
+        z = _mm256_add_epi64(z, passo);
+        __m256i peso = _mm256_set1_epi32(numLimites);
+        for (int k = 0; k < numLimites; k++)
+            peso = _mm256_add_epi32(peso, _mm256_cmpgt_epi32(lim[k], u));  // -1 se u < limite
+        _mm256_storeu_pd(w + i, _mm256_cvtepi32_pd(_mm256_castsi256_si128(peso)));
+        _mm256_storeu_pd(w + i + 4, _mm256_cvtepi32_pd(_mm256_extracti128_si256(peso, 1)));
+    }
+    pesos_poisson_escalar(semente, contador + i / 2, n - i, limites, numLimites, w + i);
+}
+
+__attribute__((target("avx2,fma")))
+static inline void somas_pesadas_avx2(const double *vd, const double *ve, const double *vw, long n,
+                                      double somas[5]) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = s0, s2 = s0, s3 = s0, s4 = s0;
+    __m256d t0 = s0, t1 = s0, t2 = s0, t3 = s0, t4 = s0;
+    long i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256d w0 = _mm256_loadu_pd(vw + i), w1 = _mm256_loadu_pd(vw + i + 4);
+        __m256d d0 = _mm256_loadu_pd(vd + i), d1 = _mm256_loadu_pd(vd + i + 4);
+        __m256d e0 = _mm256_loadu_pd(ve + i), e1 = _mm256_loadu_pd(ve + i + 4);
+        __m256d wd0 = _mm256_mul_pd(w0, d0), wd1 = _mm256_mul_pd(w1, d1);
+        s0 = _mm256_add_pd(s0, w0);
+        t0 = _mm256_add_pd(t0, w1);
+        s1 = _mm256_add_pd(s1, wd0);
+        t1 = _mm256_add_pd(t1, wd1);
+        s2 = _mm256_fmadd_pd(w0, e0, s2);
+        t2 = _mm256_fmadd_pd(w1, e1, t2);
+        s3 = _mm256_fmadd_pd(wd0, d0, s3);
+        t3 = _mm256_fmadd_pd(wd1, d1, t3);
+        s4 = _mm256_fmadd_pd(wd0, e0, s4);
+        t4 = _mm256_fmadd_pd(wd1, e1, t4);
+    }
+
+    double resto[5];
+    somas_pesadas_escalar(vd + i, ve + i, vw + i, n - i, resto);
+    somas[0] = avx2_soma_horizontal(_mm256_add_pd(s0, t0)) + resto[0];
+    somas[1] = avx2_soma_horizontal(_mm256_add_pd(s1, t1)) + resto[1];
+    somas[2] = avx2_soma_horizontal(_mm256_add_pd(s2, t2)) + resto[2];
+    somas[3] = avx2_soma_horizontal(_mm256_add_pd(s3, t3)) + resto[3];
+    somas[4] = avx2_soma_horizontal(_mm256_add_pd(s4, t4)) + resto[4];
+}
+
+// Ladrilho 4x8: 8 acumuladores; por linha, 2 cargas, 4 broadcasts e 8 FMAs
+__attribute__((target("avx2,fma")))
+static inline void gram_avx2(const double *bloco, long linhas, int ld, double *G) {
+    for (int j0 = 0; j0 < ld; j0 += 4) {
+        for (int k0 = j0 & ~7; k0 < ld; k0 += 8) {
+            __m256d c00 = _mm256_setzero_pd(), c01 = c00, c10 = c00, c11 = c00;
+            __m256d c20 = c00, c21 = c00, c30 = c00, c31 = c00;
+            for (long i = 0; i < linhas; i++) {
+                const double *linha = bloco + i * ld;
+                __m256d k0v = _mm256_load_pd(linha + k0), k1v = _mm256_load_pd(linha + k0 + 4);
+                __m256d x0 = _mm256_broadcast_sd(linha + j0);
+                __m256d x1 = _mm256_broadcast_sd(linha + j0 + 1);
+                __m256d x2 = _mm256_broadcast_sd(linha + j0 + 2);
+                __m256d x3 = _mm256_broadcast_sd(linha + j0 + 3);
+                c00 = _mm256_fmadd_pd(x0, k0v, c00);
+                c01 = _mm256_fmadd_pd(x0, k1v, c01);
+                c10 = _mm256_fmadd_pd(x1, k0v, c10);
+                c11 = _mm256_fmadd_pd(x1, k1v, c11);
+                c20 = _mm256_fmadd_pd(x2, k0v, c20);
+                c21 = _mm256_fmadd_pd(x2, k1v, c21);
+                c30 = _mm256_fmadd_pd(x3, k0v, c30);
+                c31 = _mm256_fmadd_pd(x3, k1v, c31);
+            }
+            double *g = G + j0 * ld + k0;
+            _mm256_store_pd(g,              _mm256_add_pd(_mm256_load_pd(g), c00));
+            _mm256_store_pd(g + 4,          _mm256_add_pd(_mm256_load_pd(g + 4), c01));
+            _mm256_store_pd(g + ld,         _mm256_add_pd(_mm256_load_pd(g + ld), c10));
+            _mm256_store_pd(g + ld + 4,     _mm256_add_pd(_mm256_load_pd(g + ld + 4), c11));
+            _mm256_store_pd(g + 2 * ld,     _mm256_add_pd(_mm256_load_pd(g + 2 * ld), c20));
+            _mm256_store_pd(g + 2 * ld + 4, _mm256_add_pd(_mm256_load_pd(g + 2 * ld + 4), c21));
+            _mm256_store_pd(g + 3 * ld,     _mm256_add_pd(_mm256_load_pd(g + 3 * ld), c30));
+            _mm256_store_pd(g + 3 * ld + 4, _mm256_add_pd(_mm256_load_pd(g + 3 * ld + 4), c31));
+        }
+    }
+}
+
+// ==================== VERSÃO AVX-512 ====================
+// Carga de 8 elementos de cada tipo, já convertidos para double
+#define AVX512_CARREGA_F64(p)  _mm512_loadu_pd(p)
+#define AVX512_CARREGA_F32(p)  _mm512_cvtps_pd(_mm256_loadu_ps(p))
+#define AVX512_CARREGA_FX32(p) _mm512_cvtepi32_pd(_mm256_loadu_si256((const __m256i *)(p)))
+
+#define NUCLEOS_AVX512(sufixo, Tipo, CARREGA)                                               \
+__attribute__((target("avx512f")))                                                         \
+static inline void somas_avx512##sufixo(const Tipo *vx, const Tipo *vy, long n, double x0, double y0, \
+                                        double somas[4]) {                                 \
+    __m512d dx = _mm512_set1_pd(x0), dy = _mm512_set1_pd(y0);                              \
+    __m512d sx0 = _mm512_setzero_pd(), sx1 = sx0, sy0 = sx0, sy1 = sx0;                    \
+    __m512d sxx0 = sx0, sxx1 = sx0, sxy0 = sx0, sxy1 = sx0;                                \
+    long i = 0;                                                                            \
+                                                                                           \
+    for (; i + 16 <= n; i += 16) {                                                         \
+        __m512d xa = _mm512_sub_pd(CARREGA(vx + i), dx);                                   \
+        __m512d xb = _mm512_sub_pd(CARREGA(vx + i + 8), dx);                               \
+        __m512d ya = _mm512_sub_pd(CARREGA(vy + i), dy);                                   \
+        __m512d yb = _mm512_sub_pd(CARREGA(vy + i + 8), dy);                               \
+        sx0  = _mm512_add_pd(sx0, xa);                                                     \
+        sx1  = _mm512_add_pd(sx1, xb);                                                     \
+        sy0  = _mm512_add_pd(sy0, ya);                                                     \
+        sy1  = _mm512_add_pd(sy1, yb);                                                     \
+        sxx0 = _mm512_fmadd_pd(xa, xa, sxx0);                                              \
+        sxx1 = _mm512_fmadd_pd(xb, xb, sxx1);                                              \
+        sxy0 = _mm512_fmadd_pd(xa, ya, sxy0);                                              \
+        sxy1 = _mm512_fmadd_pd(xb, yb, sxy1);                                              \
+    }                                                                                      \
+                                                                                           \
+    double resto[4];                                                                       \
+    somas_escalar##sufixo(vx + i, vy + i, n - i, x0, y0, resto);                           \
+    somas[0] = _mm512_reduce_add_pd(_mm512_add_pd(sx0, sx1)) + resto[0];                   \
+    somas[1] = _mm512_reduce_add_pd(_mm512_add_pd(sy0, sy1)) + resto[1];                   \
+    somas[2] = _mm512_reduce_add_pd(_mm512_add_pd(sxx0, sxx1)) + resto[2];                 \
+    somas[3] = _mm512_reduce_add_pd(_mm512_add_pd(sxy0, sxy1)) + resto[3];                 \
+}                                                                                          \
+                                                                                           \
+__attribute__((target("avx512f")))                                                         \
+static inline double erro_avx512##sufixo(const Tipo *vx, const Tipo *vy, long n, double A, double B) { \
+    __m512d a = _mm512_set1_pd(A), b = _mm512_set1_pd(B);                                  \
+    __m512d se0 = _mm512_setzero_pd(), se1 = se0, se2 = se0, se3 = se0;                    \
+    long i = 0;                                                                            \
+                                                                                           \
+    for (; i + 32 <= n; i += 32) {                                                         \
+        __m512d r0 = _mm512_fnmadd_pd(b, CARREGA(vx + i),      _mm512_sub_pd(CARREGA(vy + i), a));      \
+        __m512d r1 = _mm512_fnmadd_pd(b, CARREGA(vx + i + 8),  _mm512_sub_pd(CARREGA(vy + i + 8), a));  \
+        __m512d r2 = _mm512_fnmadd_pd(b, CARREGA(vx + i + 16), _mm512_sub_pd(CARREGA(vy + i + 16), a)); \
+        __m512d r3 = _mm512_fnmadd_pd(b, CARREGA(vx + i + 24), _mm512_sub_pd(CARREGA(vy + i + 24), a)); \
+        se0 = _mm512_fmadd_pd(r0, r0, se0);                                                \
+        se1 = _mm512_fmadd_pd(r1, r1, se1);                                                \
+        se2 = _mm512_fmadd_pd(r2, r2, se2);                                                \
+        se3 = _mm512_fmadd_pd(r3, r3, se3);                                                \
+    }                                                                                      \
+                                                                                           \
+    __m512d total = _mm512_add_pd(_mm512_add_pd(se0, se1), _mm512_add_pd(se2, se3));       \
+    return _mm512_reduce_add_pd(total) + erro_escalar##sufixo(vx + i, vy + i, n - i, A, B); \
+}
+
+NUCLEOS_AVX512(_f64, double, AVX512_CARREGA_F64)
+NUCLEOS_AVX512(_f32, float, AVX512_CARREGA_F32)
+NUCLEOS_AVX512(_fx32, int32_t, AVX512_CARREGA_FX32)
+
+__attribute__((target("avx512f")))
+static inline void previsao_avx512(const double *vx, long n, double A, double B, double *saida) {
+    __m512d a = _mm512_set1_pd(A), b = _mm512_set1_pd(B);
+    long i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_pd(saida + i,     _mm512_fmadd_pd(b, _mm512_loadu_pd(vx + i), a));
+        _mm512_storeu_pd(saida + i + 8, _mm512_fmadd_pd(b, _mm512_loadu_pd(vx + i + 8), a));
+    }
+    previsao_escalar(vx + i, n - i, A, B, saida + i);
+}
+
+// Ladrilho 8x8: 8 acumuladores; por linha, 1 carga, 8 broadcasts e 8 FMAs
+__attribute__((target("avx512f")))
+static inline void gram_avx512(const double *bloco, long linhas, int ld, double *G) {
+    for (int j0 = 0; j0 < ld; j0 += 8) {
+        for (int k0 = j0; k0 < ld; k0 += 8) {
+            __m512d c0 = _mm512_setzero_pd(), c1 = c0, c2 = c0, c3 = c0;
+            __m512d c4 = c0, c5 = c0, c6 = c0, c7 = c0;
+            for (long i = 0; i < linhas; i++) {
+                const double *linha = bloco + i * ld;
+                __m512d kv = _mm512_load_pd(linha + k0);
+                c0 = _mm512_fmadd_pd(_mm512_set1_pd(linha[j0]),     kv, c0);
+                c1 = _mm512_fmadd_pd(_mm512_set1_pd(linha[j0 + 1]), kv, c1);
+                c2 = _mm512_fmadd_pd(_mm512_set1_pd(linha[j0 + 2]), kv, c2);
+                c3 = _mm512_fmadd_pd(_mm512_set1_pd(linha[j0 + 3]), kv, c3);
+                c4 = _mm512_fmadd_pd(_mm512_set1_pd(linha[j0 + 4]), kv, c4);
+                c5 = _mm512_fmadd_pd(_mm512_set1_pd(linha[j0 + 5]), kv, c5);
+                c6 = _mm512_fmadd_pd(_mm512_set1_pd(linha[j0 + 6]), kv, c6);
+                c7 = _mm512_fmadd_pd(_mm512_set1_pd(linha[j0 + 7]), kv, c7);
+            }
+            double *g = G + j0 * ld + k0;
+            _mm512_store_pd(g,          _mm512_add_pd(_mm512_load_pd(g), c0));
+            _mm512_store_pd(g + ld,     _mm512_add_pd(_mm512_load_pd(g + ld), c1));
+            _mm512_store_pd(g + 2 * ld, _mm512_add_pd(_mm512_load_pd(g + 2 * ld), c2));
+            _mm512_store_pd(g + 3 * ld, _mm512_add_pd(_mm512_load_pd(g + 3 * ld), c3));
+            _mm512_store_pd(g + 4 * ld, _mm512_add_pd(_mm512_load_pd(g + 4 * ld), c4));
+            _mm512_store_pd(g + 5 * ld, _mm512_add_pd(_mm512_load_pd(g + 5 * ld), c5));
+            _mm512_store_pd(g + 6 * ld, _mm512_add_pd(_mm512_load_pd(g + 6 * ld), c6));
+            _mm512_store_pd(g + 7 * ld, _mm512_add_pd(_mm512_load_pd(g + 7 * ld), c7));
+        }
+    }
+}
+
+__attribute__((target("avx512f,popcnt")))
+static inline void inliers_avx512(const double *vx, const double *vy, long n, const double *A,
+                                  const double *B, int numRetas, double limiar, long *contagem) {
+    __m512d t = _mm512_set1_pd(limiar);
+
+    for (int c = 0; c < numRetas; c++) {
+        __m512d a = _mm512_set1_pd(A[c]), b = _mm512_set1_pd(B[c]);
+        long conta = 0;
+        long i = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m512d r0 = _mm512_fnmadd_pd(b, _mm512_loadu_pd(vx + i),     _mm512_sub_pd(_mm512_loadu_pd(vy + i), a));
+            __m512d r1 = _mm512_fnmadd_pd(b, _mm512_loadu_pd(vx + i + 8), _mm512_sub_pd(_mm512_loadu_pd(vy + i + 8), a));
+            __mmask8 m0 = _mm512_cmp_pd_mask(_mm512_abs_pd(r0), t, _CMP_LE_OQ);
+            __mmask8 m1 = _mm512_cmp_pd_mask(_mm512_abs_pd(r1), t, _CMP_LE_OQ);
+            conta += __builtin_popcount(((unsigned)m1 << 8) | m0);
+        }
+        contagem[c] += conta;
+        inliers_escalar(vx + i, vy + i, n - i, A + c, B + c, 1, limiar, contagem + c);
+    }
+}
+
+__attribute__((target("avx512f")))
+static inline void somas_inliers_avx512(const double *vx, const double *vy, long n, double A, double B,
+                                        double limiar, double cx, double somas[5]) {
+    __m512d a = _mm512_set1_pd(A), b = _mm512_set1_pd(B), c = _mm512_set1_pd(cx);
+    __m512d t = _mm512_set1_pd(limiar), um = _mm512_set1_pd(1.0);
+    __m512d sn = _mm512_setzero_pd(), sd = sn, sr = sn, sdd = sn, sdr = sn;
+    long i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m512d x = _mm512_loadu_pd(vx + i);
+        __m512d r = _mm512_fnmadd_pd(b, x, _mm512_sub_pd(_mm512_loadu_pd(vy + i), a));
+        __mmask8 m = _mm512_cmp_pd_mask(_mm512_abs_pd(r), t, _CMP_LE_OQ);
+        __m512d d = _mm512_maskz_sub_pd(m, x, c);  // Zero fora dos inliers
+        r = _mm512_maskz_mov_pd(m, r);
+        sn  = _mm512_mask_add_pd(sn, m, sn, um);
+        sd  = _mm512_add_pd(sd, d);
+        sr  = _mm512_add_pd(sr, r);
+        sdd = _mm512_fmadd_pd(d, d, sdd);
+        sdr = _mm512_fmadd_pd(d, r, sdr);
+    }
+
+    double resto[5];
+    somas_inliers_escalar(vx + i, vy + i, n - i, A, B, limiar, cx, resto);
+    somas[0] = _mm512_reduce_add_pd(sn) + resto[0];
+    somas[1] = _mm512_reduce_add_pd(sd) + resto[1];
+    somas[2] = _mm512_reduce_add_pd(sr) + resto[2];
+    somas[3] = _mm512_reduce_add_pd(sdd) + resto[3];
+    somas[4] = _mm512_reduce_add_pd(sdr) + resto[4];
+}
+
+__attribute__((target("avx512f")))
+static inline __m512i avx512_mul64(__m512i a, uint64_t c) {
+    __m512i cBaixo = _mm512_set1_epi64((long long)(c & 0xFFFFFFFFu));
+    __m512i cAlto = _mm512_set1_epi64((long long)(c >> 32));
+    __m512i cruzado = _mm512_add_epi64(_mm512_mul_epu32(_mm512_srli_epi64(a, 32), cBaixo),
+                                       _mm512_mul_epu32(a, cAlto));
+    return _mm512_add_epi64(_mm512_mul_epu32(a, cBaixo), _mm512_slli_epi64(cruzado, 32));
+}
+
+__attribute__((target("avx512f")))
+static inline __m512i avx512_mistura(__m512i z) {
+    z = avx512_mul64(_mm512_xor_si512(z, _mm512_srli_epi64(z, 30)), 0xBF58476D1CE4E5B9ULL);
+    z = avx512_mul64(_mm512_xor_si512(z, _mm512_srli_epi64(z, 27)), 0x94D049BB133111EBULL);
+    return _mm512_xor_si512(z, _mm512_srli_epi64(z, 31));
+}
+
+// 16 pesos por iteração; a comparação sem sinal dá a máscara direto
+__attribute__((target("avx512f")))
+static inline void pesos_poisson_avx512(uint64_t semente, uint64_t contador, long n, const uint32_t *limites,
+                                        int numLimites, double *w) {
+    __m512i lim[NUCLEOS_MAX_LIMITES], um = _mm512_set1_epi32(1);
+    for (int k = 0; k < numLimites; k++)
+        lim[k] = _mm512_set1_epi32((int)limites[k]);
+    uint64_t base = aleat_mistura(semente) + (contador + 1) * ALEAT_GAMA;
+    __m512i z = _mm512_set_epi64((long long)(base + 7 * ALEAT_GAMA), (long long)(base + 6 * ALEAT_GAMA),
+                                 (long long)(base + 5 * ALEAT_GAMA), (long long)(base + 4 * ALEAT_GAMA),
+                                 (long long)(base + 3 * ALEAT_GAMA), (long long)(base + 2 * ALEAT_GAMA),
+                                 (long long)(base + ALEAT_GAMA), (long long)base);
+    __m512i passo = _mm512_set1_epi64((long long)(8 * ALEAT_GAMA));
+    long i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m512i u = avx512_mistura(z);
+        z = _mm512_add_epi64(z, passo);
+        __m512i peso = _mm512_setzero_si512();
+        for (int k = 0; k < numLimites; k++)
+            peso = _mm512_mask_add_epi32(peso, _mm512_cmpge_epu32_mask(u, lim[k]), peso, um);
+        _mm512_storeu_pd(w + i, _mm512_cvtepi32_pd(_mm512_castsi512_si256(peso)));
+        _mm512_storeu_pd(w + i + 8, _mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(peso, 1)));
+    }
+    pesos_poisson_escalar(semente, contador + i / 2, n - i, limites, numLimites, w + i);
+}
+
+__attribute__((target("avx512f")))
+static inline void somas_pesadas_avx512(const double *vd, const double *ve, const double *vw, long n,
+                                        double somas[5]) {
+    __m512d s0 = _mm512_setzero_pd(), s1 = s0, s2 = s0, s3 = s0, s4 = s0;
+    __m512d t0 = s0, t1 = s0, t2 = s0, t3 = s0, t4 = s0;
+    long i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m512d w0 = _mm512_loadu_pd(vw + i), w1 = _mm512_loadu_pd(vw + i + 8);
+        __m512d d0 = _mm512_loadu_pd(vd + i), d1 = _mm512_loadu_pd(vd + i + 8);
+        __m512d e0 = _mm512_loadu_pd(ve + i), e1 = _mm512_loadu_pd(ve + i + 8);
+        __m512d wd0 = _mm512_mul_pd(w0, d0), wd1 = _mm512_mul_pd(w1, d1);
+        s0 = _mm512_add_pd(s0, w0);
+        t0 = _mm512_add_pd(t0, w1);
+        s1 = _mm512_add_pd(s1, wd0);
+        t1 = _mm512_add_pd(t1, wd1);
+        s2 = _mm512_fmadd_pd(w0, e0, s2);
+        t2 = _mm512_fmadd_pd(w1, e1, t2);
+        s3 = _mm512_fmadd_pd(wd0, d0, s3);
+        t3 = _mm512_fmadd_pd(wd1, d1, t3);
+        s4 = _mm512_fmadd_pd(wd0, e0, s4);
+        t4 = _mm512_fmadd_pd(wd1, e1, t4);
+    }
+
+    double resto[5];
+    somas_pesadas_escalar(vd + i, ve + i, vw + i, n - i, resto);
+    somas[0] = _mm512_reduce_add_pd(_mm512_add_pd(s0, t0)) + resto[0];
+    somas[1] = _mm512_reduce_add_pd(_mm512_add_pd(s1, t1)) + resto[1];
+    somas[2] = _mm512_reduce_add_pd(_mm512_add_pd(s2, t2)) + resto[2];
+    somas[3] = _mm512_reduce_add_pd(_mm512_add_pd(s3, t3)) + resto[3];
+    somas[4] = _mm512_reduce_add_pd(_mm512_add_pd(s4, t4)) + resto[4];
+}
+#endif
+
+// ==================== SELEÇÃO EM TEMPO DE EXECUÇÃO ====================
+static NucleoSomas nucleo_somas = somas_escalar_f64;
+static NucleoSomasF32 nucleo_somas_f32 = somas_escalar_f32;
+static NucleoSomasFx32 nucleo_somas_fx32 = somas_escalar_fx32;
+static NucleoErro nucleo_erro = erro_escalar_f64;
+static NucleoErroF32 nucleo_erro_f32 = erro_escalar_f32;
+static NucleoErroFx32 nucleo_erro_fx32 = erro_escalar_fx32;
+static NucleoSomasEstendidas nucleo_somas_estendidas = somas_estendidas_escalar_f64;
+static NucleoSomasEstendidasF32 nucleo_somas_estendidas_f32 = somas_estendidas_escalar_f32;
+static NucleoSomasEstendidasFx32 nucleo_somas_estendidas_fx32 = somas_estendidas_escalar_fx32;
+static NucleoPrevisao nucleo_previsao = previsao_escalar;
+static NucleoGram nucleo_gram = gram_escalar;
+static NucleoInliers nucleo_inliers = inliers_escalar;
+static NucleoSomasInliers nucleo_somas_inliers = somas_inliers_escalar;
+static NucleoPesosPoisson nucleo_pesos_poisson = pesos_poisson_escalar;
+static NucleoSomasPesadas nucleo_somas_pesadas = somas_pesadas_escalar;
+static const char *nucleo_nome = "escalar";
+
+// Escolhe a melhor versão suportada pela CPU (ou a pedida em REGRESSAO_SIMD)
+static inline void nucleos_seleciona(void) {
+    const char *pedido = getenv("REGRESSAO_SIMD");
+
+    nucleo_somas = somas_escalar_f64;
+    nucleo_somas_f32 = somas_escalar_f32;
+    nucleo_somas_fx32 = somas_escalar_fx32;
+    nucleo_erro = erro_escalar_f64;
+    nucleo_erro_f32 = erro_escalar_f32;
+    nucleo_erro_fx32 = erro_escalar_fx32;
+    nucleo_somas_estendidas = somas_estendidas_escalar_f64;  // Só escalar (ver NUCLEOS_ESCALAR)
+    nucleo_somas_estendidas_f32 = somas_estendidas_escalar_f32;
+    nucleo_somas_estendidas_fx32 = somas_estendidas_escalar_fx32;
+    nucleo_previsao = previsao_escalar;
+    nucleo_gram = gram_escalar;
+    nucleo_inliers = inliers_escalar;
+    nucleo_somas_inliers = somas_inliers_escalar;
+    nucleo_pesos_poisson = pesos_poisson_escalar;
+    nucleo_somas_pesadas = somas_pesadas_escalar;
+    nucleo_nome = "escalar";
+    if (pedido && strcmp(pedido, "escalar") == 0)
+        return;
+
+#ifdef NUCLEOS_X86
+    __builtin_cpu_init();
+    int temAvx512 = __builtin_cpu_supports("avx512f");
+    int temAvx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+
+    if (temAvx512 && (!pedido || strcmp(pedido, "avx512") == 0)) {
+        nucleo_somas = somas_avx512_f64;
+        nucleo_somas_f32 = somas_avx512_f32;
+        nucleo_somas_fx32 = somas_avx512_fx32;
+        nucleo_erro = erro_avx512_f64;
+        nucleo_erro_f32 = erro_avx512_f32;
+        nucleo_erro_fx32 = erro_avx512_fx32;
+        nucleo_previsao = previsao_avx512;
+        nucleo_gram = gram_avx512;
+        nucleo_inliers = inliers_avx512;
+        nucleo_somas_inliers = somas_inliers_avx512;
+        nucleo_pesos_poisson = pesos_poisson_avx512;
+        nucleo_somas_pesadas = somas_pesadas_avx512;
+        nucleo_nome = "avx512";
+    } else if (temAvx2 && (!pedido || strcmp(pedido, "avx2") == 0 || strcmp(pedido, "avx512") == 0)) {
+        nucleo_somas = somas_avx2_f64;
+        nucleo_somas_f32 = somas_avx2_f32;
+        nucleo_somas_fx32 = somas_avx2_fx32;
+        nucleo_erro = erro_avx2_f64;
+        nucleo_erro_f32 = erro_avx2_f32;
+        nucleo_erro_fx32 = erro_avx2_fx32;
+        nucleo_previsao = previsao_avx2;
+        nucleo_gram = gram_avx2;
+        nucleo_inliers = inliers_avx2;
+        nucleo_somas_inliers = somas_inliers_avx2;
+        nucleo_pesos_poisson = pesos_poisson_avx2;
+        nucleo_somas_pesadas = somas_pesadas_avx2;
+        nucleo_nome = "avx2";
+    }
+#endif
+}
+
+#endif
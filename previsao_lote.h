@@ -0,0 +1,433 @@
+/* File:     previsao_lote.h
+ *
+ * Purpose:  Previsão em lote: lê valores de x (um por linha, de um arquivo
+ *           ou da entrada padrão), calcula y = A + B*x e grava os resultados,
+ *           sem passar por scanf/printf a cada valor.
+ *
+ *           A entrada é lida em rodadas de até (numThreads+1) * PREV_BLOCO_ENTRADA
+ *           bytes, divididas em partes que terminam em '\n'. Em cada rodada o
+ *           pool de threads converte as linhas (leitor_converte_decimal),
+ *           aplica o nucleo_previsao (SIMD) e formata a saída da sua parte.
+ *           Uma thread escritora grava as partes em ordem com writev enquanto
+ *           o pool já processa a rodada seguinte (dois conjuntos de buffers);
+ *           se ela não puder ser criada, a chamadora grava cada rodada.
+ *           A saída de cada parte fica numa ArenaMemoria (memoria_colunas.h)
+ *           reservada para o pior caso da rodada: o tamanho real depende do
+ *           texto e a arena cresce sem copiar o que já foi formatado.
+ *
+ *           Formatos de saída:
+ *             csv: cabeçalho "x,y" e uma linha "x,y" por valor, com 6 casas
+ *                  (mesmo texto do printf("%.6f"), via formata_fixo6);
+ *             bin: só os y, em double (8 bytes, ordem da máquina), na mesma
+ *                  ordem da entrada.
+ *           Linhas que não começam por um número (cabeçalho, vazias) são
+ *           ignoradas; em linhas "x,y" só o primeiro campo é usado.
+ *
+ *           prever_valores é o modo interativo, comum a todos os programas:
+ *           lê um x por vez do teclado até 'q' ou 'sair'.
+ *
+ * Exemplo:
+ *    ResumoLote resumo;
+ *    if (prever_lote(&pool, "xs.txt", "ys.csv", PREV_FORMATO_CSV, A, B, &resumo) == 0)
+ *        printf("%ld valores\n", resumo.valores);
+ */
+#ifndef _PREVISAO_LOTE_H_
+#define _PREVISAO_LOTE_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include "timer.h"
+#include "leitor_csv.h"
+#include "pool_threads.h"
+#include "nucleos_simd.h"
+#include "soma_compensada.h"
+#include "formata_fixo6.h"
+#include "memoria_colunas.h"
+
+#define PREV_BLOCO_ENTRADA (256 * 1024)  // Bytes de entrada de cada parte por rodada
+#define PREV_MAX_TEXTO     FIXO6_MAX_TEXTO
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024  // limits.h só define com _GNU_SOURCE/_XOPEN_SOURCE
+#endif
+
+#define PREV_FORMATO_CSV 0
+#define PREV_FORMATO_BIN 1
+
+// Estatísticas de uma execução de prever_lote
+typedef struct {
+    long valores;          // Valores previstos
+    long bytesEntrada;
+    long bytesSaida;
+    double tempo;          // Segundos, da abertura ao último write
+} ResumoLote;
+
+// Uma parte de uma rodada (entrada em [inicio, fim), saída em texto ou doubles)
+typedef struct {
+    const char *inicio, *fim;
+    double A, B;
+    int formato;
+    double *x, *y;         // Lote atual (LEITOR_LOTE valores)
+    ArenaMemoria arena;    // Onde fica a saída
+    char *saida;           // Texto formatado (csv) ou os y em double (bin); = arena.base
+    size_t tamSaida;
+    long n;
+    int erro;
+} ParteLote;
+
+// ==================== PROCESSAMENTO DE UMA PARTE ====================
+// Garante espaço para mais bytes na saída da parte
+static inline int prev_reserva(ParteLote *parte, size_t bytes) {
+    return arena_garante(&parte->arena, parte->tamSaida + bytes);
+}
+
+// Prevê e formata a parte em lotes de até LEITOR_LOTE valores
+static inline void *prever_parte(void *arg) {
+    ParteLote *parte = (ParteLote *)arg;
+    const char *p = parte->inicio;
+
+    parte->tamSaida = 0;
+    parte->n = 0;
+    while (p < parte->fim && !parte->erro) {
+        // Converte o primeiro campo de cada linha
+        long n = 0;
+        while (p < parte->fim && n < LEITOR_LOTE) {
+            const char *nl = memchr(p, '\n', parte->fim - p);
+            if (!nl)
+                nl = parte->fim;
+            if (leitor_converte_decimal(p, nl, &parte->x[n]))
+                n++;
+            p = nl + 1;
+        }
+        nucleo_previsao(parte->x, n, parte->A, parte->B, parte->y);
+        parte->n += n;
+
+        if (parte->formato == PREV_FORMATO_BIN) {
+            if (prev_reserva(parte, n * sizeof(double)) != 0) {
+                parte->erro = 1;
+                break;
+            }
+            memcpy(parte->saida + parte->tamSaida, parte->y, n * sizeof(double));
+            parte->tamSaida += n * sizeof(double);
+            continue;
+        }
+
+        // CSV: reserva o pior caso do lote e formata "x,y\n"
+        if (prev_reserva(parte, n * (2 * PREV_MAX_TEXTO + 2)) != 0) {
+            parte->erro = 1;
+            break;
+        }
+        char *s = parte->saida + parte->tamSaida;
+        for (long i = 0; i < n; i++) {
+            s += formata_fixo6(parte->x[i], s);
+            *s++ = ',';
+            s += formata_fixo6(parte->y[i], s);
+            *s++ = '\n';
+        }
+        parte->tamSaida = s - parte->saida;
+    }
+    return NULL;
+}
+
+// ==================== THREAD ESCRITORA ====================
+typedef struct {
+    int fd;
+    ParteLote *partes;       // Rodada a gravar (NULL = nenhuma)
+    int numPartes;
+    int encerrar;
+    int erro;
+    long bytes;
+    pthread_mutex_t trava;
+    pthread_cond_t sinal;
+} EscritorLote;
+
+// Grava todos os iov em ordem, repetindo em escritas parciais
+static inline int prev_grava_iov(int fd, struct iovec *iov, int quantos) {
+    while (quantos > 0) {
+        int lote = (quantos < IOV_MAX) ? quantos : IOV_MAX;
+        ssize_t escritos = writev(fd, iov, lote);
+        if (escritos < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        while (quantos > 0 && (size_t)escritos >= iov->iov_len) {
+            escritos -= iov->iov_len;
+            iov++;
+            quantos--;
+        }
+        if (quantos > 0) {
+            iov->iov_base = (char *)iov->iov_base + escritos;
+            iov->iov_len -= escritos;
+        }
+    }
+    return 0;
+}
+
+// Grava em ordem a saída das partes de uma rodada. Retorna os bytes ou -1 em erro
+static inline long prev_grava_partes(const EscritorLote *E, const ParteLote *partes) {
+    struct iovec iov[E->numPartes];
+    int quantos = 0;
+    long bytes = 0;
+    for (int t = 0; t < E->numPartes; t++) {
+        if (partes[t].tamSaida == 0)
+            continue;
+        iov[quantos].iov_base = partes[t].saida;
+        iov[quantos].iov_len = partes[t].tamSaida;
+        bytes += partes[t].tamSaida;
+        quantos++;
+    }
+    return (prev_grava_iov(E->fd, iov, quantos) != 0) ? -1 : bytes;
+}
+
+static inline void *prev_thread_escritora(void *arg) {
+    EscritorLote *E = (EscritorLote *)arg;
+
+    pthread_mutex_lock(&E->trava);
+    while (1) {
+        while (!E->partes && !E->encerrar)
+            pthread_cond_wait(&E->sinal, &E->trava);
+        if (!E->partes)
+            break;  // Encerrar e nada pendente
+        ParteLote *partes = E->partes;
+        pthread_mutex_unlock(&E->trava);
+
+        long bytes = prev_grava_partes(E, partes);
+
+        pthread_mutex_lock(&E->trava);
+        E->erro |= (bytes < 0);
+        if (bytes > 0)
+            E->bytes += bytes;
+        E->partes = NULL;
+        pthread_cond_broadcast(&E->sinal);
+    }
+    pthread_mutex_unlock(&E->trava);
+    return NULL;
+}
+
+// Espera a thread escritora terminar a rodada anterior
+static inline void prev_espera_escritora(EscritorLote *E) {
+    pthread_mutex_lock(&E->trava);
+    while (E->partes)
+        pthread_cond_wait(&E->sinal, &E->trava);
+    pthread_mutex_unlock(&E->trava);
+}
+
+// ==================== PREVISÃO EM LOTE ====================
+// entrada/saida: nome do arquivo ou "-" (stdin/stdout).
+// Retorna 0 em sucesso ou -1 em erro (já informado em stderr)
+static inline int prever_lote(PoolThreads *pool, const char *entrada, const char *saida,
+                              int formato, double A, double B, ResumoLote *resumo) {
+    int T = pool->numThreads;
+    size_t capEntrada = (size_t)(T + 1) * PREV_BLOCO_ENTRADA;
+    double inicio, fim;
+
+    GET_TIME(inicio);
+    int fdEntrada = strcmp(entrada, "-") == 0 ? STDIN_FILENO : open(entrada, O_RDONLY);
+    if (fdEntrada < 0) {
+        perror("Erro ao abrir a entrada da previsao");
+        return -1;
+    }
+    int fdSaida = strcmp(saida, "-") == 0 ? STDOUT_FILENO
+                                          : open(saida, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fdSaida < 0) {
+        perror("Erro ao criar a saida da previsao");
+        if (fdEntrada != STDIN_FILENO) close(fdEntrada);
+        return -1;
+    }
+    if (fdEntrada != STDIN_FILENO)
+        posix_fadvise(fdEntrada, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    // Buffer de entrada (o começo pode ter a linha incompleta da rodada anterior)
+    // e dois conjuntos de partes: o pool preenche um enquanto o outro é gravado
+    char *buf = malloc(capEntrada);
+    ParteLote *conjuntos = calloc(2 * T, sizeof(ParteLote));
+    int erro = (!buf || !conjuntos);
+    // Pior caso da saída de uma parte: todas as linhas da rodada com 1 dígito ("d\n")
+    size_t maxSaida = (capEntrada / 2 + 1) * (2 * PREV_MAX_TEXTO + 2);
+    for (int i = 0; !erro && i < 2 * T; i++) {
+        if (arena_reserva(&conjuntos[i].arena, maxSaida) != 0)
+            erro = 1;
+        conjuntos[i].saida = conjuntos[i].arena.base;
+        conjuntos[i].A = A;
+        conjuntos[i].B = B;
+        conjuntos[i].formato = formato;
+        conjuntos[i].x = malloc(2 * LEITOR_LOTE * sizeof(double));
+        conjuntos[i].y = conjuntos[i].x + LEITOR_LOTE;
+        if (!conjuntos[i].x)
+            erro = 1;
+    }
+    if (erro) {
+        fprintf(stderr, "Erro ao alocar buffers da previsao\n");
+        for (int i = 0; conjuntos && i < 2 * T; i++) {
+            free(conjuntos[i].x);
+            arena_libera(&conjuntos[i].arena);
+        }
+        free(conjuntos); free(buf);
+        if (fdEntrada != STDIN_FILENO) close(fdEntrada);
+        if (fdSaida != STDOUT_FILENO) close(fdSaida);
+        return -1;
+    }
+
+    EscritorLote E = {.fd = fdSaida, .partes = NULL, .numPartes = T};
+    pthread_t escritora;
+    pthread_mutex_init(&E.trava, NULL);
+    pthread_cond_init(&E.sinal, NULL);
+    // Sem a escritora (pthread_create recusado) cada rodada é gravada aqui,
+    // depois do pool, sem sobrepor escrita e cálculo
+    int comEscritora = pthread_create(&escritora, NULL, prev_thread_escritora, &E) == 0;
+    if (!comEscritora)
+        fprintf(stderr, "Aviso: thread escritora nao criada; a saida e gravada entre as rodadas\n");
+
+    if (formato == PREV_FORMATO_CSV)
+        E.erro |= prev_grava_iov(fdSaida, &(struct iovec){"x,y\n", 4}, 1) != 0;
+
+    long valores = 0, bytesEntrada = 0;
+    size_t resto = 0;  // Linha incompleta guardada no começo de buf
+    int fimEntrada = 0;
+    for (long rodada = 0; !fimEntrada && !erro; rodada++) {
+        // Lê até encher o buffer (pipes entregam pouco por read)
+        size_t tam = resto;
+        while (tam < capEntrada) {
+            ssize_t lidos = read(fdEntrada, buf + tam, capEntrada - tam);
+            if (lidos < 0 && errno == EINTR)
+                continue;
+            if (lidos < 0) {
+                perror("Erro ao ler a entrada da previsao");
+                erro = 1;
+            }
+            if (lidos <= 0) {
+                fimEntrada = 1;
+                break;
+            }
+            tam += lidos;
+        }
+        if (erro)
+            break;
+        bytesEntrada += tam - resto;
+
+        // Só linhas completas entram na rodada (a última da entrada pode não ter '\n')
+        size_t util = tam;
+        if (!fimEntrada) {
+            while (util > 0 && buf[util - 1] != '\n')
+                util--;
+            if (util == 0)
+                util = tam;  // Linha maior que o buffer: vira uma linha inválida
+        }
+
+        // Divide [0, util) em T partes alinhadas em '\n'
+        ParteLote *partes = conjuntos + (rodada % 2) * T;
+        const char *pos = buf;
+        for (int t = 0; t < T; t++) {
+            const char *alvo = buf + (size_t)((double)util * (t + 1) / T);
+            const char *fimParte = buf + util;
+            if (t < T - 1 && alvo > pos) {
+                const char *nl = memchr(alvo - 1, '\n', buf + util - (alvo - 1));
+                fimParte = nl ? nl + 1 : buf + util;
+            } else if (t < T - 1) {
+                fimParte = pos;
+            }
+            partes[t].inicio = pos;
+            partes[t].fim = fimParte;
+            pos = fimParte;
+        }
+
+        pool_executa(pool, util / 8, prever_parte, partes, sizeof(ParteLote));
+
+        // A rodada anterior precisa estar gravada antes de entregar esta
+        if (comEscritora)
+            prev_espera_escritora(&E);
+        for (int t = 0; t < T; t++) {
+            erro |= partes[t].erro;
+            valores += partes[t].n;
+        }
+        if (comEscritora) {
+            pthread_mutex_lock(&E.trava);
+            E.partes = partes;
+            pthread_cond_signal(&E.sinal);
+            pthread_mutex_unlock(&E.trava);
+        } else {
+            long bytes = prev_grava_partes(&E, partes);
+            E.erro |= (bytes < 0);
+            if (bytes > 0)
+                E.bytes += bytes;
+        }
+
+        // A entrada já foi convertida: guarda a linha incompleta para a próxima rodada
+        resto = tam - util;
+        memmove(buf, buf + util, resto);
+    }
+
+    if (comEscritora) {
+        prev_espera_escritora(&E);
+        pthread_mutex_lock(&E.trava);
+        E.encerrar = 1;
+        pthread_cond_signal(&E.sinal);
+        pthread_mutex_unlock(&E.trava);
+        pthread_join(escritora, NULL);
+    }
+    pthread_mutex_destroy(&E.trava);
+    pthread_cond_destroy(&E.sinal);
+    if (E.erro) {
+        perror("Erro ao gravar a saida da previsao");
+        erro = 1;
+    }
+    GET_TIME(fim);
+
+    for (int i = 0; i < 2 * T; i++) {
+        free(conjuntos[i].x);
+        arena_libera(&conjuntos[i].arena);
+    }
+    free(conjuntos);
+    free(buf);
+    if (fdEntrada != STDIN_FILENO) close(fdEntrada);
+    if (fdSaida != STDOUT_FILENO && close(fdSaida) != 0)
+        erro = 1;
+
+    resumo->valores = valores;
+    resumo->bytesEntrada = bytesEntrada;
+    resumo->bytesSaida = E.bytes + (formato == PREV_FORMATO_CSV ? 4 : 0);
+    resumo->tempo = fim - inicio;
+    return erro ? -1 : 0;
+}
+
+// ==================== FUNÇÃO DE PREVISÃO INTERATIVA ====================
+static inline void prever_valores(double A, double B) {
+    char entrada[64];  // Buffer para entrada do usuário
+    double x;          // Valor de X para previsão
+
+    printf("\n=== MODO DE PREVISAO ===\n");
+    printf("Digite um valor de X para prever Y (ou 'q' para sair)\n");
+
+    // Loop infinito até o usuário digitar 'q' ou 'sair'
+    while (1) {
+        printf("X = ");
+        if (scanf("%s", entrada) != 1)  // Lê entrada como string
+            break;
+
+        // Verifica se usuário quer sair
+        if (strcmp(entrada, "q") == 0 || strcmp(entrada, "sair") == 0)
+            break;
+
+        // Tenta converter a entrada para número
+        if (sscanf(entrada, "%lf", &x) == 1) {
+            // Calcula Y previsto usando a equação da regressão linear: y = A + B*x
+            double y_prev = A + B * x;
+            printf("-> Y previsto = %.6f\n", y_prev);
+        } else {
+            printf("Entrada invalida. Digite um numero ou 'q' para sair.\n");
+        }
+    }
+
+    printf("Saindo do modo de previsao.\n");
+}
+
+#endif
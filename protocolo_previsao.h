@@ -0,0 +1,81 @@
+/* File:     protocolo_previsao.h
+ *
+ * Purpose:  Protocolo entre o servidor de previsão (servidor_previsao.c) e
+ *           o cliente (cliente_previsao.c), sobre um socket Unix (stream).
+ *
+ *           Requisição: CabecalhoPrevisao{n, status = 0} seguido de n doubles (x)
+ *           Resposta:   CabecalhoPrevisao{n, status}    seguido de n doubles (y)
+ *
+ *           Um cliente pode mandar várias requisições seguidas; as respostas
+ *           chegam na mesma ordem. n vai de 1 a PROTO_MAX_LOTE; fora disso o
+ *           servidor responde com status PROTO_ERRO_TAMANHO e n = 0 e fecha
+ *           a conexão. Tudo na ordem de bytes nativa (só uso local).
+ */
+#ifndef _PROTOCOLO_PREVISAO_H_
+#define _PROTOCOLO_PREVISAO_H_
+
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PROTO_MAX_LOTE      65536  // Valores por requisição
+#define PROTO_OK            0
+#define PROTO_ERRO_TAMANHO  1
+
+typedef struct {
+    uint32_t n;       // Número de doubles que seguem
+    uint32_t status;  // PROTO_OK ou código de erro (só na resposta)
+} CabecalhoPrevisao;
+
+// Relógio monotônico em nanossegundos (latências de microssegundos)
+static inline uint64_t proto_agora_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Leitura/escrita completas em socket bloqueante. Retornam 0 ou -1
+static inline int proto_le_tudo(int fd, void *buf, size_t tam) {
+    char *p = (char *)buf;
+    while (tam > 0) {
+        ssize_t r = read(fd, p, tam);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0)
+            return -1;
+        p += r;
+        tam -= r;
+    }
+    return 0;
+}
+
+static inline int proto_escreve_tudo(int fd, const void *buf, size_t tam) {
+    const char *p = (const char *)buf;
+    while (tam > 0) {
+        ssize_t w = write(fd, p, tam);
+        if (w < 0 && errno == EINTR)
+            continue;
+        if (w <= 0)
+            return -1;
+        p += w;
+        tam -= w;
+    }
+    return 0;
+}
+
+// Compara dois uint64_t (qsort das latências)
+static inline int proto_compara_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Percentil q (0..1) de um vetor já ordenado
+static inline uint64_t proto_percentil(const uint64_t *ordenado, long n, double q) {
+    if (n <= 0)
+        return 0;
+    long i = (long)(q * (n - 1) + 0.5);
+    return ordenado[i];
+}
+
+#endif
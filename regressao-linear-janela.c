@@ -0,0 +1,200 @@
+/* File:     regressao-linear-janela.c
+ *
+ * Purpose:  Regressão contínua sobre um fluxo de pontos "x,y" (pipe, arquivo
+ *           ou arquivo que ainda está crescendo), para acompanhar mudanças
+ *           na reta ao longo do tempo.
+ *
+ *           --janela W:      ajuste dos últimos W pontos
+ *           --meia-vida H:   ajuste com peso exponencial (o peso de um ponto
+ *                            cai pela metade a cada H pontos)
+ *
+ *           A cada --cada K pontos mostra em stdout uma linha CSV com o
+ *           número de pontos lidos, A, B, MSE e a taxa de leitura desde a
+ *           linha anterior. A memória é fixa: o buffer de leitura e, na
+ *           janela, 2·W doubles (ver janela_regressao.h).
+ *
+ *           --seguir: ao chegar no fim do arquivo espera novos dados (como
+ *           tail -f) até receber SIGINT/SIGTERM. Linhas que não são "x,y"
+ *           (o cabeçalho, por exemplo) são ignoradas.
+ *
+ * Compile:  gcc -O2 -o regressao-linear-janela regressao-linear-janela.c -lpthread -lm
+ * Usage:    ./regressao-linear-janela <arquivo.csv|-> (--janela <W> | --meia-vida <H>)
+ *                                     [--cada <K>] [--seguir]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include "timer.h"
+#include "leitor_csv.h"
+#include "janela_regressao.h"
+
+#define JANELA_ESPERA_US 100000  // Pausa entre tentativas de leitura com --seguir
+
+static volatile sig_atomic_t interrompido = 0;
+
+static void trata_sinal(int sinal) {
+    (void)sinal;
+    interrompido = 1;
+}
+
+// ==================== PROGRAMA PRINCIPAL ====================
+int main(int argc, char *argv[]) {
+    double inicio, agora, ultimaSaida;
+    long W = 0, cada = 0;
+    double meiaVida = 0;
+    int seguir = 0;
+
+    if (argc < 3) {
+        printf("Uso: %s <arquivo.csv|-> (--janela <W> | --meia-vida <H>) [--cada <K>] [--seguir]\n",
+               argv[0]);
+        return 1;
+    }
+
+    char *nomeArquivo = argv[1];
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--janela") == 0 && i + 1 < argc) {
+            W = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--meia-vida") == 0 && i + 1 < argc) {
+            meiaVida = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--cada") == 0 && i + 1 < argc) {
+            cada = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--seguir") == 0) {
+            seguir = 1;
+        } else {
+            fprintf(stderr, "Opcao desconhecida: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if ((W > 0) == (meiaVida > 0)) {
+        fprintf(stderr, "Erro: use --janela <W> ou --meia-vida <H> (valores positivos)\n");
+        return 1;
+    }
+    if (cada <= 0)
+        cada = (W > 0) ? W : (long)meiaVida;
+    if (cada <= 0)
+        cada = 1;
+
+    int fd = (strcmp(nomeArquivo, "-") == 0) ? STDIN_FILENO : open(nomeArquivo, O_RDONLY);
+    if (fd < 0) {
+        perror("Erro ao abrir o arquivo");
+        return 1;
+    }
+
+    JanelaRegressao janela;
+    if (W > 0) {
+        if (janela_inicializa(&janela, W) != 0) {
+            fprintf(stderr, "Erro ao alocar memória para a janela\n");
+            return 1;
+        }
+    } else {
+        janela_inicializa_ewma(&janela, meiaVida);
+    }
+
+    char *buffer = malloc(LEITOR_BLOCO_FLUXO);
+    if (!buffer) {
+        fprintf(stderr, "Erro ao alocar memória\n");
+        return 1;
+    }
+
+    // Sem SA_RESTART: o sinal interrompe o read/usleep e o laço termina
+    struct sigaction acao = {0};
+    acao.sa_handler = trata_sinal;
+    sigaction(SIGINT, &acao, NULL);
+    sigaction(SIGTERM, &acao, NULL);
+
+    printf("pontos,A,B,MSE,pontos_por_s\n");
+
+    long pontos = 0, pontosUltimaSaida = 0;
+    size_t pendente = 0;  // Bytes de uma linha incompleta no início do buffer
+    int erro = 0;
+    GET_TIME(inicio);
+    ultimaSaida = inicio;
+
+    // ==================== LAÇO DE LEITURA ====================
+    while (!interrompido) {
+        ssize_t lidos = read(fd, buffer + pendente, LEITOR_BLOCO_FLUXO - pendente);
+        if (lidos < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("Erro ao ler os dados");
+            erro = 1;
+            break;
+        }
+        if (lidos == 0) {
+            if (!seguir)
+                break;
+            fflush(stdout);
+            usleep(JANELA_ESPERA_US);
+            continue;
+        }
+
+        char *p = buffer, *fim = buffer + pendente + lidos;
+        char *nl;
+        while ((nl = memchr(p, '\n', fim - p)) != NULL) {
+            double x, y;
+            if (leitor_converte_linha_rapida(p, nl, &x, &y)) {
+                janela_adiciona(&janela, x, y);
+                if (++pontos % cada == 0) {
+                    double A, B, MSE;
+                    janela_resultado(&janela, &A, &B, &MSE);
+                    GET_TIME(agora);
+                    double taxa = (agora > ultimaSaida)
+                                  ? (pontos - pontosUltimaSaida) / (agora - ultimaSaida) : 0.0;
+                    printf("%ld,%.6f,%.6f,%.6f,%.0f\n", pontos, A, B, MSE, taxa);
+                    ultimaSaida = agora;
+                    pontosUltimaSaida = pontos;
+                }
+            }
+            p = nl + 1;
+        }
+
+        // Guarda a linha incompleta para a próxima leitura
+        pendente = fim - p;
+        if (pendente == LEITOR_BLOCO_FLUXO) {
+            fprintf(stderr, "Erro: linha maior que %d bytes\n", LEITOR_BLOCO_FLUXO);
+            erro = 1;
+            break;
+        }
+        memmove(buffer, p, pendente);
+    }
+
+    // Última linha sem '\n' no fim do arquivo
+    double x, y;
+    if (!erro && pendente > 0 && leitor_converte_linha_rapida(buffer, buffer + pendente, &x, &y)) {
+        janela_adiciona(&janela, x, y);
+        pontos++;
+    }
+    GET_TIME(agora);
+
+    if (pontos != pontosUltimaSaida) {
+        double A, B, MSE;
+        janela_resultado(&janela, &A, &B, &MSE);
+        double taxa = (agora > ultimaSaida) ? (pontos - pontosUltimaSaida) / (agora - ultimaSaida) : 0.0;
+        printf("%ld,%.6f,%.6f,%.6f,%.0f\n", pontos, A, B, MSE, taxa);
+    }
+    fflush(stdout);
+
+    // ==================== RESUMO (stderr, para não misturar com o CSV) ====================
+    size_t memoria = LEITOR_BLOCO_FLUXO + (W > 0 ? 2 * W * sizeof(double) : 0);
+    fprintf(stderr, "\n=== FLUXO ===\n");
+    if (W > 0)
+        fprintf(stderr, "Janela: %ld pontos\n", W);
+    else
+        fprintf(stderr, "Meia-vida: %.0f pontos (lambda = %.9f)\n", meiaVida, janela.lambda);
+    fprintf(stderr, "Pontos lidos: %ld\n", pontos);
+    fprintf(stderr, "Tempo: %f segundos\n", agora - inicio);
+    fprintf(stderr, "Taxa media: %.2f milhoes de pontos/s\n",
+            (agora > inicio) ? pontos / (agora - inicio) / 1e6 : 0.0);
+    fprintf(stderr, "Memoria: %.2f MB (fixa)\n", memoria / (1024.0 * 1024.0));
+
+    if (fd != STDIN_FILENO)
+        close(fd);
+    free(buffer);
+    janela_libera(&janela);
+    return erro;
+}
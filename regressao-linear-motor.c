@@ -0,0 +1,236 @@
+/* File:     regressao-linear-motor.c
+ *
+ * Purpose:  Programa da regressão linear simples sobre o motor especializado
+ *           em tempo de compilação (ver motor_regressao.h). O mesmo fonte gera
+ *           as versões sequencial e paralela, com ou sem MSE, em double,
+ *           float ou ponto fixo, escolhidas pelas opções -D do compilador:
+ *
+ *             regressao-linear             paralelo, somas
+ *             regressao-linear-sequencial  sequencial, somas
+ *             regressao-linear-sequencial-mse  sequencial, somas + SSE
+ *             motor-<seq|par>-<somas|sse|estendido>-<f64|f32|fx32>  todas as combinações
+ *
+ *           A leitura é a mesma de regressao-linear-mse (leitor_csv.h, ou o
+ *           formato binário mapeado). Nos tipos reduzidos (f32, fx32) um
+ *           binário gravado no mesmo tipo (conversor_binario --tipo) é usado
+ *           direto do mapeamento; os demais dados são convertidos no lugar
+ *           depois de carregados (tempo contado na leitura): a coluna
+ *           reduzida ocupa a primeira metade da coluna de doubles e a outra
+ *           metade é devolvida ao sistema, sem uma cópia ao lado.
+ *
+ *           --precisao calcula também a regressão sobre os doubles originais
+ *           e compara (relatorio_precisao.h); precisa de CSV ou binário f64.
+ *
+ * Compile:  make (ver Makefile), ou por exemplo
+ *           gcc -O3 -march=native -DMOTOR_PARALELO=1 -DMOTOR_ACUMULADOR=MOTOR_SSE \
+ *               -o regressao-linear-motor regressao-linear-motor.c -lpthread -lm
+ * Usage:    ./regressao-linear <arquivo.csv|arquivo.bin> <num_threads> [--mmap] [--precisao]
+ *           ./regressao-linear-sequencial <arquivo.csv|arquivo.bin> [--mmap] [--precisao]
+ *           ./motor-par-sse-fx32 dados.csv 4 --precisao
+ */
+#define _GNU_SOURCE  // sched_getaffinity e CPU_SET (pool_threads.h, via previsao_lote.h)
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "timer.h"
+#include "leitor_csv.h"
+#include "formato_binario.h"
+#include "motor_regressao.h"
+#include "previsao_lote.h"
+#include "relatorio_precisao.h"
+
+// Libera os doubles carregados: mapeados do binário f64 ou de colunas_aloca
+static void libera_doubles(double *X, long N, int mapeados) {
+    if (mapeados)
+        libera_binario(X, N);
+    else
+        colunas_libera(X);
+}
+
+// =========================== FUNÇÃO PRINCIPAL ===========================
+int main(int argc, char *argv[]) {
+    double inicio_total, fim_total, fim_leitura;
+    int numThreads = 1;
+    int primeiraOpcao = MOTOR_PARALELO ? 3 : 2;
+
+    if (argc < primeiraOpcao) {
+        if (MOTOR_PARALELO)
+            printf("Uso: %s <arquivo.csv> <num_threads> [--mmap] [--precisao]\n", argv[0]);
+        else
+            printf("Uso: %s <arquivo.csv> [--mmap] [--precisao]\n", argv[0]);
+        return 1;
+    }
+
+    char *nomeArquivo = argv[1];
+    if (MOTOR_PARALELO)
+        numThreads = atoi(argv[2]);
+    if (numThreads < 1)
+        numThreads = 1;
+
+    int usaMmap = 0;  // --mmap: converte direto do arquivo mapeado, sem strtod
+    int relatorioPrecisao = 0;  // --precisao: compara com o caminho em double
+    for (int i = primeiraOpcao; i < argc; i++) {
+        if (strcmp(argv[i], "--mmap") == 0) {
+            usaMmap = 1;
+        } else if (strcmp(argv[i], "--precisao") == 0) {
+            relatorioPrecisao = 1;
+        } else {
+            fprintf(stderr, "Opcao desconhecida: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    GET_TIME(inicio_total);
+
+    // ==================== LEITURA ====================
+    double *X = NULL, *Y = NULL;      // Doubles (CSV, binário f64 ou decodificados)
+    void *colX = NULL, *colY = NULL;  // Colunas do binário mapeado, no tipo gravado
+    CabecalhoBinario cab;
+    memset(&cab, 0, sizeof(cab));
+    long N;
+    int usaBinario = eh_arquivo_binario(nomeArquivo);
+    if (usaBinario)
+        N = carrega_binario_colunas(nomeArquivo, &colX, &colY, &cab);
+    else if (usaMmap)
+        N = carrega_csv_mmap(nomeArquivo, numThreads, &X, &Y);
+    else
+        N = carrega_csv_paralelo(nomeArquivo, numThreads, &X, &Y);
+    if (N < 0)
+        return 1;
+    if (!usaBinario)
+        binario_monta_cabecalho(&cab, X, Y, N);  // Faixas para o ponto fixo
+
+    double centroX, passoX, centroY, passoY;
+    binario_fixo_escala(cab.minX, cab.maxX, &centroX, &passoX);
+    binario_fixo_escala(cab.minY, cab.maxY, &centroY, &passoY);
+
+    const MotorValor *vx, *vy;
+    int mapeados = 0;                           // X/Y apontam para o binário mapeado
+    int temOriginais = !usaBinario || cab.tipo == BINARIO_FLOAT64;
+    double erroX = 0, erroY = 0, tempoReferencia = 0;
+    ReferenciaPrecisao ref = {0};
+
+    if (usaBinario && cab.tipo == BINARIO_FLOAT64) {
+        X = colX;
+        Y = colY;
+        mapeados = 1;
+    } else if (usaBinario && cab.tipo != MOTOR_TIPO) {
+        // Outro tipo reduzido: volta para double antes de converter
+        if (colunas_aloca(N, sizeof(double), (void **)&X, (void **)&Y) != 0) {
+            fprintf(stderr, "Erro ao alocar memória\n");
+            return 1;
+        }
+        for (long i = 0; i < N; i++) {
+            X[i] = binario_le_valor(cab.tipo, colX, i, centroX, passoX);
+            Y[i] = binario_le_valor(cab.tipo, colY, i, centroY, passoY);
+        }
+        libera_binario_colunas(colX, N, cab.tipo);
+    }
+
+    if (relatorioPrecisao && temOriginais) {
+        double inicio_ref, fim_ref;
+        GET_TIME(inicio_ref);
+        precisao_referencia(X, Y, N, &ref);
+        GET_TIME(fim_ref);
+        tempoReferencia = fim_ref - inicio_ref;
+    }
+
+    if (usaBinario && cab.tipo == MOTOR_TIPO) {
+        // Arquivo já no tipo do motor: nada a converter
+        vx = (const MotorValor *)colX;
+        vy = (const MotorValor *)colY;
+    } else {
+#if MOTOR_TIPO == MOTOR_F64
+        vx = X;
+        vy = Y;
+#else
+        // Redução no lugar: metade dos bytes lidos em cada passada. O pico de
+        // memória é o das colunas de doubles (sem cópia ao lado) e a metade
+        // final de cada coluna é devolvida; num binário f64 mapeado (páginas
+        // privadas) só as páginas reescritas passam a ocupar memória
+        erroX = binario_codifica_no_lugar(MOTOR_TIPO, X, N, centroX, passoX);
+        erroY = binario_codifica_no_lugar(MOTOR_TIPO, Y, N, centroY, passoY);
+        memoria_devolve((char *)X + N * sizeof(MotorValor), N * (sizeof(double) - sizeof(MotorValor)));
+        memoria_devolve((char *)Y + N * sizeof(MotorValor), N * (sizeof(double) - sizeof(MotorValor)));
+        vx = (const MotorValor *)X;
+        vy = (const MotorValor *)Y;
+#endif
+    }
+    GET_TIME(fim_leitura);
+
+    // ==================== CÁLCULO ====================
+    Motor motor;
+#if MOTOR_PARALELO
+    PoolThreads pool;
+    if (pool_inicializa(&pool, numThreads) != 0) {
+        fprintf(stderr, "Erro ao alocar memória\n");
+        return 1;
+    }
+    motor_inicializa(&motor, vx, vy, N, &pool);
+#else
+    motor_inicializa(&motor, vx, vy, N, NULL);
+#endif
+    motor_escala(&motor, centroX, passoX, centroY, passoY);
+    if (motor_calcula(&motor) != 0) {
+        fprintf(stderr, "Erro ao alocar parciais\n");
+        return 1;
+    }
+    GET_TIME(fim_total);
+
+    // ==================== EXIBIÇÃO DOS RESULTADOS ====================
+    printf("\n=== RESULTADOS ===\n");
+    printf("Numero de pontos: %ld\n", N);
+    printf("Threads usadas: %d\n", numThreads);
+    printf("Motor: %s, %s, %s\n", MOTOR_NOME_MODO, MOTOR_NOME_ACUMULADOR, MOTOR_NOME_TIPO);
+    printf("Nucleo de calculo: %s\n", nucleo_nome);
+    printf("Memoria das colunas: %.1f MB", 2.0 * N * sizeof(MotorValor) / 1e6);
+    const void *alocadas = (X && !mapeados) ? (const void *)X : NULL;
+    if (alocadas)
+        printf(" (alocadas, alinhadas em %d bytes, paginas %s, %ld KB em paginas de 2 MB)",
+               MEMORIA_LINHA, colunas_paginas(alocadas), colunas_kb_grandes(alocadas));
+    else if (mapeados && MOTOR_TIPO != MOTOR_F64)
+        printf(" (reduzidas nas paginas privadas do binario f64 mapeado, alinhadas em %d bytes, "
+               "REGRESSAO_PAGINAS nao se aplica)", BINARIO_ALINHAMENTO);
+    else
+        printf(" (arquivo binario mapeado, alinhadas em %d bytes pelo formato, paginas do cache "
+               "do arquivo, REGRESSAO_PAGINAS nao se aplica)", BINARIO_ALINHAMENTO);
+    printf("\n");
+    if (!usaBinario)
+        printf("Faltas de pagina na leitura: %ld\n", leitor_tempos.faltas);
+    printf("A (intercepto): %.6f\n", motor.A);
+    printf("B (inclinacao): %.6f\n", motor.B);
+    if (MOTOR_TEM_MSE)
+        printf("MSE (Erro Quadratico Medio): %.6f\n", motor.MSE);
+
+    printf("\n=== TEMPOS DE EXECUCAO ===\n");
+    printf("Tempo leitura: %f segundos\n", fim_leitura - inicio_total - tempoReferencia);
+    printf("Tempo regressao: %f segundos\n", motor.tempoSomas);
+    if (MOTOR_ACUMULADOR == MOTOR_SSE)
+        printf("Tempo MSE: %f segundos\n", motor.tempoMSE);
+    printf("Tempo total programa: %f segundos\n",
+           fim_total - inicio_total - tempoReferencia);  // Sem a referência de --precisao
+
+    if (relatorioPrecisao) {
+        if (temOriginais)
+            precisao_relatorio(stdout, &ref, motor.A, motor.B, motor.MSE, MOTOR_TEM_MSE,
+                               erroX, erroY, MOTOR_NOME_TIPO);
+        else
+            printf("\nPrecisao: %s ja esta em %s, sem os doubles originais para comparar\n",
+                   nomeArquivo, binario_nome_tipo(cab.tipo));
+    }
+
+    // ==================== MODO INTERATIVO DE PREVISÃO ====================
+    prever_valores(motor.A, motor.B);
+
+    // ==================== LIMPEZA DE MEMÓRIA ====================
+    motor_libera(&motor);
+#if MOTOR_PARALELO
+    pool_destroi(&pool);
+#endif
+    if (X) {
+        libera_doubles(X, N, mapeados);  // Também as colunas reduzidas no lugar
+    } else {
+        libera_binario_colunas(colX, N, cab.tipo);  // Colunas reduzidas usadas direto do arquivo
+    }
+    return 0;
+}
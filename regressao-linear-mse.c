@@ -1,9 +1,23 @@
+#define _GNU_SOURCE  // pthread_setaffinity_np e CPU_SET (fixação de threads no modo --numa)
 #include <stdio.h>
 #include <stdlib.h>
 #include <pthread.h>
 #include <string.h>
 //#include <math.h>
 #include "timer.h"
+#include "leitor_csv.h"
+#include "formato_binario.h"
+#include "soma_compensada.h"
+#include "estatisticas.h"
+#include "pool_threads.h"
+#include "nucleos_simd.h"
+#include "topologia.h"
+#include "previsao_lote.h"
+#include "modelo.h"
+#include "leitor_blocos.h"
+#include "instrumentacao.h"
+#include "bootstrap_regressao.h"
+#include "relatorio_precisao.h"
 
 // Variáveis globais para armazenar os dados
 // X e Y são arrays dinâmicos que armazenam os pontos (x,y) do arquivo CSV
@@ -11,15 +25,58 @@ double *X, *Y;
 long N = 0;          // Número total de pontos lidos do arquivo
 int numThreads;      // Número de threads definido pelo usuário
 
-// Estrutura para armazenar resultados parciais de cada thread
-// Cada thread calcula suas próprias somas localmente
+// Com --precisao f32|fx32 os doubles de X/Y são convertidos no próprio lugar
+// (binario_codifica_no_lugar) e X/Y passam a guardar floats ou int32; as fases
+// em memória chamam os núcleos do tipo. No ponto fixo os cálculos são sobre q
+// e os coeficientes voltam para a escala dos dados no fim (x = centroX + passoX·q)
+uint32_t tipoColunas = BINARIO_FLOAT64;
+double centroX = 0, passoX = 1, centroY = 0, passoY = 1;
+
+#define LINHA_CACHE 64  // Tamanho da linha de cache (bytes)
+
+// Estrutura para armazenar resultados parciais de cada pedaço (ou thread)
+// Cada pedaço tem suas somas calculadas localmente. Alinhada (e completada)
+// em uma linha de cache: a posição de cada pedaço no array parciais fica em
+// uma linha só sua, sem falso compartilhamento entre threads vizinhas
 typedef struct {
     double somaX, somaY, somaX2, somaXY;  // Somas parciais: Σx, Σy, Σx², Σxy
     double somaErroQuad;                   // Soma parcial do erro quadrático
+} __attribute__((aligned(LINHA_CACHE))) Parcial;
+
+Parcial *parciais;  // Resultados de cada pedaço (em memória) ou de cada thread (modos fluxo)
+
+// Somas do modo fundido (--fundido): além de Σx, Σy, Σx², Σxy, acumula Σy²,
+// tudo com soma compensada, para obter o MSE sem a segunda fase
+typedef struct {
+    SomaComp somaX, somaY, somaX2, somaXY, somaY2;
+} __attribute__((aligned(LINHA_CACHE))) ParcialEstendido;
+
+// Aloca n posições zeradas alinhadas à linha de cache (calloc não garante o alinhamento)
+static void *aloca_parciais(long n, size_t tam) {
+    void *p = aligned_alloc(LINHA_CACHE, n * tam);  // tam é múltiplo de LINHA_CACHE
+    if (p)
+        memset(p, 0, n * tam);
+    return p;
+}
+
+ParcialEstendido *estendidos;  // Um por pedaço (ou por thread), usado apenas no modo fundido
+
+// Com os dados em memória as fases dividem [0, N) em pedaços de PEDACO_PONTOS
+// distribuídos pelo pool com roubo (ver pool_executa_pedacos). Cada pedaço
+// tem sua posição em parciais/estendidos, reduzidas sempre em ordem: o
+// resultado não depende do número de threads nem de quem executou cada pedaço.
+#define PEDACO_PONTOS 16384  // 256 KB de X e Y por pedaço (cabe na L2)
+long numPedacos;
 
-} Parcial;
+// Modo estável (--estavel): os dados são divididos em blocos de tamanho fixo
+// (independente do número de threads). Cada bloco tem seus momentos centrados
+// e sua soma de erros, combinados sempre na mesma ordem, então A, B e MSE
+// saem idênticos com 1 ou N threads.
+#define BLOCO_ESTAVEL 4096  // PEDACO_PONTOS é múltiplo deste valor
 
-Parcial *parciais;  // Array de estruturas para armazenar resultados de cada thread
+Momentos *momentosBloco;  // Momentos de cada bloco
+double *erroBloco;        // Σ(y - ŷ)² de cada bloco
+long numBlocos;
 
 // Estrutura para passar parâmetros para as threads do MSE
 typedef struct {
@@ -30,281 +87,794 @@ typedef struct {
     long fim;
 } ArgsMSE;
 
-// ==================== FUNÇÃO EXECUTADA POR CADA THREAD ====================
-void *calcula_somas(void *arg) {
-     long id = (long)arg;  // ID da thread 
-    
-    // Calcula o intervalo de trabalho para esta thread
-    // Divisão por blocos: cada thread processa um segmento contíguo do array
-    long inicio = id * (N / numThreads);
-    long fim = (id == numThreads - 1) ? N : inicio + (N / numThreads);
-    // A última thread pega os elementos restantes se N não for divisível por numThreads
-
-    // Variáveis locais para acumular as somas (evitam conflitos de memória)
-    double somaX = 0, somaY = 0, somaX2 = 0, somaXY = 0;
-    double somaErroQuad = 0;  // VARIÁVEL LOCAL PARA ACUMULAR O ERRO QUADRÁTICO
-    double x_val, y_val;  // Variáveis temporárias para melhor performance
-    
-    // Percorre o segmento atribuído a esta thread
-    for (long i = inicio; i < fim; i++) {
-        x_val = X[i];  // Lê valor de X uma vez 
-        y_val = Y[i];  // Lê valor de Y uma vez 
-        somaX  += x_val;      // Acumula soma dos valores de X
-        somaY  += y_val;      // Acumula soma dos valores de Y
-        somaX2 += x_val * x_val;  // Acumula soma dos quadrados de X
-        somaXY += x_val * y_val;  // Acumula soma dos produtos X*Y
+// ==================== NÚCLEOS DE CÁLCULO ====================
+// Os laços são os núcleos de nucleos_simd.h (os mesmos do motor_regressao.h),
+// na versão escolhida para esta CPU; aqui sem deslocamento (x0 = y0 = 0).
+
+// Junta em p as somas Σx, Σy, Σx², Σxy de um trecho
+static void junta_somas(Parcial *p, const double somas[4]) {
+    p->somaX  += somas[0];
+    p->somaY  += somas[1];
+    p->somaX2 += somas[2];
+    p->somaXY += somas[3];
+}
+
+// Junta em p as somas estendidas (Σx, Σy, Σx², Σxy, Σy², compensadas) de um trecho
+static void junta_somas_estendidas(ParcialEstendido *p, const SomaComp somas[5]) {
+    comp_combina(&p->somaX,  somas[0]);
+    comp_combina(&p->somaY,  somas[1]);
+    comp_combina(&p->somaX2, somas[2]);
+    comp_combina(&p->somaXY, somas[3]);
+    comp_combina(&p->somaY2, somas[4]);
+}
+
+// Acumula em p as somas Σx, Σy, Σx², Σxy de n pontos consecutivos
+static void acumula_somas(const double *vx, const double *vy, long n, Parcial *p) {
+    double somas[4];  // Σx, Σy, Σx², Σxy do trecho
+
+    nucleo_somas(vx, vy, n, 0, 0, somas);
+    junta_somas(p, somas);
+}
+
+// Acumula em p as somas estendidas (com Σy², compensadas) de n pontos consecutivos
+static void acumula_somas_estendidas(const double *vx, const double *vy, long n,
+                                     ParcialEstendido *p) {
+    SomaComp somas[5];  // Σx, Σy, Σx², Σxy, Σy² do trecho
+
+    nucleo_somas_estendidas(vx, vy, n, 0, 0, somas);
+    junta_somas_estendidas(p, somas);
+}
+
+// Retorna Σ(y - (A + B*x))² de n pontos consecutivos
+static double acumula_erro(const double *vx, const double *vy, long n, double A, double B) {
+    return nucleo_erro(vx, vy, n, A, B);
+}
+
+// Os mesmos três cálculos sobre [inicio, inicio + n) de X/Y, no tipo de tipoColunas
+static void somas_colunas(long inicio, long n, double somas[4]) {
+    if (tipoColunas == BINARIO_FLOAT32)
+        nucleo_somas_f32((const float *)X + inicio, (const float *)Y + inicio, n, 0, 0, somas);
+    else if (tipoColunas == BINARIO_FIXO32)
+        nucleo_somas_fx32((const int32_t *)X + inicio, (const int32_t *)Y + inicio, n, 0, 0, somas);
+    else
+        nucleo_somas(X + inicio, Y + inicio, n, 0, 0, somas);
+}
+
+static void somas_estendidas_colunas(long inicio, long n, SomaComp somas[5]) {
+    if (tipoColunas == BINARIO_FLOAT32)
+        nucleo_somas_estendidas_f32((const float *)X + inicio, (const float *)Y + inicio, n, 0, 0, somas);
+    else if (tipoColunas == BINARIO_FIXO32)
+        nucleo_somas_estendidas_fx32((const int32_t *)X + inicio, (const int32_t *)Y + inicio, n, 0, 0, somas);
+    else
+        nucleo_somas_estendidas(X + inicio, Y + inicio, n, 0, 0, somas);
+}
+
+static double erro_colunas(long inicio, long n, double A, double B) {
+    if (tipoColunas == BINARIO_FLOAT32)
+        return nucleo_erro_f32((const float *)X + inicio, (const float *)Y + inicio, n, A, B);
+    if (tipoColunas == BINARIO_FIXO32)
+        return nucleo_erro_fx32((const int32_t *)X + inicio, (const int32_t *)Y + inicio, n, A, B);
+    return nucleo_erro(X + inicio, Y + inicio, n, A, B);
+}
+
+// Calcula A, B e MSE direto das somas estendidas já reduzidas:
+//   Sxx = Σx² - (Σx)²/n    Sxy = Σxy - ΣxΣy/n    Syy = Σy² - (Σy)²/n
+//   B = Sxy / Sxx          A = (Σy - B·Σx) / n    SSE = Syy - Sxy²/Sxx
+// As contas são feitas em double-double: o SSE é a diferença de dois números
+// enormes e quase iguais, e em double puro perderia praticamente todos os
+// dígitos. Tolerância: o MSE difere do calculado na segunda fase em menos de
+// 1e-8 (relativo), e a diferença vem dos coeficientes em double puro daquela fase.
+static void coeficientes_estendidos(const ParcialEstendido *total, long n,
+                                    double *A, double *B, double *MSE) {
+    DuplaDupla dn = dd_de((double)n);
+    DuplaDupla sx = dd_de_soma(total->somaX), sy = dd_de_soma(total->somaY);
+    DuplaDupla sxx = dd_sub(dd_de_soma(total->somaX2), dd_div(dd_mul(sx, sx), dn));
+    DuplaDupla sxy = dd_sub(dd_de_soma(total->somaXY), dd_div(dd_mul(sx, sy), dn));
+    DuplaDupla syy = dd_sub(dd_de_soma(total->somaY2), dd_div(dd_mul(sy, sy), dn));
+
+    DuplaDupla b = dd_div(sxy, sxx);
+    DuplaDupla sse = dd_sub(syy, dd_mul(b, sxy));
+
+    *B = b.hi;
+    *A = dd_div(dd_sub(sy, dd_mul(b, sx)), dn).hi;
+    *MSE = (sse.hi > 0) ? sse.hi / n : 0.0;  // Arredondamento não pode tornar o SSE negativo
+}
+
+// ==================== FUNÇÕES EXECUTADAS EM CADA PEDAÇO ====================
+// Chamadas pelo pool (pool_executa_pedacos) para os pontos [inicio, fim), que
+// formam o pedaço número pedaco; cada uma escreve só na posição do seu pedaço
+static void calcula_somas(long inicio, long fim, long pedaco, void *contexto) {
+    (void)contexto;
+    // Acumula em uma estrutura local e só no fim escreve na posição do pedaço
+    Parcial local = {0};
+    double somas[4];
+    somas_colunas(inicio, fim - inicio, somas);
+    junta_somas(&local, somas);
+    parciais[pedaco] = local;
+}
+
+// Mesma divisão de calcula_somas, acumulando as somas estendidas do modo fundido
+static void calcula_somas_estendidas(long inicio, long fim, long pedaco, void *contexto) {
+    (void)contexto;
+    ParcialEstendido local = {0};
+    SomaComp somas[5];
+    somas_estendidas_colunas(inicio, fim - inicio, somas);
+    junta_somas_estendidas(&local, somas);
+    estendidos[pedaco] = local;
+}
+
+// Modo estável: momentos de cada bloco de BLOCO_ESTAVEL pontos do pedaço
+static void calcula_momentos(long inicio, long fim, long pedaco, void *contexto) {
+    (void)pedaco; (void)contexto;
+    for (long b = inicio / BLOCO_ESTAVEL; b * BLOCO_ESTAVEL < fim; b++) {
+        long ini = b * BLOCO_ESTAVEL;
+        long n = (ini + BLOCO_ESTAVEL < N) ? BLOCO_ESTAVEL : N - ini;
+        momentos_bloco(X + ini, Y + ini, n, &momentosBloco[b]);
     }
+}
+
+// Modo NUMA: cada thread, já fixada na sua CPU, copia a faixa inicial da sua
+// fila de pedaços (pool_faixa_pedacos) para os arrays novos. Como é a primeira
+// a tocar essas páginas, elas ficam no nó NUMA da thread que vai processá-las
+// (exceto os pedaços que outra thread roubar).
+double *Xlocal, *Ylocal;
 
-    // Armazena resultados parciais na estrutura compartilhada
-    // Cada thread escreve em sua própria posição (evita corrida de dados)
-    parciais[id].somaX = somaX;
-    parciais[id].somaY = somaY;
-    parciais[id].somaX2 = somaX2;
-    parciais[id].somaXY = somaXY;
-    parciais[id].somaErroQuad = somaErroQuad;  // Armazena soma parcial do erro quadrático
+void *copia_bloco(void *arg) {
+    long id = (long)arg;
+    long inicio, fim;
+    pool_faixa_pedacos(N, PEDACO_PONTOS, numThreads, id, &inicio, &fim);
 
-    pthread_exit(NULL); 
+    memcpy(Xlocal + inicio, X + inicio, (fim - inicio) * sizeof(double));
+    memcpy(Ylocal + inicio, Y + inicio, (fim - inicio) * sizeof(double));
+    return NULL;
 }
 
 // ==================== CALCULO DO MSE EM PARALELO ====================
-// Função executada por cada thread para calcular o Erro Quadrático Médio (MSE)
-void *calcula_mse(void *arg) {
-    // Converte o ponteiro genérico para a estrutura ArgsMSE que contém os parâmetros
-    ArgsMSE *args = (ArgsMSE *)arg;
-    
-    // Variável local para acumular a soma dos erros quadráticos desta thread
-    double somaErroQuad = 0;
-    double x_val, y_val, y_prev, erro;
-    
-    // Loop que processa cada ponto do segmento atribuído a esta thread
-    for (long i = args->inicio; i < args->fim; i++) {
-        // Lê os valores reais de X e Y dos arrays globais
-        x_val = X[i];
-        y_val = Y[i];
-        
-        // Calcula o valor previsto Y usando a equação da regressão linear: ŷ = A + B*x
-        // Usa os coeficientes A e B passados via estrutura de argumentos
-        y_prev = args->A + args->B * x_val;
-        
-        // Calcula o erro (resíduo) = diferença entre valor real e valor previsto
-        erro = y_val - y_prev;
-        
-        // Acumula o quadrado do erro - elimina sinais negativos e penaliza erros grandes
-        somaErroQuad += erro * erro;
+// Σ(y - ŷ)² do pedaço, com os coeficientes A e B de contexto (ArgsMSE)
+static void calcula_mse(long inicio, long fim, long pedaco, void *contexto) {
+    ArgsMSE *args = (ArgsMSE *)contexto;
+    parciais[pedaco].somaErroQuad = erro_colunas(inicio, fim - inicio, args->A, args->B);
+}
+
+// Modo estável: mesmos blocos de calcula_momentos, um resultado por bloco
+static void calcula_mse_blocos(long inicio, long fim, long pedaco, void *contexto) {
+    ArgsMSE *args = (ArgsMSE *)contexto;
+    (void)pedaco;
+    for (long b = inicio / BLOCO_ESTAVEL; b * BLOCO_ESTAVEL < fim; b++) {
+        long ini = b * BLOCO_ESTAVEL;
+        long n = (ini + BLOCO_ESTAVEL < N) ? BLOCO_ESTAVEL : N - ini;
+        erroBloco[b] = acumula_erro(X + ini, Y + ini, n, args->A, args->B);
     }
+}
 
-    // Armazena o resultado parcial desta thread na estrutura compartilhada
-    // Usa o ID da thread para escrever na posição correta do array parciais
-    parciais[args->id].somaErroQuad = somaErroQuad;
+// ==================== FUNÇÕES DO MODO FLUXO ====================
+// Chamadas pelo leitor (percorre_csv_paralelo) para cada lote de pontos
+// convertidos: acumulam direto nos parciais, sem guardar X/Y
+static void lote_somas(const double *loteX, const double *loteY, long n, void *contexto) {
+    acumula_somas(loteX, loteY, n, (Parcial *)contexto);
+}
 
-    // Encerra a thread normalmente
-    pthread_exit(NULL);
+static void lote_somas_estendidas(const double *loteX, const double *loteY, long n, void *contexto) {
+    acumula_somas_estendidas(loteX, loteY, n, (ParcialEstendido *)contexto);
 }
 
-// ==================== FUNÇÃO DE PREVISÃO INTERATIVA ====================
-void prever_valores(double A, double B) {
-    char entrada[64];  // Buffer para entrada do usuário
-    double x;          // Valor de X para previsão
-
-    printf("\n=== MODO DE PREVISAO ===\n");
-    printf("Digite um valor de X para prever Y (ou 'q' para sair)\n");
-
-    // Loop infinito até o usuário digitar 'q' ou 'sair'
-    while (1) {
-        printf("X = ");
-        if (scanf("%s", entrada) != 1)  // Lê entrada como string
-            break;
-
-        // Verifica se usuário quer sair
-        if (strcmp(entrada, "q") == 0 || strcmp(entrada, "sair") == 0)
-            break;
-
-        // Tenta converter a entrada para número
-        if (sscanf(entrada, "%lf", &x) == 1) {
-            // Calcula Y previsto usando a equação da regressão linear: y = A + B*x
-            double y_prev = A + B * x;
-            printf("-> Y previsto = %.6f\n", y_prev);
-        } else {
-            printf("Entrada invalida. Digite um numero ou 'q' para sair.\n");
-        }
-    }
+// Momentos do lote combinados aos momentos desta thread (para o arquivo do modelo)
+static void lote_momentos(const double *loteX, const double *loteY, long n, void *contexto) {
+    Momentos lote;
+    momentos_bloco(loteX, loteY, n, &lote);
+    momentos_combina((Momentos *)contexto, &lote);
+}
 
-    printf("Saindo do modo de previsao.\n");
+static void lote_erro(const double *loteX, const double *loteY, long n, void *contexto) {
+    ArgsMSE *args = (ArgsMSE *)contexto;
+    parciais[args->id].somaErroQuad += acumula_erro(loteX, loteY, n, args->A, args->B);
+}
+
+// Uma passada pelo arquivo sem guardar X/Y: em blocos com leitura antecipada
+// (--fora-memoria, capacidadeBloco > 0) ou com cada thread lendo sua faixa (--fluxo)
+static long percorre_arquivo(const char *nomeArquivo, PoolThreads *pool, size_t capacidadeBloco,
+                             LeitorProcessaLote processa, void *contextos, size_t tamContexto,
+                             ResumoBlocos *resumo) {
+    if (capacidadeBloco > 0)
+        return percorre_blocos(nomeArquivo, pool, capacidadeBloco, processa,
+                               contextos, tamContexto, resumo);
+    return percorre_csv_paralelo(nomeArquivo, numThreads, processa, contextos, tamContexto);
 }
 
 // =========================== FUNÇÃO PRINCIPAL ===========================
 int main(int argc, char *argv[]) {
     // Variáveis para medição de tempo
     double inicio, fim, inicio_mse, fim_mse;           // Tempo dos cálculos paralelos
+    double inicio_leitura = 0, fim_leitura = 0;        // Tempo da carga dos dados em memória
     double inicio_total, fim_total; // Tempo total do programa
-    char linha[256];  // Buffer para ler cada linha do arquivo
-    int capacidade = 10000;  // Capacidade inicial dos arrays
 
     // Verifica argumentos da linha de comando
     if (argc < 3) {
-        printf("Uso: %s <arquivo.csv> <num_threads>\n", argv[0]);
+        printf("Uso: %s <arquivo.csv> <num_threads> [--mmap] [--fluxo | --fora-memoria <MB>] [--fundido | --estavel] [--numa]\n"
+               "          [--prever <entrada|-> [--saida <arquivo|->] [--formato csv|bin]]\n"
+               "          [--salvar-modelo <arquivo>] [--metricas <arquivo.json>] [--perf] [--estatico]\n"
+               "          [--bootstrap <R> [--confianca <C>] [--semente <S>]] [--precisao f32|fx32]\n", argv[0]);
         return 1;
     }
 
     char *nomeArquivo = argv[1];  // Nome do arquivo CSV
     numThreads = atoi(argv[2]);   // Converte número de threads para inteiro
 
-    GET_TIME(inicio_total);  // Inicia medição do tempo TOTAL do programa
-    
-    // Abre arquivo para leitura
-    FILE *arquivo = fopen(nomeArquivo, "r");
-    if (!arquivo) {
-        perror("Erro ao abrir o arquivo");
+    // Opções adicionais
+    int usaMmap = 0;  // --mmap: converte direto do arquivo mapeado, sem strtod
+    int usaFluxo = 0; // --fluxo: acumula enquanto lê, sem guardar X/Y (memória fixa)
+    double limiteMB = 0; // --fora-memoria: blocos com leitura antecipada, no máximo limiteMB de buffers
+    int modoFundido = 0; // --fundido: MSE na mesma passada das somas (acumulando Σy²)
+    int modoEstavel = 0; // --estavel: momentos centrados por bloco, reprodutível com N threads
+    int modoNuma = 0;    // --numa: fixa as threads nas CPUs e coloca cada bloco no nó da sua thread
+    char *entradaPrevisao = NULL;  // --prever: previsão em lote dos x deste arquivo (- = stdin) no lugar do modo interativo
+    char *saidaPrevisao = "-";     // --saida: destino da previsão em lote (- = stdout)
+    int formatoPrevisao = PREV_FORMATO_CSV;  // --formato: csv ("x,y") ou bin (y em double)
+    char *arquivoModelo = NULL;    // --salvar-modelo: grava A, B, MSE e os momentos (ver modelo.h)
+    char *arquivoMetricas = NULL;  // --metricas: grava as fases e os tempos por thread em JSON
+    int usaPerf = 0;               // --perf: contadores de hardware em cada fase (ver instrumentacao.h)
+    int semRoubo = 0;              // --estatico: cada thread só com a própria faixa (sem roubo de pedaços)
+    int numReamostras = 0;         // --bootstrap: réplicas para os intervalos de confiança de A e B
+    double confianca = 0.95;       // --confianca: nível dos intervalos do bootstrap
+    uint64_t semente = 1;          // --semente: semente dos pesos do bootstrap
+    // --precisao: colunas em float ou ponto fixo, comparadas com o double (relatorio_precisao.h)
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--mmap") == 0) {
+            usaMmap = 1;
+        } else if (strcmp(argv[i], "--fluxo") == 0) {
+            usaFluxo = 1;
+        } else if (strcmp(argv[i], "--fora-memoria") == 0 && i + 1 < argc) {
+            limiteMB = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--fundido") == 0) {
+            modoFundido = 1;
+        } else if (strcmp(argv[i], "--estavel") == 0) {
+            modoEstavel = 1;
+        } else if (strcmp(argv[i], "--numa") == 0) {
+            modoNuma = 1;
+        } else if (strcmp(argv[i], "--prever") == 0 && i + 1 < argc) {
+            entradaPrevisao = argv[++i];
+        } else if (strcmp(argv[i], "--saida") == 0 && i + 1 < argc) {
+            saidaPrevisao = argv[++i];
+        } else if (strcmp(argv[i], "--salvar-modelo") == 0 && i + 1 < argc) {
+            arquivoModelo = argv[++i];
+        } else if (strcmp(argv[i], "--metricas") == 0 && i + 1 < argc) {
+            arquivoMetricas = argv[++i];
+        } else if (strcmp(argv[i], "--perf") == 0) {
+            usaPerf = 1;
+        } else if (strcmp(argv[i], "--estatico") == 0) {
+            semRoubo = 1;
+        } else if (strcmp(argv[i], "--bootstrap") == 0 && i + 1 < argc) {
+            numReamostras = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--confianca") == 0 && i + 1 < argc) {
+            confianca = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) {
+            semente = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--precisao") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "f32") == 0) {
+                tipoColunas = BINARIO_FLOAT32;
+            } else if (strcmp(argv[i], "fx32") == 0) {
+                tipoColunas = BINARIO_FIXO32;
+            } else {
+                fprintf(stderr, "Precisao desconhecida: %s (use f32 ou fx32)\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--formato") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "csv") == 0) {
+                formatoPrevisao = PREV_FORMATO_CSV;
+            } else if (strcmp(argv[i], "bin") == 0) {
+                formatoPrevisao = PREV_FORMATO_BIN;
+            } else {
+                fprintf(stderr, "Formato desconhecido: %s (use csv ou bin)\n", argv[i]);
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "Opcao desconhecida: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (confianca <= 0 || confianca >= 1) {
+        fprintf(stderr, "Erro: --confianca deve estar entre 0 e 1 (por exemplo 0.95)\n");
         return 1;
     }
-    
-    // PULA CABEÇALHO - lê e descarta a primeira linha (ex: "x,y")
-    if (fgets(linha, sizeof(linha), arquivo) == NULL) {
-        fprintf(stderr, "Erro: arquivo vazio\n");
-        fclose(arquivo);
+    if (modoEstavel && modoFundido) {
+        fprintf(stderr, "Erro: --estavel e --fundido nao podem ser usados juntos\n");
         return 1;
     }
+    if (numThreads < 1)
+        numThreads = 1;
+    size_t capacidadeBloco = 0;  // Bytes de cada um dos dois buffers (0 = fora do modo)
+    if (limiteMB > 0) {
+        capacidadeBloco = blocos_capacidade((size_t)(limiteMB * 1024 * 1024), numThreads);
+        if (capacidadeBloco == 0) {
+            fprintf(stderr, "Erro: --fora-memoria precisa de pelo menos %.1f MB com %d threads\n",
+                    (2.0 * BLOCOS_MINIMO + numThreads * 2.0 * LEITOR_LOTE * sizeof(double)) / (1024 * 1024),
+                    numThreads);
+            return 1;
+        }
+        usaFluxo = 1;
+    }
 
-    // ==================== ALOCAÇÃO DINÂMICA INICIAL ====================
-    X = malloc(capacidade * sizeof(double));
-    Y = malloc(capacidade * sizeof(double));
+    // Contadores abertos antes de criar qualquer thread (leitura e pool)
+    Instrumentacao instr;
+    instr_inicia(&instr, usaPerf);
+    struct stat infoArquivo;
+    double bytesArquivo = (stat(nomeArquivo, &infoArquivo) == 0) ? (double)infoArquivo.st_size : 0;
+
+    GET_TIME(inicio_total);  // Inicia medição do tempo TOTAL do programa
+    nucleos_seleciona();     // Versão dos laços de soma/erro para esta CPU (AVX-512, AVX2 ou escalar)
     
-    if (!X || !Y) {
-        fprintf(stderr, "Erro ao alocar memória inicial\n");
-        fclose(arquivo);
+    // ==================== LEITURA PARALELA DO ARQUIVO CSV ====================
+    // Cada thread lê e converte uma faixa de bytes do arquivo direto para
+    // sua fatia de X/Y (ver leitor_csv.h). Arquivos no formato binário são
+    // apenas mapeados, sem conversão (ver formato_binario.h)
+    // Nos modos fluxo e fora da memória nada é carregado aqui: as duas fases
+    // releem o arquivo (fora da memória, também o binário, em blocos).
+    int usaBinario = eh_arquivo_binario(nomeArquivo);
+    if (capacidadeBloco > 0)
+        usaBinario = 0;  // Lido em blocos por leitor_blocos.h, sem mapear
+    else if (usaBinario)
+        usaFluxo = 0;    // O binário já é só mapeado, sem cópia
+    if (modoEstavel && usaFluxo) {
+        fprintf(stderr, "Erro: --estavel precisa dos dados em memoria (incompativel com --fluxo e --fora-memoria)\n");
+        return 1;
+    }
+    if (numReamostras > 0 && usaFluxo) {
+        fprintf(stderr, "Erro: --bootstrap precisa dos dados em memoria (incompativel com --fluxo e --fora-memoria)\n");
+        return 1;
+    }
+    if (modoNuma && usaFluxo) {
+        fprintf(stderr, "Erro: --numa precisa dos dados em memoria (incompativel com --fluxo e --fora-memoria)\n");
         return 1;
     }
+    if (tipoColunas != BINARIO_FLOAT64 &&
+        (usaFluxo || modoEstavel || modoNuma || numReamostras > 0 || arquivoModelo)) {
+        // Esses modos leem X/Y como double (momentos, cópia NUMA, réplicas) ou releem o arquivo
+        fprintf(stderr, "Erro: --precisao precisa dos dados em memoria e e incompativel com "
+                        "--fluxo, --fora-memoria, --estavel, --numa, --bootstrap e --salvar-modelo\n");
+        return 1;
+    }
+    GET_TIME(inicio_leitura);
+    if (usaBinario)
+        N = carrega_binario(nomeArquivo, &X, &Y, NULL);
+    else if (usaFluxo)
+        X = Y = NULL;
+    else if (usaMmap)
+        N = carrega_csv_mmap(nomeArquivo, numThreads, &X, &Y);
+    else
+        N = carrega_csv_paralelo(nomeArquivo, numThreads, &X, &Y);
+    GET_TIME(fim_leitura);
+    if (N < 0) {
+        return 1;
+    }
+    if (usaBinario) {
+        instr_registra(&instr, "leitura", inicio_leitura, fim_leitura, 0);  // Só mapeia: as páginas são lidas nas somas
+    } else if (!usaFluxo) {
+        // Leitura dos bytes (etapa 1) e conversão para X/Y (etapa 2), ver leitor_csv.h
+        instr_registra(&instr, "leitura", leitor_tempos.inicio, leitor_tempos.conversao, bytesArquivo);
+        int faseConversao = instr_registra(&instr, "conversao", leitor_tempos.conversao,
+                                           leitor_tempos.fim, bytesArquivo);
+        if (faseConversao >= 0)
+            instr.fases[faseConversao].faltas = leitor_tempos.faltas;  // Primeiro toque em X e Y
+    }
 
-    // ==================== LEITURA DO ARQUIVO CSV ====================
-    // Lê cada linha do arquivo após o cabeçalho
-    while (fgets(linha, sizeof(linha), arquivo)) {
-        double x, y;
-        // Tenta extrair dois números double separados por vírgula
-        if (sscanf(linha, "%lf,%lf", &x, &y) == 2) {
-            // Realoca arrays se capacidade insuficiente (dobra a capacidade)
-            if (N >= capacidade) {
-                capacidade *= 2;
-                X = realloc(X, capacidade * sizeof(double));
-                Y = realloc(Y, capacidade * sizeof(double));
-                if (!X || !Y) {
-                    fprintf(stderr, "Erro ao realocar memória\n");
-                    fclose(arquivo);
-                    return 1;
-                }
-            }
-            // Armazena os valores nos arrays
-            X[N] = x;
-            Y[N] = y;
-            N++;  // Incrementa contador de pontos
+    // ==================== COLUNAS REDUZIDAS (--precisao) ====================
+    // Referência em double (fora dos tempos) e conversão no próprio lugar: o
+    // pico é o das colunas de doubles e a metade final de cada coluna volta
+    // para o sistema. Num binário f64 mapeado (páginas privadas) só as
+    // páginas reescritas passam a ocupar memória.
+    ReferenciaPrecisao refPrecisao = {0};
+    double erroX = 0, erroY = 0, tempoReferencia = 0;
+    if (tipoColunas != BINARIO_FLOAT64) {
+        double inicio_ref, fim_ref;
+        GET_TIME(inicio_ref);
+        precisao_referencia(X, Y, N, &refPrecisao);
+        GET_TIME(fim_ref);
+        tempoReferencia = fim_ref - inicio_ref;
+
+        int faseCodificacao = instr_abre(&instr, "codificacao");
+        if (tipoColunas == BINARIO_FIXO32) {
+            CabecalhoBinario cab;  // Só pelas faixas de X e Y
+            binario_monta_cabecalho(&cab, X, Y, N);
+            binario_fixo_escala(cab.minX, cab.maxX, &centroX, &passoX);
+            binario_fixo_escala(cab.minY, cab.maxY, &centroY, &passoY);
         }
+        erroX = binario_codifica_no_lugar(tipoColunas, X, N, centroX, passoX);
+        erroY = binario_codifica_no_lugar(tipoColunas, Y, N, centroY, passoY);
+        size_t tamElemento = binario_tam_elemento(tipoColunas);
+        memoria_devolve((char *)X + N * tamElemento, N * (sizeof(double) - tamElemento));
+        memoria_devolve((char *)Y + N * tamElemento, N * (sizeof(double) - tamElemento));
+        instr_fecha(&instr, faseCodificacao, 16.0 * N + 8.0 * N);  // Lê os doubles e grava a metade
+    }
+
+    // As mesmas threads do pool executam todas as fases (ver pool_threads.h);
+    // com N pequeno as fases rodam direto nesta thread
+    PoolThreads pool;
+    if (pool_inicializa(&pool, numThreads) != 0) {
+        fprintf(stderr, "Erro ao alocar memória\n");
+        return 1;
+    }
+    pool.semRoubo = semRoubo;
+
+    // ==================== POSICIONAMENTO NUMA ====================
+    int cpus[numThreads], nos[numThreads];  // CPU e nó NUMA de cada thread
+    Topologia topo;
+    int numaPosicionado = 0;  // A cópia rodou nas threads fixadas (e não só na chamadora)
+    if (modoNuma) {
+        topologia_descobre(&topo);
+        topologia_distribui(&topo, numThreads, cpus, nos);
+        pool_fixa_cpus(&pool, cpus);
+
+        // Colunas novas (ainda sem páginas) preenchidas pelas threads fixadas
+        if (colunas_aloca(N, sizeof(double), (void **)&Xlocal, (void **)&Ylocal) != 0) {
+            fprintf(stderr, "Erro ao alocar memória\n");
+            return 1;
+        }
+        // A cópia passa sempre pelas threads: abaixo do corte sequencial a
+        // chamadora tocaria todas as páginas, e elas ficariam no nó dela
+        int faseNuma = instr_abre(&instr, "numa");
+        pool_executa(&pool, (N > POOL_CORTE_SEQUENCIAL) ? N : POOL_CORTE_SEQUENCIAL,
+                     copia_bloco, NULL, 0);
+        numaPosicionado = !pool.semThreads;
+        instr_fecha(&instr, faseNuma, 32.0 * N);  // Lê e escreve X e Y
+        instr_threads(&instr, faseNuma, &pool);
+        if (usaBinario) libera_binario(X, N); else colunas_libera(X);
+        X = Xlocal;
+        Y = Ylocal;
+        usaBinario = 0;
     }
-    fclose(arquivo);  // Fecha arquivo após leitura completa
 
     // ==================== PREPARAÇÃO PARA PROCESSAMENTO PARALELO ====================
-    // Aloca array para resultados parciais de cada thread
-    parciais = malloc(numThreads * sizeof(Parcial));
-    if (!parciais) {
+    // Aloca array para resultados parciais de cada pedaço (nos modos fluxo, de cada thread)
+    numPedacos = (N + PEDACO_PONTOS - 1) / PEDACO_PONTOS;
+    long numParciais = (usaFluxo || numPedacos < numThreads) ? numThreads : numPedacos;
+    parciais = aloca_parciais(numParciais, sizeof(Parcial));
+    estendidos = modoFundido ? aloca_parciais(numParciais, sizeof(ParcialEstendido)) : NULL;
+    numBlocos = (N + BLOCO_ESTAVEL - 1) / BLOCO_ESTAVEL;
+    momentosBloco = (modoEstavel || arquivoModelo) ? malloc((numBlocos + 1) * sizeof(Momentos)) : NULL;
+    erroBloco = modoEstavel ? malloc((numBlocos + 1) * sizeof(double)) : NULL;
+    if (!parciais || (modoFundido && !estendidos) ||
+        (modoEstavel && (!momentosBloco || !erroBloco)) || (arquivoModelo && !momentosBloco)) {
         fprintf(stderr, "Erro ao alocar parciais\n");
-        free(X); free(Y);
+        if (usaBinario) libera_binario(X, N); else colunas_libera(X);
         return 1;
     }
     
     
-    // ==================== CRIAÇÃO E EXECUÇÃO DAS THREADS (PRIMEIRA FASE) ====================
+    // ==================== EXECUÇÃO DAS THREADS (PRIMEIRA FASE) ====================
     // PRIMEIRA FASE: cálculo das somas para regressão linear
-    pthread_t threads[numThreads];  // Array para armazenar identificadores das threads
 
     GET_TIME(inicio);  // Inicia medição do tempo dos CÁLCULOS PARALELOS (regressão)
-    
-    // Cria todas as threads para calcular somas da regressão
-    for (long t = 0; t < numThreads; t++) {
-        // Cria thread que executará calcula_somas com argumento t (ID da thread)
-        pthread_create(&threads[t], NULL, calcula_somas, (void *)t);
-    }
-
-    // Aguarda término de todas as threads (sincronização)
-    for (int t = 0; t < numThreads; t++) {
-        pthread_join(threads[t], NULL);
-    }
-
-    // ==================== REDUÇÃO DOS RESULTADOS PARCIAIS (REGRESSÃO) ====================
-    // Combina resultados de todas as threads em somas globais
-    double somaX = 0, somaY = 0, somaX2 = 0, somaXY = 0;
-    for (int t = 0; t < numThreads; t++) {
-        somaX  += parciais[t].somaX;   // Soma global de X
-        somaY  += parciais[t].somaY;   // Soma global de Y
-        somaX2 += parciais[t].somaX2;  // Soma global de X²
-        somaXY += parciais[t].somaXY;  // Soma global de X*Y
+    int faseSomas = instr_abre(&instr, modoEstavel ? "momentos" : "somas");
+
+    ResumoBlocos resumoSomas = {0}, resumoErro = {0};  // Só no modo fora da memória
+    if (usaFluxo) {
+        // Modo fluxo: o arquivo é lido em blocos e cada thread acumula as
+        // somas no seu parcial; N é o total de pontos convertidos
+        if (modoFundido)
+            N = percorre_arquivo(nomeArquivo, &pool, capacidadeBloco, lote_somas_estendidas,
+                                 estendidos, sizeof(ParcialEstendido), &resumoSomas);
+        else
+            N = percorre_arquivo(nomeArquivo, &pool, capacidadeBloco, lote_somas,
+                                 parciais, sizeof(Parcial), &resumoSomas);
+        if (N < 0) {
+            free(parciais);
+            free(estendidos);
+            return 1;
+        }
+    } else {
+        // Cada thread pega pedaços da sua fila e depois das outras; o pool só
+        // retorna quando todos os pedaços terminaram
+        pool_executa_pedacos(&pool, N, PEDACO_PONTOS,
+                             modoEstavel ? calcula_momentos :
+                             modoFundido ? calcula_somas_estendidas : calcula_somas, NULL);
     }
+    long reduzidos = usaFluxo ? numThreads : numPedacos;  // Posições preenchidas em parciais/estendidos
+
+    // Nos modos em memória: 16 bytes (x e y) por ponto e tempos por thread;
+    // nos modos fluxo e fora da memória o arquivo inteiro é relido (e o pool,
+    // quando usado, executa uma fase por bloco)
+    instr_fecha(&instr, faseSomas, usaFluxo ? bytesArquivo : 16.0 * N);
+    if (!usaFluxo)
+        instr_threads(&instr, faseSomas, &pool);
+    int faseReducao = instr_abre(&instr, "reducao");
+
+    // Duração e pontos processados por cada thread na fase das somas (para o relatório de banda por nó)
+    double duracaoSomas[numThreads];
+    long pontosSomas[numThreads];
+    memcpy(duracaoSomas, pool.duracao, numThreads * sizeof(double));
+    for (int t = 0; t < numThreads; t++)
+        pontosSomas[t] = pool.filas[t].elementos;
+
+    double A, B, MSE;
+    Momentos momentosTotal = {0};  // Só no modo estável (ou calculados depois, para o modelo)
+    int temMomentos = 0;
+    if (modoFundido) {
+        // ==================== MODO FUNDIDO: A, B E MSE DIRETO DAS SOMAS ====================
+        ParcialEstendido total = {0};
+        for (long t = 0; t < reduzidos; t++) {
+            comp_combina(&total.somaX,  estendidos[t].somaX);
+            comp_combina(&total.somaY,  estendidos[t].somaY);
+            comp_combina(&total.somaX2, estendidos[t].somaX2);
+            comp_combina(&total.somaXY, estendidos[t].somaXY);
+            comp_combina(&total.somaY2, estendidos[t].somaY2);
+        }
+        coeficientes_estendidos(&total, N, &A, &B, &MSE);
+    } else if (modoEstavel) {
+        // ==================== MODO ESTÁVEL: COMBINA OS BLOCOS EM ORDEM ====================
+        for (long b = 0; b < numBlocos; b++) {
+            momentos_combina(&momentosTotal, &momentosBloco[b]);
+        }
+        momentos_coeficientes(&momentosTotal, &A, &B);
+        temMomentos = 1;
+    } else {
+        // ==================== REDUÇÃO DOS RESULTADOS PARCIAIS (REGRESSÃO) ====================
+        // Combina resultados de todos os pedaços (em ordem) em somas globais
+        double somaX = 0, somaY = 0, somaX2 = 0, somaXY = 0;
+        for (long t = 0; t < reduzidos; t++) {
+            somaX  += parciais[t].somaX;   // Soma global de X
+            somaY  += parciais[t].somaY;   // Soma global de Y
+            somaX2 += parciais[t].somaX2;  // Soma global de X²
+            somaXY += parciais[t].somaXY;  // Soma global de X*Y
+        }
 
-    // ==================== CÁLCULO DOS COEFICIENTES DA REGRESSÃO ====================
-    // Fórmula do coeficiente angular B: B = (n*Σxy - Σx*Σy) / (n*Σx² - (Σx)²)
-    double B = (N * somaXY - somaX * somaY) / (N * somaX2 - somaX * somaX);
+        // ==================== CÁLCULO DOS COEFICIENTES DA REGRESSÃO ====================
+        // Fórmula do coeficiente angular B: B = (n*Σxy - Σx*Σy) / (n*Σx² - (Σx)²)
+        B = (N * somaXY - somaX * somaY) / (N * somaX2 - somaX * somaX);
     
-    // Fórmula do coeficiente linear A: A = (Σy - B*Σx) / n
-    double A = (somaY - B * somaX) / N;
+        // Fórmula do coeficiente linear A: A = (Σy - B*Σx) / n
+        A = (somaY - B * somaX) / N;
+    }
 
     GET_TIME(fim);  // Fim da medição dos cálculos da regressão
+    instr_fecha(&instr, faseReducao, 0);
+    inicio_mse = fim_mse = fim;
+
+    // No modo fundido o MSE já foi obtido das somas: não há segunda fase
+    if (!modoFundido) {
+        // ==================== SEGUNDA FASE: CÁLCULO DO MSE EM PARALELO ====================
+        GET_TIME(inicio_mse);
+        int faseMSE = instr_abre(&instr, "mse");
+
+        ArgsMSE args_mse[numThreads];  // Array de estruturas de argumentos
+
+        // Prepara argumentos das threads do MSE (nos modos em memória a faixa
+        // vem de cada pedaço e só A e B de args_mse[0] são usados)
+        for (long t = 0; t < numThreads; t++) {
+            long base = N / numThreads;
+            long resto = N % numThreads;
+            long inicio = t * base + (t < resto ? t : resto);
+            long fim = inicio + base + (t < resto ? 1 : 0);
+    
+            args_mse[t].id = t;
+            args_mse[t].A = A;  // Passa coeficiente A
+            args_mse[t].B = B;  // Passa coeficiente B  
+            args_mse[t].inicio = inicio;
+            args_mse[t].fim = fim;
+        }
 
-    // ==================== SEGUNDA FASE: CÁLCULO DO MSE EM PARALELO ====================
+        if (usaFluxo) {
+            // Modo fluxo: segunda passada pelo arquivo com os coeficientes já conhecidos
+            if (percorre_arquivo(nomeArquivo, &pool, capacidadeBloco, lote_erro,
+                                 args_mse, sizeof(ArgsMSE), &resumoErro) < 0) {
+                free(parciais);
+                free(estendidos);
+                return 1;
+            }
+        } else {
+            // Reaproveita as threads e os mesmos pedaços da primeira fase
+            pool_executa_pedacos(&pool, N, PEDACO_PONTOS,
+                                 modoEstavel ? calcula_mse_blocos : calcula_mse, &args_mse[0]);
+            instr_threads(&instr, faseMSE, &pool);
+        }
 
-    ArgsMSE args_mse[numThreads];  // Array de estruturas de argumentos
-    pthread_t threads_mse[numThreads];  // Threads específicas para MSE
+        // ==================== REDUÇÃO DOS RESULTADOS PARCIAIS (MSE) ====================
+        // Combina resultados do erro quadrático de todas as threads
+        // (no modo estável, soma os blocos em ordem)
+        double somaErroQuadTotal = 0;
+        if (modoEstavel) {
+            for (long b = 0; b < numBlocos; b++) {
+                somaErroQuadTotal += erroBloco[b];
+            }
+        } else {
+            for (long t = 0; t < reduzidos; t++) {
+                somaErroQuadTotal += parciais[t].somaErroQuad;
+            }
+        }
 
-    // Prepara argumentos e cria threads para MSE
-    for (long t = 0; t < numThreads; t++) {
-        long base = N / numThreads;
-        long resto = N % numThreads;
-        long inicio = t * base + (t < resto ? t : resto);
-        long fim = inicio + base + (t < resto ? 1 : 0);
-    
-        args_mse[t].id = t;
-        args_mse[t].A = A;  // Passa coeficiente A
-        args_mse[t].B = B;  // Passa coeficiente B  
-        args_mse[t].inicio = inicio;
-        args_mse[t].fim = fim;
-    
-        pthread_create(&threads_mse[t], NULL, calcula_mse, &args_mse[t]);
-}
+        // ==================== CÁLCULO FINAL DO MSE ====================
+        // MSE = (1/n) * Σ(y - ŷ)²
+        MSE = somaErroQuadTotal / N;
+        GET_TIME(fim_mse);
+        instr_fecha(&instr, faseMSE, usaFluxo ? bytesArquivo : 16.0 * N);
+    }
 
-    // Aguarda threads do MSE
-    for (int t = 0; t < numThreads; t++) {
-        pthread_join(threads_mse[t], NULL);
+    if (tipoColunas != BINARIO_FLOAT64) {
+        // A, B e MSE saíram na escala de q (no float centro = 0 e passo = 1)
+        B = B * passoY / passoX;
+        A = centroY + passoY * A - B * centroX;
+        MSE = MSE * passoY * passoY;
     }
 
-    // ==================== REDUÇÃO DOS RESULTADOS PARCIAIS (MSE) ====================
-    // Combina resultados do erro quadrático de todas as threads
-    double somaErroQuadTotal = 0;
-    for (int t = 0; t < numThreads; t++) {
-        somaErroQuadTotal += parciais[t].somaErroQuad;
+    GET_TIME(fim_total);  // Fim da medição do tempo TOTAL
+
+    // ==================== BOOTSTRAP ====================
+    // Fora dos tempos medidos: R réplicas com pesos de Poisson sobre X/Y já
+    // carregados (ver bootstrap_regressao.h)
+    Bootstrap boot;
+    int erroBootstrap = 0;
+    if (numReamostras > 0) {
+        int faseBootstrap = instr_abre(&instr, "bootstrap");
+        erroBootstrap = bootstrap_calcula(&boot, &pool, X, Y, N, A, B, MSE, numReamostras,
+                                          confianca, semente) != 0;
+        instr_fecha(&instr, faseBootstrap, 16.0 * N);
+        instr_threads(&instr, faseBootstrap, &pool);
+        if (erroBootstrap)
+            fprintf(stderr, "Erro no bootstrap (memoria insuficiente ou menos de 3 pontos)\n");
     }
 
-    // ==================== CÁLCULO FINAL DO MSE ====================
-    // MSE = (1/n) * Σ(y - ŷ)²
-    double MSE = somaErroQuadTotal / N;
+    // ==================== ARQUIVO DO MODELO ====================
+    // Fora dos tempos medidos: nos modos que não calculam os momentos centrados,
+    // faz mais uma passada só para obtê-los (em blocos, ou relendo o CSV no modo fluxo)
+    int erroModelo = 0;
+    if (arquivoModelo) {
+        if (!temMomentos && usaFluxo) {
+            Momentos porThread[numThreads];
+            memset(porThread, 0, sizeof(porThread));
+            erroModelo = percorre_arquivo(nomeArquivo, &pool, capacidadeBloco, lote_momentos,
+                                          porThread, sizeof(Momentos), NULL) < 0;
+            for (int t = 0; t < numThreads; t++)
+                momentos_combina(&momentosTotal, &porThread[t]);
+        } else if (!temMomentos) {
+            pool_executa_pedacos(&pool, N, PEDACO_PONTOS, calcula_momentos, NULL);
+            for (long b = 0; b < numBlocos; b++)
+                momentos_combina(&momentosTotal, &momentosBloco[b]);
+        }
+        Modelo modelo;
+        modelo_de_momentos(&modelo, &momentosTotal, A, B, MSE);
+        if (!erroModelo)
+            erroModelo = grava_modelo(arquivoModelo, &modelo) != 0;
+    }
 
-    GET_TIME(fim);  // Fim da medição dos cálculos da regressão
-    GET_TIME(fim_total);  // Fim da medição do tempo TOTAL
+    // Com a previsão em lote indo para stdout, o relatório vai para stderr
+    FILE *relatorio = (entradaPrevisao && strcmp(saidaPrevisao, "-") == 0) ? stderr : stdout;
 
     // ==================== EXIBIÇÃO DOS RESULTADOS ====================
-    printf("\n=== RESULTADOS ===\n");
-    printf("Numero de pontos: %ld\n", N);
-    printf("Threads usadas: %d\n", numThreads);
-    printf("A (intercepto): %.6f\n", A);  // Coeficiente linear (intercepto y)
-    printf("B (inclinacao): %.6f\n", B);  // Coeficiente angular (inclinação)
-    printf("MSE (Erro Quadratico Medio): %.6f\n", MSE);  // MSE ADICIONADO
+    fprintf(relatorio, "\n=== RESULTADOS ===\n");
+    fprintf(relatorio, "Numero de pontos: %ld\n", N);
+    fprintf(relatorio, "Threads usadas: %d\n", numThreads);
+    fprintf(relatorio, "Nucleo de calculo: %s\n", nucleo_nome);
+    // Só as colunas de colunas_aloca (CSV e cópias NUMA) seguem REGRESSAO_PAGINAS;
+    // as do binário mapeado ficam nas páginas do cache do arquivo
+    if (X && !usaBinario)
+        fprintf(relatorio, "Colunas: alocadas%s, alinhadas em %d bytes, paginas %s (%ld KB em paginas de 2 MB)\n",
+                modoNuma ? " por no NUMA" : "", MEMORIA_LINHA, colunas_paginas(X), colunas_kb_grandes(X));
+    else if (X)
+        fprintf(relatorio, "Colunas: arquivo binario mapeado, alinhadas em %d bytes pelo formato, "
+                "paginas do cache do arquivo (REGRESSAO_PAGINAS nao se aplica)\n", BINARIO_ALINHAMENTO);
+    else
+        fprintf(relatorio, "Colunas: nenhuma em memoria (o arquivo e relido a cada passada)\n");
+    fprintf(relatorio, "A (intercepto): %.6f\n", A);  // Coeficiente linear (intercepto y)
+    fprintf(relatorio, "B (inclinacao): %.6f\n", B);  // Coeficiente angular (inclinação)
+    fprintf(relatorio, "MSE (Erro Quadratico Medio): %.6f\n", MSE);  // MSE ADICIONADO
+
+    fprintf(relatorio, "\n=== TEMPOS DE EXECUCAO ===\n");
+    if (fim_leitura > inicio_leitura && !usaFluxo)
+        fprintf(relatorio, "Tempo leitura: %f segundos\n", fim_leitura - inicio_leitura);
+    fprintf(relatorio, "Tempo regressao: %f segundos\n", fim - inicio);        // Tempo da regressão linear (somas e coeficientes)
+    if (!modoFundido)
+        fprintf(relatorio, "Tempo MSE: %f segundos\n", fim_mse - inicio_mse);  // Segunda fase
+    fprintf(relatorio, "Tempo total programa: %f segundos\n",
+            fim_total - inicio_total - tempoReferencia); // Programa completo (sem a referência de --precisao)
+    if (arquivoModelo && !erroModelo)
+        fprintf(relatorio, "Modelo salvo em: %s\n", arquivoModelo);
+
+    if (numReamostras > 0 && !erroBootstrap) {
+        // ==================== INTERVALOS DE CONFIANÇA ====================
+        // Erro padrão do bootstrap (desvio das réplicas) ao lado do analítico;
+        // muito diferentes indicam ruído de variância não constante ou outliers
+        fprintf(relatorio, "\n=== BOOTSTRAP (%d reamostras de Poisson, semente %llu) ===\n",
+                numReamostras, (unsigned long long)semente);
+        fprintf(relatorio, "A: erro padrao %.3e (analitico %.3e), IC %g%% [%.9f, %.9f]\n",
+                boot.erroPadraoA, boot.analiticoA, 100 * confianca, boot.infA, boot.supA);
+        fprintf(relatorio, "B: erro padrao %.3e (analitico %.3e), IC %g%% [%.9f, %.9f]\n",
+                boot.erroPadraoB, boot.analiticoB, 100 * confianca, boot.infB, boot.supB);
+        if (boot.validas < numReamostras)
+            fprintf(relatorio, "Reamostras sem reta definida (ignoradas): %d\n", numReamostras - boot.validas);
+        fprintf(relatorio, "Tempo bootstrap: %f segundos (%.1f milhoes de pontos-reamostra/s)\n",
+                boot.tempo, boot.tempo > 0 ? (double)N * numReamostras / boot.tempo / 1e6 : 0.0);
+    }
+
+    if (tipoColunas != BINARIO_FLOAT64)
+        precisao_relatorio(relatorio, &refPrecisao, A, B, MSE, 1, erroX, erroY,
+                           binario_nome_tipo(tipoColunas));
+
+    // ==================== FASES E TEMPOS POR THREAD ====================
+    instr_relatorio(&instr, relatorio);
+    if (arquivoMetricas && instr_grava_json(&instr, arquivoMetricas, N, numThreads) == 0)
+        fprintf(relatorio, "Metricas salvas em: %s\n", arquivoMetricas);
+
+    if (capacidadeBloco > 0) {
+        // ==================== VAZÃO FORA DA MEMÓRIA ====================
+        // Espera: tempo em que o cálculo ficou parado aguardando o próximo bloco
+        // (perto de 0 = leitura escondida atrás do cálculo; perto de 100% = limitado pelo disco)
+        fprintf(relatorio, "\n=== FORA DA MEMORIA ===\n");
+        fprintf(relatorio, "Buffers: 2 x %.1f MB (limite %.1f MB)\n",
+                capacidadeBloco / (1024.0 * 1024.0), limiteMB);
+        const char *nomesPassadas[] = {"somas", "erro"};
+        ResumoBlocos *passadas[] = {&resumoSomas, &resumoErro};
+        for (int k = 0; k < 2; k++) {
+            ResumoBlocos *r = passadas[k];
+            if (r->blocos == 0)
+                continue;
+            fprintf(relatorio, "Passada %s: %ld blocos, %.1f MB em %f segundos -> %.1f MB/s, "
+                    "%.1f milhoes de pontos/s, espera pela leitura %.0f%%\n",
+                    nomesPassadas[k], r->blocos, r->bytes / 1e6, r->tempo,
+                    r->tempo > 0 ? r->bytes / r->tempo / 1e6 : 0.0,
+                    r->tempo > 0 ? N / r->tempo / 1e6 : 0.0,
+                    r->tempo > 0 ? 100.0 * r->esperaLeitura / r->tempo : 0.0);
+        }
+    }
 
-    printf("\n=== TEMPOS DE EXECUCAO ===\n");
-    printf("Tempo regressao: %f segundos\n", fim - inicio);        // Tempo da regressão linear
-    printf("Tempo total programa: %f segundos\n", fim_total - inicio_total); // Programa completo
+    if (modoNuma) {
+        // ==================== BANDA POR NÓ NUMA ====================
+        // Bytes lidos (X e Y dos pontos processados) pelas threads de cada nó
+        // dividido pelo tempo da thread mais lenta do nó, na fase das somas
+        fprintf(relatorio, "\n=== BANDA POR NO NUMA (fase das somas) ===\n");
+        if (!numaPosicionado)
+            fprintf(relatorio, "Posicionamento nao feito: sem as threads do pool, a copia rodou "
+                               "toda na thread chamadora (paginas no no dela)\n");
+        for (int no = 0; no < topo.numNos; no++) {
+            double bytes = 0, tempo = 0;
+            int threadsNo = 0;
+            for (long t = 0; t < numThreads; t++) {
+                if (nos[t] != no)
+                    continue;
+                bytes += 2.0 * sizeof(double) * pontosSomas[t];
+                if (duracaoSomas[t] > tempo)
+                    tempo = duracaoSomas[t];
+                threadsNo++;
+            }
+            if (threadsNo > 0)
+                fprintf(relatorio, "No %d: %d threads, %.1f MB em %f segundos -> %.2f GB/s\n",
+                        no, threadsNo, bytes / 1e6, tempo, tempo > 0 ? bytes / tempo / 1e9 : 0.0);
+        }
+    }
 
-    // ==================== MODO INTERATIVO DE PREVISÃO ====================
-    prever_valores(A, B);
+    // ==================== PREVISÃO (EM LOTE OU INTERATIVA) ====================
+    int erroPrevisao = 0;
+    if (entradaPrevisao) {
+        ResumoLote resumo;
+        erroPrevisao = prever_lote(&pool, entradaPrevisao, saidaPrevisao, formatoPrevisao, A, B, &resumo) != 0;
+        if (!erroPrevisao) {
+            fprintf(relatorio, "\n=== PREVISAO EM LOTE ===\n");
+            fprintf(relatorio, "Valores previstos: %ld\n", resumo.valores);
+            fprintf(relatorio, "Tempo previsao: %f segundos\n", resumo.tempo);
+            if (resumo.tempo > 0)
+                fprintf(relatorio, "Vazao: %.1f milhoes de valores/s, %.2f GB/s (entrada + saida)\n",
+                        resumo.valores / resumo.tempo / 1e6,
+                        (resumo.bytesEntrada + resumo.bytesSaida) / resumo.tempo / 1e9);
+        }
+    } else {
+        prever_valores(A, B);
+    }
+    pool_destroi(&pool);  // Encerra as threads do pool
 
     // ==================== LIMPEZA DE MEMÓRIA ====================
-    free(X);        // Libera array de valores X
-    free(Y);        // Libera array de valores Y  
+    if (usaBinario) {
+        libera_binario(X, N);  // Desfaz o mapeamento do arquivo binário
+    } else {
+        colunas_libera(X);  // Libera as colunas X e Y (memoria_colunas.h)
+    }
     free(parciais); // Libera array de resultados parciais
+    free(estendidos);
+    free(momentosBloco);
+    free(erroBloco);
+    instr_libera(&instr);
+    if (numReamostras > 0)
+        bootstrap_libera(&boot);
     
-    return 0;
+    return erroPrevisao || erroModelo || erroBootstrap;
 }
@@ -0,0 +1,155 @@
+#define _GNU_SOURCE  // pthread_setaffinity_np (topologia.h, via pool_threads.h)
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <string.h>
+#include "timer.h"
+#include "leitor_csv.h"
+#include "pool_threads.h"
+#include "nucleos_simd.h"
+#include "regressao_multipla.h"
+
+// Regressão linear múltipla: o CSV tem cabeçalho e p+1 colunas (x1,...,xp,y).
+// Com duas colunas o resultado é o mesmo A/B de regressao-linear-mse.c.
+
+// ==================== MODO DE PREVISÃO (REPL) ====================
+// Lê os p valores de x separados por vírgula ou espaço e mostra o y previsto
+void prever_valores(const double *beta, int p) {
+    char entrada[4096];
+
+    printf("\n=== MODO DE PREVISAO ===\n");
+    printf("Digite os %d valores de X separados por virgula (ou 'q' para sair)\n", p);
+
+    while (1) {
+        printf("X = ");
+        if (!fgets(entrada, sizeof(entrada), stdin))
+            break;
+        if (entrada[0] == 'q' || entrada[0] == 'Q')
+            break;
+
+        char *p_atual = entrada, *fimNumero;
+        double y_prev = beta[0];
+        int lidos = 0;
+        while (lidos < p) {
+            double x = strtod(p_atual, &fimNumero);
+            if (fimNumero == p_atual)
+                break;
+            y_prev += beta[lidos + 1] * x;
+            lidos++;
+            p_atual = fimNumero;
+            while (*p_atual == ',' || *p_atual == ' ' || *p_atual == '\t')
+                p_atual++;
+        }
+
+        if (lidos == p)
+            printf("-> Y previsto = %.6f\n", y_prev);
+        else
+            printf("Entrada invalida. Digite %d numeros ou 'q' para sair.\n", p);
+    }
+    printf("Saindo do modo de previsao.\n");
+}
+
+// ==================== PROGRAMA PRINCIPAL ====================
+int main(int argc, char *argv[]) {
+    double inicio, fim, inicio_total, fim_total;
+    double tempoCentro, tempoGram, tempoSolucao, tempoMse;
+
+    if (argc < 3) {
+        printf("Uso: %s <arquivo.csv> <num_threads>\n", argv[0]);
+        printf("O arquivo deve ter cabecalho e as colunas x1,...,xp,y\n");
+        return 1;
+    }
+
+    char *nomeArquivo = argv[1];
+    int numThreads = atoi(argv[2]);
+    if (numThreads < 1)
+        numThreads = 1;
+
+    GET_TIME(inicio_total);
+    nucleos_seleciona();
+
+    // ==================== LEITURA DO ARQUIVO ====================
+    double *dados;
+    int numColunas;
+    long N = carrega_csv_colunas(nomeArquivo, numThreads, &dados, &numColunas);
+    if (N < 0)
+        return 1;
+    if (numColunas < 2 || N < numColunas) {
+        fprintf(stderr, "Erro: sao necessarias ao menos 2 colunas e mais linhas que colunas\n");
+        free(dados);
+        return 1;
+    }
+    int p = numColunas - 1;
+
+    PoolThreads pool;
+    RegressaoMultipla r;
+    if (pool_inicializa(&pool, numThreads) != 0) {
+        fprintf(stderr, "Erro ao alocar memória\n");
+        free(dados);
+        return 1;
+    }
+    if (multipla_inicializa(&r, dados, N, p, numThreads) != 0) {
+        fprintf(stderr, "Erro ao alocar memória\n");
+        multipla_libera(&r);
+        pool_destroi(&pool);
+        free(dados);
+        return 1;
+    }
+
+    // ==================== FASES DA REGRESSÃO ====================
+    GET_TIME(inicio);
+    multipla_fase_centro(&r, &pool);
+    GET_TIME(fim);
+    tempoCentro = fim - inicio;
+
+    GET_TIME(inicio);
+    multipla_fase_gram(&r, &pool);
+    GET_TIME(fim);
+    tempoGram = fim - inicio;
+
+    GET_TIME(inicio);
+    int resolvido = multipla_resolve(&r);
+    GET_TIME(fim);
+    tempoSolucao = fim - inicio;
+
+    if (resolvido != 0) {
+        fprintf(stderr, "Erro: X'X nao e definida positiva (coluna constante ou colunas colineares)\n");
+        multipla_libera(&r);
+        pool_destroi(&pool);
+        free(dados);
+        return 1;
+    }
+
+    GET_TIME(inicio);
+    double MSE = multipla_fase_mse(&r, &pool);
+    GET_TIME(fim);
+    tempoMse = fim - inicio;
+
+    GET_TIME(fim_total);
+    pool_destroi(&pool);
+
+    // ==================== RESULTADOS ====================
+    printf("\n=== RESULTADOS ===\n");
+    printf("Numero de pontos: %ld\n", N);
+    printf("Numero de variaveis (p): %d\n", p);
+    printf("Threads usadas: %d\n", numThreads);
+    printf("Nucleo de calculo: %s\n", nucleo_nome);
+    printf("b0 (intercepto): %.6f\n", r.beta[0]);
+    for (int j = 1; j <= p; j++)
+        printf("b%d: %.6f\n", j, r.beta[j]);
+    printf("MSE (Erro Quadratico Medio): %.6f\n", MSE);
+
+    printf("\n=== TEMPOS DE EXECUCAO ===\n");
+    printf("Tempo medias: %f segundos\n", tempoCentro);
+    printf("Tempo matriz de Gram: %f segundos\n", tempoGram);
+    printf("Tempo Cholesky: %f segundos\n", tempoSolucao);
+    printf("Tempo MSE: %f segundos\n", tempoMse);
+    printf("Tempo regressao: %f segundos\n", tempoCentro + tempoGram + tempoSolucao + tempoMse);
+    printf("Tempo total programa: %f segundos\n", fim_total - inicio_total);
+
+    prever_valores(r.beta, p);
+
+    multipla_libera(&r);
+    free(dados);
+    return 0;
+}
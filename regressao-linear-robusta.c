@@ -0,0 +1,220 @@
+/* File:     regressao-linear-robusta.c
+ *
+ * Purpose:  Regressão linear simples robusta a outliers: Theil-Sen (mediana
+ *           das inclinações de pares sorteados) e RANSAC (retas candidatas
+ *           pontuadas por inliers), ao lado dos mínimos quadrados para
+ *           comparação. Ver regressao_robusta.h.
+ *
+ *           A leitura é a mesma dos outros programas (CSV pelo leitor_csv.h
+ *           ou binário f64 mapeado), e todas as fases rodam no mesmo pool de
+ *           threads. Com a mesma semente os resultados são os mesmos para
+ *           qualquer número de threads.
+ *
+ *           Opções:
+ *             --pares M         pares do Theil-Sen (padrão N; todos se N(N-1)/2 <= M)
+ *             --candidatos K    retas candidatas do RANSAC (padrão ROBUSTA_CANDIDATOS)
+ *             --limiar T        |resíduo| máximo de um inlier (padrão 3 escalas do Theil-Sen)
+ *             --semente S       semente dos sorteios (padrão 1)
+ *             --mmap            converte o CSV direto do arquivo mapeado
+ *
+ * Compile:  gcc -O3 -march=native -o regressao-linear-robusta regressao-linear-robusta.c -lpthread -lm
+ * Usage:    ./regressao-linear-robusta <arquivo.csv|arquivo.bin> <num_threads> [opções]
+ */
+#define _GNU_SOURCE  // sched_getaffinity e CPU_SET (pool_threads.h)
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "timer.h"
+#include "leitor_csv.h"
+#include "formato_binario.h"
+#include "estatisticas.h"
+#include "regressao_robusta.h"
+
+#define ROBUSTA_CANDIDATOS 256     // Padrão de --candidatos
+#define ROBUSTA_LIMIAR_ESCALAS 3.0 // Limiar padrão, em escalas robustas
+
+// ==================== MÍNIMOS QUADRADOS ====================
+typedef struct {
+    const double *X, *Y;
+    Momentos *momentos;     // Um por pedaço
+    double *sse;
+} ContextoMinimos;
+
+static void minimos_pedaco(long inicio, long fim, long pedaco, void *contexto) {
+    ContextoMinimos *c = (ContextoMinimos *)contexto;
+    Momentos *m = &c->momentos[pedaco];
+    momentos_bloco(c->X + inicio, c->Y + inicio, fim - inicio, m);
+    c->sse[pedaco] = momentos_sse_bloco(c->X + inicio, c->Y + inicio, fim - inicio, m);
+}
+
+// Reta de mínimos quadrados e MSE, com os momentos de cada pedaço combinados em ordem
+static int minimos_quadrados(PoolThreads *pool, const double *X, const double *Y, long N,
+                             double *A, double *B, double *MSE) {
+    long numPedacos = (N + ROBUSTA_PEDACO - 1) / ROBUSTA_PEDACO;
+    ContextoMinimos c = {X, Y, malloc(numPedacos * sizeof(Momentos)), malloc(numPedacos * sizeof(double))};
+    if (!c.momentos || !c.sse) {
+        free(c.momentos);
+        free(c.sse);
+        return -1;
+    }
+    pool_executa_pedacos(pool, N, ROBUSTA_PEDACO, minimos_pedaco, &c);
+
+    Momentos total = {0};
+    double sse = 0;
+    for (long k = 0; k < numPedacos; k++)
+        momentos_combina_sse(&total, &sse, &c.momentos[k], c.sse[k]);
+    momentos_coeficientes(&total, A, B);
+    *MSE = sse / N;
+    free(c.momentos);
+    free(c.sse);
+    return 0;
+}
+
+// MSE de uma reta qualquer (em pedaços, reduzidos em ordem)
+typedef struct {
+    const double *X, *Y;
+    double A, B;
+    double *sse;
+} ContextoErro;
+
+static void erro_pedaco(long inicio, long fim, long pedaco, void *contexto) {
+    ContextoErro *c = (ContextoErro *)contexto;
+    c->sse[pedaco] = nucleo_erro(c->X + inicio, c->Y + inicio, fim - inicio, c->A, c->B);
+}
+
+static double erro_medio(PoolThreads *pool, const double *X, const double *Y, long N, double A, double B) {
+    long numPedacos = (N + ROBUSTA_PEDACO - 1) / ROBUSTA_PEDACO;
+    ContextoErro c = {X, Y, A, B, malloc(numPedacos * sizeof(double))};
+    if (!c.sse)
+        return NAN;
+    pool_executa_pedacos(pool, N, ROBUSTA_PEDACO, erro_pedaco, &c);
+    double sse = 0;
+    for (long k = 0; k < numPedacos; k++)
+        sse += c.sse[k];
+    free(c.sse);
+    return sse / N;
+}
+
+// =========================== FUNÇÃO PRINCIPAL ===========================
+int main(int argc, char *argv[]) {
+    double inicio_total, fim_total, fim_leitura, inicio, fim;
+
+    if (argc < 3) {
+        printf("Uso: %s <arquivo.csv|arquivo.bin> <num_threads> [--pares M] [--candidatos K]\n"
+               "          [--limiar T] [--semente S] [--mmap]\n", argv[0]);
+        return 1;
+    }
+
+    char *nomeArquivo = argv[1];
+    int numThreads = atoi(argv[2]);
+    if (numThreads < 1)
+        numThreads = 1;
+
+    long maxPares = 0;          // 0: N pares
+    int numCandidatos = ROBUSTA_CANDIDATOS;
+    double limiar = 0;          // 0: ROBUSTA_LIMIAR_ESCALAS escalas do Theil-Sen
+    uint64_t semente = 1;
+    int usaMmap = 0;
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--pares") == 0 && i + 1 < argc) {
+            maxPares = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--candidatos") == 0 && i + 1 < argc) {
+            numCandidatos = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--limiar") == 0 && i + 1 < argc) {
+            limiar = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) {
+            semente = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--mmap") == 0) {
+            usaMmap = 1;
+        } else {
+            fprintf(stderr, "Opcao desconhecida: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (numCandidatos < 1)
+        numCandidatos = 1;
+
+    GET_TIME(inicio_total);
+    nucleos_seleciona();
+
+    // ==================== LEITURA ====================
+    double *X, *Y;
+    long N;
+    int usaBinario = eh_arquivo_binario(nomeArquivo);
+    if (usaBinario)
+        N = carrega_binario(nomeArquivo, &X, &Y, NULL);
+    else if (usaMmap)
+        N = carrega_csv_mmap(nomeArquivo, numThreads, &X, &Y);
+    else
+        N = carrega_csv_paralelo(nomeArquivo, numThreads, &X, &Y);
+    if (N < 0)
+        return 1;
+    if (N < 2) {
+        fprintf(stderr, "Erro: sao necessarios ao menos 2 pontos\n");
+        return 1;
+    }
+    if (maxPares < 1)
+        maxPares = N;
+    GET_TIME(fim_leitura);
+
+    // ==================== CÁLCULO ====================
+    PoolThreads pool;
+    if (pool_inicializa(&pool, numThreads) != 0) {
+        fprintf(stderr, "Erro ao alocar memória\n");
+        return 1;
+    }
+    int erro = 0;
+
+    double A = 0, B = 0, MSE = 0;
+    GET_TIME(inicio);
+    erro |= minimos_quadrados(&pool, X, Y, N, &A, &B, &MSE);
+    GET_TIME(fim);
+    double tempoMinimos = fim - inicio;
+
+    ResultadoTheilSen ts = {0};
+    erro |= theil_sen(&pool, X, Y, N, maxPares, semente, &ts);
+    if (limiar <= 0)
+        limiar = ROBUSTA_LIMIAR_ESCALAS * ts.escala;
+
+    ResultadoRansac rs = {0};
+    erro |= ransac(&pool, X, Y, N, numCandidatos, limiar, semente, &rs);
+    if (erro) {
+        fprintf(stderr, "Erro ao alocar memória\n");
+        pool_destroi(&pool);
+        return 1;
+    }
+    double mseTheilSen = erro_medio(&pool, X, Y, N, ts.A, ts.B);
+    double mseRansac = erro_medio(&pool, X, Y, N, rs.A, rs.B);
+    GET_TIME(fim_total);
+
+    // ==================== EXIBIÇÃO DOS RESULTADOS ====================
+    printf("\n=== RESULTADOS ===\n");
+    printf("Numero de pontos: %ld\n", N);
+    printf("Threads usadas: %d\n", numThreads);
+    printf("Nucleo de calculo: %s\n", nucleo_nome);
+    printf("Minimos quadrados: A = %.6f, B = %.6f, MSE = %.6f\n", A, B, MSE);
+    printf("Theil-Sen (%ld pares%s): A = %.6f, B = %.6f, MSE = %.6f\n", ts.pares,
+           ts.exato ? ", todos" : " sorteados", ts.A, ts.B, mseTheilSen);
+    printf("Escala robusta dos residuos (1.4826 MAD): %.6f\n", ts.escala);
+    printf("RANSAC (%d candidatas, %d finalistas, limiar %.6f): A = %.6f, B = %.6f, MSE = %.6f\n",
+           rs.candidatos, rs.finalistas, rs.limiar, rs.A, rs.B, mseRansac);
+    printf("Inliers do RANSAC: %ld (%.2f%%)\n", rs.inliers, 100.0 * rs.inliers / N);
+
+    printf("\n=== TEMPOS DE EXECUCAO ===\n");
+    printf("Tempo leitura: %f segundos\n", fim_leitura - inicio_total);
+    printf("Tempo minimos quadrados: %f segundos\n", tempoMinimos);
+    printf("Tempo Theil-Sen inclinacoes: %f segundos\n", ts.tempoInclinacoes);
+    printf("Tempo Theil-Sen medianas: %f segundos\n", ts.tempoMedianas);
+    printf("Tempo RANSAC candidatas: %f segundos\n", rs.tempoCandidatos);
+    printf("Tempo RANSAC finalistas: %f segundos\n", rs.tempoFinalistas);
+    printf("Tempo RANSAC reajuste: %f segundos\n", rs.tempoAjuste);
+    printf("Tempo total programa: %f segundos\n", fim_total - inicio_total);
+
+    // ==================== LIMPEZA DE MEMÓRIA ====================
+    pool_destroi(&pool);
+    if (usaBinario)
+        libera_binario(X, N);
+    else
+        colunas_libera(X);
+    return 0;
+}
@@ -0,0 +1,294 @@
+/* File:     regressao_multipla.h
+ *
+ * Purpose:  Regressão linear múltipla y = b0 + b1*x1 + ... + bp*xp pelas
+ *           equações normais, com as fases paralelas no pool de threads.
+ *
+ *           Os dados são uma matriz N x (p+1) em ordem de linha (x1..xp, y).
+ *           Três fases, todas com a mesma partição de linhas por thread:
+ *             1. centro: média de cada coluna (deslocamento c);
+ *             2. Gram:   cada thread empacota blocos de linhas já deslocadas
+ *                        [x - c, y - c_y, 1] em um buffer alinhado (ld colunas,
+ *                        zeros no preenchimento) e acumula G += BᵀB com o
+ *                        nucleo_gram (ladrilhos SIMD). As matrizes de cada
+ *                        thread são somadas em ordem fixa;
+ *             3. MSE:    resíduos com os coeficientes finais.
+ *
+ *           A coluna de uns dá n e as somas dos desvios, e com elas os
+ *           momentos exatos (mesma correção de momentos_bloco):
+ *             S_jk = G_jk - s_j*s_k/n
+ *           O sistema S_xx b = S_xy é resolvido por Cholesky, e
+ *           b0 = ȳ - Σ b_j x̄_j. Trabalhar com os dados centrados evita a
+ *           perda de precisão de XᵀX bruto quando os x são grandes.
+ *
+ * Exemplo:
+ *    RegressaoMultipla r;
+ *    multipla_inicializa(&r, dados, N, p, numThreads);
+ *    multipla_fase_centro(&r, &pool);
+ *    multipla_fase_gram(&r, &pool);
+ *    if (multipla_resolve(&r) == 0)
+ *        mse = multipla_fase_mse(&r, &pool);   // r.beta[0..p]
+ *    multipla_libera(&r);
+ */
+#ifndef _REGRESSAO_MULTIPLA_H_
+#define _REGRESSAO_MULTIPLA_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "pool_threads.h"
+#include "nucleos_simd.h"
+
+#define MULTIPLA_LINHA_CACHE 64
+#define MULTIPLA_BYTES_BLOCO (128 * 1024)  // Buffer empacotado de cada thread (cabe na L2)
+
+typedef struct {
+    const double *dados;  // N linhas de p+1 colunas: x1..xp, y
+    long N;
+    int p;
+    int ld;               // Colunas empacotadas: p+2 arredondado para múltiplo de 8
+    int numThreads;
+    long linhasBloco;     // Linhas por bloco empacotado
+    double *centro;       // Deslocamento de cada coluna (p+1)
+    double *somas;        // Somas de cada thread na fase 1 (numThreads x ld)
+    double *gram;         // G de cada thread (numThreads x ld x ld)
+    double *blocos;       // Buffer empacotado de cada thread (numThreads x linhasBloco x ld)
+    double *erros;        // SSE de cada thread, uma linha de cache por thread
+    double *G;            // Soma das matrizes de todas as threads (ld x ld)
+    double *beta;         // Coeficientes: beta[0] = intercepto, beta[j] de x_j
+} RegressaoMultipla;
+
+// Argumento de cada parte das fases
+typedef struct {
+    RegressaoMultipla *r;
+    long id;
+} ArgsMultipla;
+
+static inline void *multipla_aloca(size_t bytes) {
+    size_t tam = (bytes + MULTIPLA_LINHA_CACHE - 1) / MULTIPLA_LINHA_CACHE * MULTIPLA_LINHA_CACHE;
+    void *p = aligned_alloc(MULTIPLA_LINHA_CACHE, tam ? tam : MULTIPLA_LINHA_CACHE);
+    if (p)
+        memset(p, 0, tam);
+    return p;
+}
+
+// Linhas [inicio, fim) da thread id (a última fica com o resto, como em calcula_somas)
+static inline void multipla_faixa(const RegressaoMultipla *r, long id, long *inicio, long *fim) {
+    long porThread = r->N / r->numThreads;
+    *inicio = id * porThread;
+    *fim = (id == r->numThreads - 1) ? r->N : *inicio + porThread;
+}
+
+// Retorna 0 em sucesso ou -1 se faltar memória
+static inline int multipla_inicializa(RegressaoMultipla *r, const double *dados, long N, int p, int numThreads) {
+    r->dados = dados;
+    r->N = N;
+    r->p = p;
+    r->ld = (p + 2 + 7) / 8 * 8;
+    r->numThreads = (numThreads > 0) ? numThreads : 1;
+    r->linhasBloco = MULTIPLA_BYTES_BLOCO / (r->ld * (long)sizeof(double));
+    if (r->linhasBloco < 8)
+        r->linhasBloco = 8;
+
+    long ld = r->ld, T = r->numThreads;
+    r->centro = multipla_aloca((p + 1) * sizeof(double));
+    r->somas  = multipla_aloca(T * ld * sizeof(double));
+    r->gram   = multipla_aloca(T * ld * ld * sizeof(double));
+    r->blocos = multipla_aloca(T * r->linhasBloco * ld * sizeof(double));
+    r->erros  = multipla_aloca(T * MULTIPLA_LINHA_CACHE);
+    r->G      = multipla_aloca(ld * ld * sizeof(double));
+    r->beta   = multipla_aloca((p + 1) * sizeof(double));
+    if (!r->centro || !r->somas || !r->gram || !r->blocos || !r->erros || !r->G || !r->beta)
+        return -1;
+    return 0;
+}
+
+static inline void multipla_libera(RegressaoMultipla *r) {
+    free(r->centro); free(r->somas); free(r->gram); free(r->blocos);
+    free(r->erros); free(r->G); free(r->beta);
+}
+
+// ==================== FASE 1: CENTRO DE CADA COLUNA ====================
+static inline void *multipla_centro(void *arg) {
+    ArgsMultipla *args = (ArgsMultipla *)arg;
+    RegressaoMultipla *r = args->r;
+    int m = r->p + 1;
+    double *soma = r->somas + args->id * r->ld;
+    long inicio, fim;
+
+    multipla_faixa(r, args->id, &inicio, &fim);
+    for (long i = inicio; i < fim; i++) {
+        const double *linha = r->dados + i * m;
+        for (int j = 0; j < m; j++)
+            soma[j] += linha[j];
+    }
+    return NULL;
+}
+
+static inline void multipla_fase_centro(RegressaoMultipla *r, PoolThreads *pool) {
+    ArgsMultipla args[r->numThreads];
+    int m = r->p + 1;
+
+    memset(r->somas, 0, r->numThreads * r->ld * sizeof(double));
+    for (long t = 0; t < r->numThreads; t++) {
+        args[t].r = r;
+        args[t].id = t;
+    }
+    pool_executa(pool, r->N * m, multipla_centro, args, sizeof(ArgsMultipla));
+
+    for (int j = 0; j < m; j++) {
+        double total = 0.0;
+        for (int t = 0; t < r->numThreads; t++)
+            total += r->somas[t * r->ld + j];
+        r->centro[j] = (r->N > 0) ? total / r->N : 0.0;
+    }
+}
+
+// ==================== FASE 2: MATRIZ DE GRAM ====================
+static inline void *multipla_gram(void *arg) {
+    ArgsMultipla *args = (ArgsMultipla *)arg;
+    RegressaoMultipla *r = args->r;
+    int m = r->p + 1, ld = r->ld;
+    double *G = r->gram + args->id * ld * ld;
+    double *bloco = r->blocos + args->id * r->linhasBloco * ld;
+    long inicio, fim;
+
+    memset(G, 0, ld * ld * sizeof(double));
+    multipla_faixa(r, args->id, &inicio, &fim);
+    for (long i0 = inicio; i0 < fim; i0 += r->linhasBloco) {
+        long linhas = (fim - i0 < r->linhasBloco) ? fim - i0 : r->linhasBloco;
+
+        // Empacota: [x1-c1 .. xp-cp, y-cy, 1, 0...] (o preenchimento continua zero)
+        for (long i = 0; i < linhas; i++) {
+            const double *linha = r->dados + (i0 + i) * m;
+            double *destino = bloco + i * ld;
+            for (int j = 0; j < m; j++)
+                destino[j] = linha[j] - r->centro[j];
+            destino[m] = 1.0;
+        }
+        nucleo_gram(bloco, linhas, ld, G);
+    }
+    return NULL;
+}
+
+static inline void multipla_fase_gram(RegressaoMultipla *r, PoolThreads *pool) {
+    ArgsMultipla args[r->numThreads];
+    int ld = r->ld, m = r->p + 1;
+
+    for (long t = 0; t < r->numThreads; t++) {
+        args[t].r = r;
+        args[t].id = t;
+    }
+    pool_executa(pool, r->N * m, multipla_gram, args, sizeof(ArgsMultipla));
+
+    // Soma as matrizes das threads sempre na mesma ordem (só o triângulo superior)
+    memset(r->G, 0, ld * ld * sizeof(double));
+    for (int t = 0; t < r->numThreads; t++) {
+        const double *Gt = r->gram + (long)t * ld * ld;
+        for (int j = 0; j <= m; j++)
+            for (int k = j; k <= m; k++)
+                r->G[j * ld + k] += Gt[j * ld + k];
+    }
+}
+
+// ==================== SOLUÇÃO POR CHOLESKY ====================
+// Resolve S_xx b = S_xy. Retorna 0 ou -1 se S_xx não for definida positiva
+// (colunas constantes ou colineares)
+static inline int multipla_resolve(RegressaoMultipla *r) {
+    int p = r->p, ld = r->ld, uns = p + 1;
+    const double *G = r->G;
+    double n = G[uns * ld + uns];
+    double *L = malloc((size_t)p * p * sizeof(double));
+    double *b = malloc((p + 1) * sizeof(double));
+
+    if (!L || !b || n <= 0) {
+        free(L); free(b);
+        return -1;
+    }
+
+    // Momentos centrados exatos: S_jk = G_jk - s_j*s_k/n (só o triângulo inferior de L)
+    for (int j = 0; j < p; j++) {
+        for (int k = 0; k <= j; k++)
+            L[j * p + k] = G[k * ld + j] - G[k * ld + uns] * G[j * ld + uns] / n;
+        b[j] = G[j * ld + p] - G[j * ld + uns] * G[p * ld + uns] / n;
+    }
+
+    // Fatoração S_xx = L Lᵀ
+    for (int j = 0; j < p; j++) {
+        double d = L[j * p + j];
+        for (int k = 0; k < j; k++)
+            d -= L[j * p + k] * L[j * p + k];
+        // Pivô que sumiu em relação a S_jj: coluna constante ou combinação das anteriores
+        if (!(d > 1e-12 * L[j * p + j])) {
+            free(L); free(b);
+            return -1;
+        }
+        L[j * p + j] = sqrt(d);
+        for (int i = j + 1; i < p; i++) {
+            double s = L[i * p + j];
+            for (int k = 0; k < j; k++)
+                s -= L[i * p + k] * L[j * p + k];
+            L[i * p + j] = s / L[j * p + j];
+        }
+    }
+
+    // L z = S_xy, depois Lᵀ b = z
+    for (int i = 0; i < p; i++) {
+        for (int k = 0; k < i; k++)
+            b[i] -= L[i * p + k] * b[k];
+        b[i] /= L[i * p + i];
+    }
+    for (int i = p - 1; i >= 0; i--) {
+        for (int k = i + 1; k < p; k++)
+            b[i] -= L[k * p + i] * b[k];
+        b[i] /= L[i * p + i];
+    }
+
+    // Intercepto pelas médias exatas: média_j = c_j + s_j/n
+    double intercepto = r->centro[p] + G[p * ld + uns] / n;
+    for (int j = 0; j < p; j++) {
+        r->beta[j + 1] = b[j];
+        intercepto -= b[j] * (r->centro[j] + G[j * ld + uns] / n);
+    }
+    r->beta[0] = intercepto;
+
+    free(L);
+    free(b);
+    return 0;
+}
+
+// ==================== FASE 3: MSE ====================
+static inline void *multipla_mse(void *arg) {
+    ArgsMultipla *args = (ArgsMultipla *)arg;
+    RegressaoMultipla *r = args->r;
+    int p = r->p;
+    long inicio, fim;
+    double sse = 0.0;
+
+    multipla_faixa(r, args->id, &inicio, &fim);
+    for (long i = inicio; i < fim; i++) {
+        const double *linha = r->dados + i * (p + 1);
+        double previsto = r->beta[0];
+        for (int j = 0; j < p; j++)
+            previsto += r->beta[j + 1] * linha[j];
+        double erro = linha[p] - previsto;
+        sse += erro * erro;
+    }
+    r->erros[args->id * (MULTIPLA_LINHA_CACHE / sizeof(double))] = sse;
+    return NULL;
+}
+
+static inline double multipla_fase_mse(RegressaoMultipla *r, PoolThreads *pool) {
+    ArgsMultipla args[r->numThreads];
+    double sse = 0.0;
+
+    for (long t = 0; t < r->numThreads; t++) {
+        args[t].r = r;
+        args[t].id = t;
+    }
+    pool_executa(pool, r->N * (r->p + 1), multipla_mse, args, sizeof(ArgsMultipla));
+    for (int t = 0; t < r->numThreads; t++)
+        sse += r->erros[t * (MULTIPLA_LINHA_CACHE / sizeof(double))];
+    return (r->N > 0) ? sse / r->N : 0.0;
+}
+
+#endif
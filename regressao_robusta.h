@@ -0,0 +1,528 @@
+/* File:     regressao_robusta.h
+ *
+ * Purpose:  Estimadores robustos da reta y = A + B·x, que não se deixam
+ *           puxar por uma fração de pontos muito fora (outliers), com as
+ *           fases paralelas no pool de threads e sobre as mesmas colunas X/Y
+ *           já carregadas pelos outros programas.
+ *
+ *           Theil-Sen: B é a mediana das inclinações (y_j - y_i)/(x_j - x_i)
+ *           dos pares de pontos, e A a mediana de y - B·x. Com N grande os
+ *           N(N-1)/2 pares são inviáveis; são sorteados M pares (padrão N)
+ *           com os números baseados em contador de aleatorio.h, então cada
+ *           pedaço gera suas inclinações sem estado compartilhado e o
+ *           resultado não depende do número de threads. Se N(N-1)/2 <= M, usa
+ *           todos os pares (Theil-Sen exato). Pares com x_i = x_j são
+ *           sorteados de novo (até ROBUSTA_TENTATIVAS vezes).
+ *
+ *           A mediana de um vetor grande não o ordena: uma amostra pequena
+ *           (ordenada) dá uma faixa [lo, hi] que contém a mediana com folga;
+ *           uma passada paralela conta quantos valores ficam abaixo, dentro
+ *           e acima, e outra copia só os de dentro (em geral menos de 5%)
+ *           para o quickselect. Se a faixa errar (muito raro) a seleção
+ *           repete com a faixa inteira. Valores NaN ficam de fora.
+ *
+ *           RANSAC: K retas candidatas, cada uma pelos dois pontos de um par
+ *           sorteado, pontuadas pelo número de inliers (|resíduo| <= limiar)
+ *           com o nucleo_inliers (SIMD). Pontuar as K retas nos N pontos
+ *           custaria K passadas; todas são pontuadas primeiro em uma
+ *           subamostra de ROBUSTA_SUBAMOSTRA pontos e só as
+ *           ROBUSTA_FINALISTAS melhores em todos os pontos. A vencedora é
+ *           reajustada por mínimos quadrados nos seus inliers
+ *           (nucleo_somas_inliers, desvios em relação à própria reta).
+ *           O limiar padrão é 3 escalas robustas dos resíduos do Theil-Sen
+ *           (1.4826·MAD, que é o desvio padrão quando o ruído é normal).
+ *
+ *           Como nos outros programas, cada pedaço escreve em uma posição
+ *           própria e as reduções são feitas em ordem de pedaço.
+ *
+ * Exemplo:
+ *    ResultadoTheilSen ts;
+ *    if (theil_sen(&pool, X, Y, N, maxPares, semente, &ts) != 0) . . .
+ *    ResultadoRansac rs;
+ *    if (ransac(&pool, X, Y, N, numCandidatos, 3 * ts.escala, semente, &rs) != 0) . . .
+ */
+#ifndef _REGRESSAO_ROBUSTA_H_
+#define _REGRESSAO_ROBUSTA_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "timer.h"
+#include "aleatorio.h"
+#include "pool_threads.h"
+#include "nucleos_simd.h"
+
+#define ROBUSTA_PEDACO 16384            // Elementos por pedaço das fases paralelas
+#define ROBUSTA_PEDACO_SUBAMOSTRA 4096  // Pontos por pedaço na pontuação preliminar
+#define ROBUSTA_TENTATIVAS 16           // Sorteios de um par até x_i != x_j
+#define ROBUSTA_AMOSTRA_MEDIANA 16384   // Valores da amostra que delimita a mediana
+#define ROBUSTA_FOLGA_MEDIANA 3.0       // Meia largura da faixa, em √amostra posições
+#define ROBUSTA_COPIA_LOCAL 256         // Buffer de cada pedaço na cópia da faixa
+#define ROBUSTA_SUBAMOSTRA 65536        // Pontos da pontuação preliminar do RANSAC
+#define ROBUSTA_FINALISTAS 8            // Candidatas pontuadas em todos os pontos
+#define ROBUSTA_ESCALA_MAD 1.482602218505602  // 1/Φ⁻¹(3/4): MAD -> desvio padrão
+
+// Sequências de aleatorio.h de cada sorteio (a partir da semente do usuário)
+#define ROBUSTA_FLUXO_PARES      0
+#define ROBUSTA_FLUXO_MEDIANA    1
+#define ROBUSTA_FLUXO_SUBAMOSTRA 2
+#define ROBUSTA_FLUXO_CANDIDATOS 3
+
+typedef struct {
+    double A, B;
+    double escala;          // 1.4826·MAD dos resíduos y - (A + B·x)
+    long pares;             // Inclinações usadas (pares com x_i != x_j)
+    int exato;              // 1 se usou todos os N(N-1)/2 pares
+    double tempoInclinacoes, tempoMedianas;
+} ResultadoTheilSen;
+
+typedef struct {
+    double A, B;            // Reta reajustada nos inliers da melhor candidata
+    double limiar;
+    long inliers;           // Inliers da melhor candidata em todos os pontos
+    int candidatos, finalistas;
+    double tempoCandidatos, tempoFinalistas, tempoAjuste;
+} ResultadoRansac;
+
+// ==================== SORTEIO DE PARES ====================
+// u (64 bits uniformes) levado a [0, n) pela parte alta de u·n, sem a divisão de u % n
+static inline long robusta_intervalo(uint64_t u, long n) {
+    return (long)(((unsigned __int128)u * (uint64_t)n) >> 64);
+}
+
+// Par (i, j) número k, i != j e x_i != x_j. Retorna 0 se não achou um
+// em ROBUSTA_TENTATIVAS sorteios (x quase todo igual)
+static inline int robusta_sorteia_par(const double *X, long N, uint64_t semente, long k, long *pi, long *pj) {
+    for (long t = 0; t < ROBUSTA_TENTATIVAS; t++) {
+        uint64_t c = 2 * ((uint64_t)k * ROBUSTA_TENTATIVAS + t);
+        long i = robusta_intervalo(aleat_u64(semente, c), N);
+        long j = robusta_intervalo(aleat_u64(semente, c + 1), N - 1);
+        j += (j >= i);
+        if (X[i] != X[j]) {
+            *pi = i;
+            *pj = j;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Par (i, j > i) número k na enumeração de todos os pares, linha a linha
+static inline void robusta_par_exato(long N, long k, long *pi, long *pj) {
+    // A linha i começa no par i·N - i(i+1)/2
+    double d = 2.0 * N - 1;
+    long i = (long)((d - sqrt(d * d - 8.0 * k)) / 2);
+    if (i < 0)
+        i = 0;
+    while (i > 0 && i * N - i * (i + 1) / 2 > k)
+        i--;
+    while ((i + 1) * N - (i + 1) * (i + 2) / 2 <= k)
+        i++;
+    *pi = i;
+    *pj = i + 1 + (k - (i * N - i * (i + 1) / 2));
+}
+
+// ==================== MEDIANA POR SELEÇÃO ====================
+// Deixa em v[k] o valor de ordem k (v reordenado em volta) e o retorna.
+// Quickselect de Hoare com pivô mediana de três
+static inline double robusta_seleciona(double *v, long n, long k) {
+    long esq = 0, dir = n - 1;
+    while (dir > esq) {
+        double a = v[esq], b = v[esq + (dir - esq) / 2], c = v[dir];
+        double pivo = (a < b) ? ((b < c) ? b : (a < c) ? c : a)
+                              : ((a < c) ? a : (b < c) ? c : b);
+        long i = esq, j = dir;
+        while (i <= j) {
+            while (v[i] < pivo)
+                i++;
+            while (v[j] > pivo)
+                j--;
+            if (i <= j) {
+                double troca = v[i];
+                v[i++] = v[j];
+                v[j--] = troca;
+            }
+        }
+        if (k <= j)
+            dir = j;
+        else if (k >= i)
+            esq = i;
+        else
+            break;  // Entre j e i só há valores iguais ao pivô
+    }
+    return v[k];
+}
+
+static inline int robusta_compara(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+typedef struct {
+    const double *v;
+    double lo, hi;          // Faixa que deve conter a mediana
+    long *abaixo, *dentro, *acima;  // Contagens de cada pedaço
+    double *faixa;          // Valores de [lo, hi], pedaço k a partir de destino[k]
+    long *destino;
+} ContextoMediana;
+
+static inline void robusta_conta_faixa(long inicio, long fim, long pedaco, void *contexto) {
+    ContextoMediana *c = (ContextoMediana *)contexto;
+    long abaixo = 0, dentro = 0, acima = 0;
+    for (long i = inicio; i < fim; i++) {
+        double x = c->v[i];
+        abaixo += x < c->lo;
+        acima += x > c->hi;
+        dentro += (x >= c->lo) & (x <= c->hi);  // NaN não entra em nenhuma
+    }
+    c->abaixo[pedaco] = abaixo;
+    c->dentro[pedaco] = dentro;
+    c->acima[pedaco] = acima;
+}
+
+// Sem desvio condicional (que erraria a previsão a cada valor de dentro):
+// todo valor é escrito em um buffer local e só avança se estiver na faixa.
+// Escrever direto em faixa invadiria a primeira posição do pedaço seguinte
+static inline void robusta_copia_faixa(long inicio, long fim, long pedaco, void *contexto) {
+    ContextoMediana *c = (ContextoMediana *)contexto;
+    double *saida = c->faixa + c->destino[pedaco];
+    double local[ROBUSTA_COPIA_LOCAL + 1];
+    long usados = 0;
+    for (long i = inicio; i < fim; i++) {
+        double x = c->v[i];
+        local[usados] = x;
+        usados += (x >= c->lo) & (x <= c->hi);
+        if (usados == ROBUSTA_COPIA_LOCAL) {
+            memcpy(saida, local, usados * sizeof(double));
+            saida += usados;
+            usados = 0;
+        }
+    }
+    memcpy(saida, local, usados * sizeof(double));
+}
+
+// Mediana dos valores não NaN de v (média dos dois centrais se a quantidade
+// for par), em *mediana; *validos recebe a quantidade. v não é alterado.
+// Retorna 0 ou -1 (sem memória)
+static inline int robusta_mediana(PoolThreads *pool, const double *v, long n, uint64_t semente,
+                                  double *mediana, long *validos) {
+    long numPedacos = (n + ROBUSTA_PEDACO - 1) / ROBUSTA_PEDACO;
+    long tamAmostra = (n < ROBUSTA_AMOSTRA_MEDIANA) ? n : ROBUSTA_AMOSTRA_MEDIANA;
+    long *contagens = malloc(4 * (numPedacos + 1) * sizeof(long));
+    double *amostra = malloc((tamAmostra + 1) * sizeof(double));
+    if (!contagens || !amostra) {
+        free(contagens);
+        free(amostra);
+        return -1;
+    }
+    ContextoMediana c = {v, -INFINITY, INFINITY, contagens, contagens + numPedacos,
+                         contagens + 2 * numPedacos, NULL, contagens + 3 * numPedacos};
+
+    // Faixa pela amostra: a mediana da amostra fica a ~√m/2 posições da
+    // verdadeira; ROBUSTA_FOLGA_MEDIANA·√m cobre com muita folga
+    long m = 0;
+    if (tamAmostra < n) {
+        for (long s = 0; s < tamAmostra; s++) {
+            double x = v[aleat_u64(semente, s) % n];
+            if (x == x)
+                amostra[m++] = x;
+        }
+    }
+    if (m > 0) {
+        qsort(amostra, m, sizeof(double), robusta_compara);
+        long folga = (long)(ROBUSTA_FOLGA_MEDIANA * sqrt((double)m)) + 1;
+        if (m / 2 - folga >= 0)
+            c.lo = amostra[m / 2 - folga];
+        if (m / 2 + folga < m)
+            c.hi = amostra[m / 2 + folga];
+    }
+    free(amostra);
+
+    long abaixo, dentro, acima, k1, k2;
+    for (;;) {
+        pool_executa_pedacos(pool, n, ROBUSTA_PEDACO, robusta_conta_faixa, &c);
+        abaixo = dentro = acima = 0;
+        for (long k = 0; k < numPedacos; k++) {
+            c.destino[k] = dentro;
+            abaixo += c.abaixo[k];
+            dentro += c.dentro[k];
+            acima += c.acima[k];
+        }
+        *validos = abaixo + dentro + acima;
+        k1 = (*validos - 1) / 2;
+        k2 = *validos / 2;
+        if (*validos == 0 || (abaixo <= k1 && k2 < abaixo + dentro))
+            break;
+        c.lo = -INFINITY;  // A amostra errou a faixa: seleção sobre tudo
+        c.hi = INFINITY;
+    }
+    if (*validos == 0) {
+        free(contagens);
+        *mediana = NAN;
+        return 0;
+    }
+
+    c.faixa = malloc(dentro * sizeof(double));
+    if (!c.faixa) {
+        free(contagens);
+        return -1;
+    }
+    pool_executa_pedacos(pool, n, ROBUSTA_PEDACO, robusta_copia_faixa, &c);
+
+    double a = robusta_seleciona(c.faixa, dentro, k1 - abaixo);
+    double b = a;
+    if (k2 != k1) {  // O seguinte é o menor dos que ficaram à direita
+        b = c.faixa[k2 - abaixo];
+        for (long i = k2 - abaixo + 1; i < dentro; i++)
+            if (c.faixa[i] < b)
+                b = c.faixa[i];
+    }
+    *mediana = 0.5 * (a + b);
+    free(c.faixa);
+    free(contagens);
+    return 0;
+}
+
+// ==================== THEIL-SEN ====================
+typedef struct {
+    const double *X, *Y;
+    long N;
+    uint64_t semente;
+    int exato;
+    double B, A;
+    double *saida;          // Inclinações, depois resíduos
+} ContextoTheilSen;
+
+static inline void theil_sen_inclinacoes(long inicio, long fim, long pedaco, void *contexto) {
+    ContextoTheilSen *c = (ContextoTheilSen *)contexto;
+    (void)pedaco;
+    if (c->exato) {
+        long i, j;
+        robusta_par_exato(c->N, inicio, &i, &j);
+        for (long k = inicio; k < fim; k++) {
+            double dx = c->X[j] - c->X[i];
+            c->saida[k] = (dx != 0) ? (c->Y[j] - c->Y[i]) / dx : NAN;
+            if (++j == c->N) {
+                i++;
+                j = i + 1;
+            }
+        }
+        return;
+    }
+    for (long k = inicio; k < fim; k++) {
+        long i, j;
+        c->saida[k] = robusta_sorteia_par(c->X, c->N, c->semente, k, &i, &j)
+                      ? (c->Y[j] - c->Y[i]) / (c->X[j] - c->X[i]) : NAN;
+    }
+}
+
+// saida[i] = y_i - B·x_i
+static inline void theil_sen_residuos(long inicio, long fim, long pedaco, void *contexto) {
+    ContextoTheilSen *c = (ContextoTheilSen *)contexto;
+    (void)pedaco;
+    for (long i = inicio; i < fim; i++)
+        c->saida[i] = c->Y[i] - c->B * c->X[i];
+}
+
+// saida[i] = |saida[i] - A|
+static inline void theil_sen_desvios(long inicio, long fim, long pedaco, void *contexto) {
+    ContextoTheilSen *c = (ContextoTheilSen *)contexto;
+    (void)pedaco;
+    for (long i = inicio; i < fim; i++)
+        c->saida[i] = fabs(c->saida[i] - c->A);
+}
+
+// Theil-Sen com até maxPares pares (todos se couberem). Retorna 0 ou -1 (sem
+// memória ou N < 2)
+static inline int theil_sen(PoolThreads *pool, const double *X, const double *Y, long N, long maxPares,
+                            uint64_t semente, ResultadoTheilSen *r) {
+    if (N < 2)
+        return -1;
+    double todos = 0.5 * (double)N * (double)(N - 1);
+    long M = (todos <= (double)maxPares) ? (long)todos : maxPares;
+    double *saida = malloc((M > N ? M : N) * sizeof(double));  // Inclinações, depois resíduos
+    if (!saida)
+        return -1;
+    ContextoTheilSen c = {X, Y, N, aleat_u64(semente, ROBUSTA_FLUXO_PARES), todos <= (double)maxPares,
+                          0, 0, saida};
+    uint64_t sementeMediana = aleat_u64(semente, ROBUSTA_FLUXO_MEDIANA);
+    double inicio, meio, fim;
+    double desvio;
+    long validos;
+    int erro = 0;
+
+    GET_TIME(inicio);
+    pool_executa_pedacos(pool, M, ROBUSTA_PEDACO, theil_sen_inclinacoes, &c);
+    GET_TIME(meio);
+    erro |= robusta_mediana(pool, saida, M, sementeMediana, &c.B, &r->pares);
+    pool_executa_pedacos(pool, N, ROBUSTA_PEDACO, theil_sen_residuos, &c);
+    erro |= robusta_mediana(pool, saida, N, sementeMediana, &c.A, &validos);
+    pool_executa_pedacos(pool, N, ROBUSTA_PEDACO, theil_sen_desvios, &c);
+    erro |= robusta_mediana(pool, saida, N, sementeMediana, &desvio, &validos);
+    GET_TIME(fim);
+    free(saida);
+
+    r->A = c.A;
+    r->B = c.B;
+    r->escala = ROBUSTA_ESCALA_MAD * desvio;
+    r->exato = c.exato;
+    r->tempoInclinacoes = meio - inicio;
+    r->tempoMedianas = fim - meio;
+    return erro ? -1 : 0;
+}
+
+// ==================== RANSAC ====================
+typedef struct {
+    const double *vx, *vy;
+    const double *A, *B;    // Retas sendo pontuadas
+    int numRetas;
+    double limiar;
+    long *contagens;        // numRetas por pedaço
+    double cx;              // Centro de x no reajuste
+    double *somas;          // 5 por pedaço no reajuste
+} ContextoRansac;
+
+static inline void ransac_conta_pedaco(long inicio, long fim, long pedaco, void *contexto) {
+    ContextoRansac *c = (ContextoRansac *)contexto;
+    long *contagem = c->contagens + pedaco * c->numRetas;
+    memset(contagem, 0, c->numRetas * sizeof(long));
+    nucleo_inliers(c->vx + inicio, c->vy + inicio, fim - inicio, c->A, c->B, c->numRetas,
+                   c->limiar, contagem);
+}
+
+static inline void ransac_somas_pedaco(long inicio, long fim, long pedaco, void *contexto) {
+    ContextoRansac *c = (ContextoRansac *)contexto;
+    nucleo_somas_inliers(c->vx + inicio, c->vy + inicio, fim - inicio, c->A[0], c->B[0],
+                         c->limiar, c->cx, c->somas + 5 * pedaco);
+}
+
+// Inliers de cada uma das numRetas retas em n pontos, em contagem[]. Retorna 0 ou -1
+static inline int ransac_pontua(PoolThreads *pool, const double *vx, const double *vy, long n, long tamPedaco,
+                                const double *A, const double *B, int numRetas, double limiar, long *contagem) {
+    long numPedacos = (n + tamPedaco - 1) / tamPedaco;
+    ContextoRansac c = {vx, vy, A, B, numRetas, limiar, malloc(numPedacos * numRetas * sizeof(long)), 0, NULL};
+    if (!c.contagens)
+        return -1;
+    pool_executa_pedacos(pool, n, tamPedaco, ransac_conta_pedaco, &c);
+    memset(contagem, 0, numRetas * sizeof(long));
+    for (long k = 0; k < numPedacos; k++)
+        for (int r = 0; r < numRetas; r++)
+            contagem[r] += c.contagens[k * numRetas + r];
+    free(c.contagens);
+    return 0;
+}
+
+// RANSAC com numCandidatos retas e o limiar dado. Retorna 0 ou -1 (sem memória ou N < 2)
+static inline int ransac(PoolThreads *pool, const double *X, const double *Y, long N, int numCandidatos,
+                         double limiar, uint64_t semente, ResultadoRansac *r) {
+    if (N < 2 || numCandidatos < 1)
+        return -1;
+    long S = (N > ROBUSTA_SUBAMOSTRA) ? ROBUSTA_SUBAMOSTRA : N;
+    int F = (numCandidatos < ROBUSTA_FINALISTAS) ? numCandidatos : ROBUSTA_FINALISTAS;
+    double *xs = malloc(2 * S * sizeof(double));
+    double *cand = malloc(2 * (numCandidatos + F) * sizeof(double));
+    long *contagem = malloc(numCandidatos * sizeof(long));
+    int *ordem = malloc(numCandidatos * sizeof(int));
+    if (!xs || !cand || !contagem || !ordem) {
+        free(xs);
+        free(cand);
+        free(contagem);
+        free(ordem);
+        return -1;
+    }
+    double *ys = xs + S;
+    double *cA = cand, *cB = cand + numCandidatos;
+    double *fA = cand + 2 * numCandidatos, *fB = fA + F;
+    double inicio, fimCandidatos, fimFinalistas, fim;
+    int erro = 0;
+
+    GET_TIME(inicio);
+    // Subamostra (com reposição) e centro de x para o reajuste
+    uint64_t sementeSub = aleat_u64(semente, ROBUSTA_FLUXO_SUBAMOSTRA);
+    double cx = 0;
+    for (long s = 0; s < S; s++) {
+        long i = (S == N) ? s : (long)(aleat_u64(sementeSub, s) % N);
+        xs[s] = X[i];
+        ys[s] = Y[i];
+        cx += xs[s];
+    }
+    cx /= S;
+
+    // Candidatas: reta pelos dois pontos de cada par sorteado (NaN: nenhum inlier)
+    uint64_t sementeCand = aleat_u64(semente, ROBUSTA_FLUXO_CANDIDATOS);
+    for (int k = 0; k < numCandidatos; k++) {
+        long i, j;
+        if (robusta_sorteia_par(X, N, sementeCand, k, &i, &j)) {
+            cB[k] = (Y[j] - Y[i]) / (X[j] - X[i]);
+            cA[k] = Y[i] - cB[k] * X[i];
+        } else {
+            cA[k] = cB[k] = NAN;
+        }
+        ordem[k] = k;
+    }
+    erro |= ransac_pontua(pool, xs, ys, S, ROBUSTA_PEDACO_SUBAMOSTRA, cA, cB, numCandidatos,
+                          limiar, contagem);
+
+    // As F melhores na subamostra (empate: menor índice), por seleção parcial
+    for (int f = 0; f < F; f++) {
+        int melhor = f;
+        for (int k = f + 1; k < numCandidatos; k++) {
+            long a = contagem[ordem[k]], b = contagem[ordem[melhor]];
+            if (a > b || (a == b && ordem[k] < ordem[melhor]))
+                melhor = k;
+        }
+        int troca = ordem[f];
+        ordem[f] = ordem[melhor];
+        ordem[melhor] = troca;
+        fA[f] = cA[ordem[f]];
+        fB[f] = cB[ordem[f]];
+    }
+    GET_TIME(fimCandidatos);
+
+    // Finalistas em todos os pontos, de uma vez: cada bloco é lido uma vez só
+    erro |= ransac_pontua(pool, X, Y, N, ROBUSTA_PEDACO, fA, fB, F, limiar, contagem);
+    int vencedora = 0;
+    for (int f = 1; f < F; f++)
+        if (contagem[f] > contagem[vencedora])
+            vencedora = f;
+    GET_TIME(fimFinalistas);
+
+    // Reajuste por mínimos quadrados nos inliers da vencedora: r = y - (A + B·x)
+    // é ajustado como r = a + b·(x - cx), e a reta final é (A + a - b·cx, B + b)
+    long numPedacos = (N + ROBUSTA_PEDACO - 1) / ROBUSTA_PEDACO;
+    ContextoRansac c = {X, Y, fA + vencedora, fB + vencedora, 1, limiar, NULL, cx,
+                        malloc(5 * numPedacos * sizeof(double))};
+    double s[5] = {0};
+    if (c.somas) {
+        pool_executa_pedacos(pool, N, ROBUSTA_PEDACO, ransac_somas_pedaco, &c);
+        for (long k = 0; k < numPedacos; k++)
+            for (int q = 0; q < 5; q++)
+                s[q] += c.somas[5 * k + q];
+        free(c.somas);
+    } else {
+        erro = 1;
+    }
+    double sdd = s[3] - s[1] * s[1] / s[0];
+    double b = (s[0] > 1 && sdd > 0) ? (s[4] - s[1] * s[2] / s[0]) / sdd : 0.0;
+    double a = (s[0] > 0) ? (s[2] - b * s[1]) / s[0] : 0.0;
+    r->A = fA[vencedora] + a - b * cx;
+    r->B = fB[vencedora] + b;
+    GET_TIME(fim);
+
+    r->limiar = limiar;
+    r->inliers = contagem[vencedora];
+    r->candidatos = numCandidatos;
+    r->finalistas = F;
+    r->tempoCandidatos = fimCandidatos - inicio;
+    r->tempoFinalistas = fimFinalistas - fimCandidatos;
+    r->tempoAjuste = fim - fimFinalistas;
+    free(xs);
+    free(cand);
+    free(contagem);
+    free(ordem);
+    return erro ? -1 : 0;
+}
+
+#endif
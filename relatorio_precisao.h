@@ -0,0 +1,99 @@
+/* File:     relatorio_precisao.h
+ *
+ * Purpose:  Relatório de precisão do armazenamento reduzido (float ou ponto
+ *           fixo de 32 bits, ver formato_binario.h e motor_regressao.h):
+ *           compara A, B e MSE calculados sobre as colunas reduzidas com os
+ *           do caminho em double e diz se a diferença importa.
+ *
+ *           A referência é calculada sobre os doubles originais com os
+ *           momentos centrados de estatisticas.h, em blocos combinados pela
+ *           fórmula de Chan (sem a subtração Syy - Sxy²/Sxx).
+ *
+ *           O critério de "seguro" é estatístico: reduzir a precisão não
+ *           pode mexer em A nem em B mais do que uma pequena fração do erro
+ *           padrão que eles já têm por causa do ruído dos dados, nem no MSE
+ *           mais do que PRECISAO_MSE_RELATIVO. Com x grande (até 1e6 nos
+ *           dados do gerador_dados.c) o float fica com só ~7 dígitos e
+ *           costuma reprovar; o ponto fixo usa os 32 bits inteiros na faixa
+ *           dos dados e costuma passar.
+ *
+ *           Quem usa: os motores f32/fx32 (regressao-linear-motor.c, com
+ *           --precisao) e regressao-linear-mse (--precisao f32|fx32). No
+ *           regressao-linear-mse a redução só existe nos modos com X/Y em
+ *           memória que usam as somas e o erro (padrão e --fundido): --fluxo,
+ *           --fora-memoria, --estavel, --numa, --bootstrap e --salvar-modelo
+ *           leem os doubles (ou o arquivo de novo) e recusam a opção.
+ *
+ * Exemplo:
+ *    ReferenciaPrecisao ref;
+ *    precisao_referencia(X, Y, N, &ref);   // antes de liberar os doubles
+ *    . . .
+ *    precisao_relatorio(stdout, &ref, A, B, MSE, 1, erroX, erroY, "float");
+ */
+#ifndef _RELATORIO_PRECISAO_H_
+#define _RELATORIO_PRECISAO_H_
+
+#include <stdio.h>
+#include <math.h>
+#include "estatisticas.h"
+
+#define PRECISAO_BLOCO 4096                // Pontos por bloco de momentos
+#define PRECISAO_FRACAO_ERRO_PADRAO 0.01   // |ΔA| e |ΔB| até 1% do erro padrão
+#define PRECISAO_MSE_RELATIVO 1e-3         // |ΔMSE|/MSE até 0,1%
+
+typedef struct {
+    long N;
+    double A, B, MSE;                // Caminho em double
+    double erroPadraoA, erroPadraoB; // Incerteza estatística de A e B
+} ReferenciaPrecisao;
+
+// A, B, MSE e erros padrão sobre os doubles originais
+static inline void precisao_referencia(const double *X, const double *Y, long N, ReferenciaPrecisao *r) {
+    Momentos total = {0};
+    double sse = 0;
+    for (long i = 0; i < N; i += PRECISAO_BLOCO) {
+        long n = (N - i < PRECISAO_BLOCO) ? N - i : PRECISAO_BLOCO;
+        Momentos m;
+        momentos_bloco(X + i, Y + i, n, &m);
+        momentos_combina_sse(&total, &sse, &m, momentos_sse_bloco(X + i, Y + i, n, &m));
+    }
+
+    r->N = N;
+    momentos_coeficientes(&total, &r->A, &r->B);
+    r->MSE = (N > 0) ? sse / N : 0.0;
+    // s² = SSE/(n-2); ep(B) = s/√Sxx; ep(A) = s·√(1/n + x̄²/Sxx)
+    double s2 = (N > 2) ? sse / (N - 2) : 0.0;
+    r->erroPadraoB = (total.Sxx > 0) ? sqrt(s2 / total.Sxx) : 0.0;
+    r->erroPadraoA = (N > 0 && total.Sxx > 0)
+        ? sqrt(s2 * (1.0 / N + total.mediaX * total.mediaX / total.Sxx)) : 0.0;
+}
+
+// Diferença d em relação a um erro padrão ep (0 se ep = 0 e d = 0)
+static inline double precisao_fracao(double d, double ep) {
+    if (ep > 0)
+        return fabs(d) / ep;
+    return (d == 0) ? 0.0 : INFINITY;
+}
+
+// Imprime o relatório em saida e devolve 1 se o armazenamento reduzido é seguro para
+// estes dados. temMSE = 0 quando o MSE não foi calculado (fica fora do critério)
+static inline int precisao_relatorio(FILE *saida, const ReferenciaPrecisao *r, double A, double B, double MSE,
+                                     int temMSE, double erroX, double erroY, const char *nomeTipo) {
+    double fA = precisao_fracao(A - r->A, r->erroPadraoA);
+    double fB = precisao_fracao(B - r->B, r->erroPadraoB);
+    double relMSE = !temMSE ? 0.0 : (r->MSE > 0) ? fabs(MSE - r->MSE) / r->MSE : fabs(MSE - r->MSE);
+    int seguro = fA <= PRECISAO_FRACAO_ERRO_PADRAO && fB <= PRECISAO_FRACAO_ERRO_PADRAO &&
+                 relMSE <= PRECISAO_MSE_RELATIVO;
+
+    fprintf(saida, "\n=== PRECISAO (%s contra double) ===\n", nomeTipo);
+    fprintf(saida, "Maior erro de representacao: X %.3e, Y %.3e\n", erroX, erroY);
+    fprintf(saida, "A: %.9f (double %.9f), diferenca %.3e = %.4f erros padrao\n", A, r->A, A - r->A, fA);
+    fprintf(saida, "B: %.9f (double %.9f), diferenca %.3e = %.4f erros padrao\n", B, r->B, B - r->B, fB);
+    if (temMSE)
+        fprintf(saida, "MSE: %.9f (double %.9f), diferenca relativa %.3e\n", MSE, r->MSE, relMSE);
+    fprintf(saida, "Veredito: %s (limites: %.2f erro padrao em A e B, %.0e no MSE)\n",
+            seguro ? "SEGURO" : "NAO SEGURO", PRECISAO_FRACAO_ERRO_PADRAO, PRECISAO_MSE_RELATIVO);
+    return seguro;
+}
+
+#endif
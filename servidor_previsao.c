@@ -0,0 +1,330 @@
+/* File:     servidor_previsao.c
+ *
+ * Purpose:  Servidor de previsão: carrega um modelo salvo com
+ *           --salvar-modelo e responde lotes de x com y = A + B*x por um
+ *           socket Unix (protocolo em protocolo_previsao.h).
+ *
+ *           Uma única thread atende todas as conexões com epoll (sockets não
+ *           bloqueantes). Cada requisição completa é calculada com o
+ *           nucleo_previsao e respondida na hora; se o socket do cliente
+ *           enche, a conexão para de ser lida até a resposta sair (as
+ *           respostas nunca mudam de ordem).
+ *
+ *           Latência medida por requisição: do momento em que ela ficou
+ *           completa no buffer até a resposta inteira ser entregue ao kernel.
+ *           A cada SERV_INTERVALO_MS (se houve requisições) e ao encerrar
+ *           (SIGINT/SIGTERM, via signalfd) o servidor mostra p50/p99/máximo.
+ *
+ * Compile:  gcc -O2 -o servidor_previsao servidor_previsao.c
+ * Usage:    ./servidor_previsao <modelo.bin> <caminho_do_socket>
+ */
+#define _GNU_SOURCE  // accept4
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include "modelo.h"
+#include "nucleos_simd.h"
+#include "protocolo_previsao.h"
+
+#define SERV_MAX_EVENTOS  64
+#define SERV_INTERVALO_MS 5000
+#define SERV_MAX_AMOSTRAS (1 << 20)  // Latências guardadas por intervalo
+#define SERV_BUFFER_INICIAL 4096
+
+// Estado de uma conexão
+typedef struct {
+    int fd;
+    char *entrada;                  // Bytes recebidos ainda não respondidos
+    size_t tamEntrada, capEntrada;
+    char *saida;                    // Resposta atual (cabeçalho + y)
+    size_t tamSaida, enviados;
+    uint64_t inicioReq;             // Quando a requisição atual ficou completa
+} Conexao;
+
+// Estatísticas do intervalo atual e totais
+typedef struct {
+    uint64_t *amostras;
+    long numAmostras;
+    long requisicoes, valores;
+    long totalRequisicoes, totalValores;
+    uint64_t inicioIntervalo;
+} Estatisticas;
+
+double A, B;                  // Coeficientes do modelo
+int epfd;                     // Descritor do epoll
+Estatisticas est;
+
+// Marcadores para distinguir os descritores especiais nos eventos do epoll
+static int marcaOuvinte, marcaSinais;
+
+// ==================== ESTATÍSTICAS ====================
+static void registra_latencia(uint64_t ns, long valores) {
+    if (est.numAmostras < SERV_MAX_AMOSTRAS)
+        est.amostras[est.numAmostras++] = ns;
+    est.requisicoes++;
+    est.valores += valores;
+}
+
+static void mostra_relatorio(const char *titulo) {
+    uint64_t agora = proto_agora_ns();
+    double segundos = (agora - est.inicioIntervalo) / 1e9;
+
+    est.totalRequisicoes += est.requisicoes;
+    est.totalValores += est.valores;
+    if (est.requisicoes > 0) {
+        qsort(est.amostras, est.numAmostras, sizeof(uint64_t), proto_compara_u64);
+        printf("[%s] %ld requisicoes (%.0f/s), %ld valores (%.2f milhoes/s) | "
+               "latencia p50 %.1f us, p99 %.1f us, max %.1f us\n",
+               titulo, est.requisicoes, est.requisicoes / segundos,
+               est.valores, est.valores / segundos / 1e6,
+               proto_percentil(est.amostras, est.numAmostras, 0.50) / 1e3,
+               proto_percentil(est.amostras, est.numAmostras, 0.99) / 1e3,
+               est.amostras[est.numAmostras - 1] / 1e3);
+        fflush(stdout);
+    }
+    est.numAmostras = 0;
+    est.requisicoes = est.valores = 0;
+    est.inicioIntervalo = agora;
+}
+
+// ==================== CONEXÕES ====================
+static void fecha_conexao(Conexao *c) {
+    epoll_ctl(epfd, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    free(c->entrada);
+    free(c->saida);
+    free(c);
+}
+
+static void aceita_conexoes(int ouvinte) {
+    while (1) {
+        int fd = accept4(ouvinte, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+            return;  // EAGAIN: não há mais conexões pendentes
+
+        Conexao *c = calloc(1, sizeof(Conexao));
+        if (c) {
+            c->entrada = malloc(SERV_BUFFER_INICIAL);
+            c->saida = malloc(sizeof(CabecalhoPrevisao) + PROTO_MAX_LOTE * sizeof(double));
+        }
+        if (!c || !c->entrada || !c->saida) {
+            if (c) { free(c->entrada); free(c->saida); free(c); }
+            close(fd);
+            continue;
+        }
+        c->fd = fd;
+        c->capEntrada = SERV_BUFFER_INICIAL;
+
+        struct epoll_event ev = {.events = EPOLLIN, .data.ptr = c};
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            close(fd);
+            free(c->entrada); free(c->saida); free(c);
+        }
+    }
+}
+
+// Envia o que falta da resposta atual. Retorna 1 se terminou, 0 se o socket
+// encheu, -1 em erro
+static int envia_resposta(Conexao *c) {
+    while (c->enviados < c->tamSaida) {
+        ssize_t w = write(c->fd, c->saida + c->enviados, c->tamSaida - c->enviados);
+        if (w < 0 && errno == EINTR)
+            continue;
+        if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return 0;
+        if (w < 0)
+            return -1;
+        c->enviados += w;
+    }
+    registra_latencia(proto_agora_ns() - c->inicioReq,
+                      (c->tamSaida - sizeof(CabecalhoPrevisao)) / sizeof(double));
+    c->tamSaida = c->enviados = 0;
+    return 1;
+}
+
+// Responde as requisições completas do buffer, em ordem. Para quando falta
+// parte de uma requisição ou quando o socket enche (aí espera EPOLLOUT).
+// Retorna -1 se a conexão deve ser fechada
+static int processa_requisicoes(Conexao *c) {
+    size_t consumido = 0;
+    int resultado = 0;
+
+    while (c->tamSaida == 0 && c->tamEntrada - consumido >= sizeof(CabecalhoPrevisao)) {
+        CabecalhoPrevisao cab;
+        memcpy(&cab, c->entrada + consumido, sizeof(cab));
+
+        if (cab.n == 0 || cab.n > PROTO_MAX_LOTE) {
+            CabecalhoPrevisao erro = {0, PROTO_ERRO_TAMANHO};
+            ssize_t ignorado = write(c->fd, &erro, sizeof(erro));
+            (void)ignorado;
+            return -1;
+        }
+
+        size_t tamReq = sizeof(cab) + (size_t)cab.n * sizeof(double);
+        if (c->tamEntrada - consumido < tamReq) {
+            // Incompleta: garante espaço para ela inteira no buffer
+            if (tamReq > c->capEntrada) {
+                char *maior = realloc(c->entrada, tamReq);
+                if (!maior)
+                    return -1;
+                c->entrada = maior;
+                c->capEntrada = tamReq;
+            }
+            break;
+        }
+
+        // Requisição completa: y = A + B*x direto para o buffer de saída
+        // (as requisições começam em múltiplos de 8 bytes, então os doubles ficam alinhados)
+        c->inicioReq = proto_agora_ns();
+        CabecalhoPrevisao resp = {cab.n, PROTO_OK};
+        memcpy(c->saida, &resp, sizeof(resp));
+        nucleo_previsao((const double *)(c->entrada + consumido + sizeof(cab)), cab.n, A, B,
+                        (double *)(c->saida + sizeof(resp)));
+        c->tamSaida = tamReq;
+        c->enviados = 0;
+        consumido += tamReq;
+
+        resultado = envia_resposta(c);
+        if (resultado < 0)
+            return -1;
+    }
+
+    if (consumido > 0) {
+        memmove(c->entrada, c->entrada + consumido, c->tamEntrada - consumido);
+        c->tamEntrada -= consumido;
+    }
+
+    // Resposta presa no socket: para de ler até ela sair (EPOLLOUT)
+    struct epoll_event ev = {.events = (c->tamSaida > 0) ? EPOLLOUT : EPOLLIN, .data.ptr = c};
+    epoll_ctl(epfd, EPOLL_CTL_MOD, c->fd, &ev);
+    return 0;
+}
+
+// Lê tudo o que estiver disponível. Retorna -1 se o cliente fechou ou houve erro
+static int le_conexao(Conexao *c) {
+    while (c->tamEntrada < c->capEntrada) {
+        ssize_t r = read(c->fd, c->entrada + c->tamEntrada, c->capEntrada - c->tamEntrada);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return 0;
+        if (r <= 0)
+            return -1;
+        c->tamEntrada += r;
+    }
+    return 0;  // Buffer cheio: processa e volta a ler no próximo evento
+}
+
+// ==================== PROGRAMA PRINCIPAL ====================
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        printf("Uso: %s <modelo.bin> <caminho_do_socket>\n", argv[0]);
+        return 1;
+    }
+
+    Modelo modelo;
+    if (carrega_modelo(argv[1], &modelo) != 0)
+        return 1;
+    A = modelo.A;
+    B = modelo.B;
+    nucleos_seleciona();
+
+    // Socket de escuta
+    struct sockaddr_un endereco = {.sun_family = AF_UNIX};
+    if (strlen(argv[2]) >= sizeof(endereco.sun_path)) {
+        fprintf(stderr, "Erro: caminho do socket muito longo\n");
+        return 1;
+    }
+    strcpy(endereco.sun_path, argv[2]);
+    int ouvinte = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    unlink(argv[2]);
+    if (ouvinte < 0 || bind(ouvinte, (struct sockaddr *)&endereco, sizeof(endereco)) != 0 ||
+        listen(ouvinte, 128) != 0) {
+        perror("Erro ao criar o socket");
+        return 1;
+    }
+
+    // SIGINT/SIGTERM chegam pelo próprio epoll (signalfd)
+    sigset_t sinais;
+    sigemptyset(&sinais);
+    sigaddset(&sinais, SIGINT);
+    sigaddset(&sinais, SIGTERM);
+    sigprocmask(SIG_BLOCK, &sinais, NULL);
+    signal(SIGPIPE, SIG_IGN);  // Cliente que fecha no meio vira erro de write, não sinal
+    int fdSinais = signalfd(-1, &sinais, SFD_NONBLOCK | SFD_CLOEXEC);
+
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event ev = {.events = EPOLLIN, .data.ptr = &marcaOuvinte};
+    epoll_ctl(epfd, EPOLL_CTL_ADD, ouvinte, &ev);
+    ev.data.ptr = &marcaSinais;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, fdSinais, &ev);
+
+    est.amostras = malloc(SERV_MAX_AMOSTRAS * sizeof(uint64_t));
+    if (fdSinais < 0 || epfd < 0 || !est.amostras) {
+        perror("Erro ao preparar o servidor");
+        return 1;
+    }
+    est.inicioIntervalo = proto_agora_ns();
+
+    printf("Servidor ouvindo em %s (A = %.6f, B = %.6f, n = %llu, nucleo %s)\n",
+           argv[2], A, B, (unsigned long long)modelo.n, nucleo_nome);
+    fflush(stdout);
+
+    // ==================== LAÇO DE EVENTOS ====================
+    struct epoll_event eventos[SERV_MAX_EVENTOS];
+    int rodando = 1;
+    while (rodando) {
+        uint64_t decorrido = (proto_agora_ns() - est.inicioIntervalo) / 1000000;
+        int espera = (decorrido >= SERV_INTERVALO_MS) ? 0 : (int)(SERV_INTERVALO_MS - decorrido);
+        int prontos = epoll_wait(epfd, eventos, SERV_MAX_EVENTOS, espera);
+        if (prontos < 0 && errno != EINTR) {
+            perror("Erro no epoll_wait");
+            break;
+        }
+
+        for (int i = 0; i < prontos; i++) {
+            void *origem = eventos[i].data.ptr;
+            if (origem == &marcaOuvinte) {
+                aceita_conexoes(ouvinte);
+            } else if (origem == &marcaSinais) {
+                rodando = 0;
+            } else {
+                Conexao *c = (Conexao *)origem;
+                int erro = 0;
+                if (eventos[i].events & EPOLLOUT) {
+                    int r = envia_resposta(c);
+                    erro = (r < 0);
+                    if (r > 0)
+                        erro = processa_requisicoes(c) < 0;
+                } else if (eventos[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    erro = le_conexao(c) < 0;
+                    // Mesmo com o cliente fechando, responde o que já chegou inteiro
+                    if (processa_requisicoes(c) < 0)
+                        erro = 1;
+                }
+                if (erro)
+                    fecha_conexao(c);
+            }
+        }
+
+        if ((proto_agora_ns() - est.inicioIntervalo) / 1000000 >= SERV_INTERVALO_MS)
+            mostra_relatorio("intervalo");
+    }
+
+    mostra_relatorio("final");
+    printf("Total: %ld requisicoes, %ld valores\n", est.totalRequisicoes, est.totalValores);
+
+    close(ouvinte);
+    unlink(argv[2]);
+    close(fdSinais);
+    close(epfd);
+    free(est.amostras);
+    return 0;
+}
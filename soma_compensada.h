@@ -0,0 +1,132 @@
+/* File:     soma_compensada.h
+ *
+ * Purpose:  Somas compensadas (estilo Sum2/Dot2 de Ogita, Rump e Oishi) e
+ *           uma aritmética "double-double" mínima para terminar as contas.
+ *
+ *           Cada SomaComp guarda a soma em double (s) e o erro de
+ *           arredondamento acumulado (c). Os erros de cada adição e de cada
+ *           produto são obtidos exatamente (TwoSum / TwoProduct), então o
+ *           resultado s + c equivale a somar com o dobro da precisão.
+ *
+ *           Isso é o que permite calcular SSE = Syy - Sxy²/Sxx a partir das
+ *           somas: quando o ajuste é bom, Syy e Sxy²/Sxx são enormes e quase
+ *           iguais, e em double puro a subtração perderia todos os dígitos.
+ *
+ * Note:     Com -mfma (ou -march=native) o TwoProduct usa uma instrução FMA;
+ *           sem ela usa a divisão de Veltkamp/Dekker, que dá o mesmo resultado.
+ *           Não compile com -ffast-math: as transformações dependem da ordem
+ *           exata das operações.
+ */
+#ifndef _SOMA_COMPENSADA_H_
+#define _SOMA_COMPENSADA_H_
+
+#ifdef __FMA__
+#include <math.h>
+#endif
+
+// Soma compensada: valor = s + c
+typedef struct {
+    double s;  // Soma em double
+    double c;  // Erros de arredondamento acumulados
+} SomaComp;
+
+// Número double-double normalizado: valor = hi + lo, com |lo| <= ulp(hi)/2
+typedef struct {
+    double hi, lo;
+} DuplaDupla;
+
+// TwoSum: s + e == a + b exatamente
+static inline double comp_two_sum(double a, double b, double *e) {
+    double s = a + b;
+    double bb = s - a;
+    *e = (a - (s - bb)) + (b - bb);
+    return s;
+}
+
+// TwoProduct: p + e == a * b exatamente
+static inline double comp_two_prod(double a, double b, double *e) {
+    double p = a * b;
+#ifdef __FMA__
+    *e = fma(a, b, -p);
+#else
+    const double divisor = 134217729.0;  // 2^27 + 1 (Veltkamp)
+    double t = divisor * a, ah = t - (t - a), al = a - ah;
+    t = divisor * b;
+    double bh = t - (t - b), bl = b - bh;
+    *e = ((ah * bh - p) + ah * bl + al * bh) + al * bl;
+#endif
+    return p;
+}
+
+// ==================== SOMAS COMPENSADAS ====================
+static inline void comp_adiciona(SomaComp *a, double v) {
+    double e;
+    a->s = comp_two_sum(a->s, v, &e);
+    a->c += e;
+}
+
+static inline void comp_adiciona_produto(SomaComp *a, double x, double y) {
+    double ep, es;
+    double p = comp_two_prod(x, y, &ep);
+    a->s = comp_two_sum(a->s, p, &es);
+    a->c += es + ep;
+}
+
+// a += b (redução dos parciais de cada thread)
+static inline void comp_combina(SomaComp *a, SomaComp b) {
+    double e;
+    a->s = comp_two_sum(a->s, b.s, &e);
+    a->c += e + b.c;
+}
+
+// ==================== ARITMÉTICA DOUBLE-DOUBLE ====================
+static inline DuplaDupla dd_de_soma(SomaComp a) {
+    DuplaDupla r;
+    r.hi = comp_two_sum(a.s, a.c, &r.lo);
+    return r;
+}
+
+static inline DuplaDupla dd_de(double a) {
+    DuplaDupla r = {a, 0.0};
+    return r;
+}
+
+static inline DuplaDupla dd_soma(DuplaDupla a, DuplaDupla b) {
+    double e, f;
+    double s = comp_two_sum(a.hi, b.hi, &e);
+    double t = comp_two_sum(a.lo, b.lo, &f);
+    e += t;
+    s = comp_two_sum(s, e, &e);
+    e += f;
+    DuplaDupla r;
+    r.hi = comp_two_sum(s, e, &r.lo);
+    return r;
+}
+
+static inline DuplaDupla dd_sub(DuplaDupla a, DuplaDupla b) {
+    b.hi = -b.hi;
+    b.lo = -b.lo;
+    return dd_soma(a, b);
+}
+
+static inline DuplaDupla dd_mul(DuplaDupla a, DuplaDupla b) {
+    double e;
+    double p = comp_two_prod(a.hi, b.hi, &e);
+    e += a.hi * b.lo + a.lo * b.hi;
+    DuplaDupla r;
+    r.hi = comp_two_sum(p, e, &r.lo);
+    return r;
+}
+
+static inline DuplaDupla dd_div(DuplaDupla a, DuplaDupla b) {
+    double q1 = a.hi / b.hi;
+    DuplaDupla resto = dd_sub(a, dd_mul(b, dd_de(q1)));
+    double q2 = resto.hi / b.hi;
+    resto = dd_sub(resto, dd_mul(b, dd_de(q2)));
+    double q3 = resto.hi / b.hi;
+    DuplaDupla r;
+    r.hi = comp_two_sum(q1, q2, &r.lo);
+    return dd_soma(r, dd_de(q3));
+}
+
+#endif
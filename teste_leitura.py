@@ -0,0 +1,88 @@
+"""Confere que todos os caminhos de leitura aceitam as mesmas linhas.
+
+Gera um CSV com linhas válidas misturadas a linhas malformadas (lixo depois
+de y, terceiro campo, campos vazios, separador errado) e roda cada modo de
+leitura sobre ele: pread + strtod (padrão), --mmap, --fluxo, --fora-memoria,
+o binário gerado pelo conversor_binario e o motor. Todos devem contar o
+mesmo número de pontos, igual ao número de linhas válidas, com 1 e 3 threads
+(3 threads dividem o arquivo no meio das linhas malformadas).
+
+Uso:
+    python3 teste_leitura.py
+    python3 teste_leitura.py --binarios build/x86-64-v3
+Termina com código 1 se algum modo discordar.
+"""
+import argparse
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+# (linha, válida) - a regra está em leitor_resto_vazio (leitor_csv.h)
+LINHAS = [
+    ("1,2", True),
+    ("2,4abc", False),
+    ("3,6", True),
+    ("4,8 9", False),
+    ("5,10 ", True),
+    ("6,12\r", True),
+    ("7;14", False),
+    ("8,16,3", False),
+    (",18", False),
+    ("10,", False),
+    ("abc,22", False),
+    ("  12,24", True),
+    ("1.3e1,2.6e1", True),
+    ("14 ,28", False),
+]
+
+
+def conta_pontos(comando):
+    saida = subprocess.run(comando, input="q\n", capture_output=True, text=True, timeout=60)
+    achado = re.search(r"Numero de pontos: (\d+)", saida.stdout)
+    return int(achado.group(1)) if achado else None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--binarios", default=".", help="diretório dos programas compilados")
+    args = parser.parse_args()
+    prog = lambda nome: os.path.join(args.binarios, nome)
+
+    esperado = sum(1 for _, valida in LINHAS if valida)
+    falhas = 0
+    with tempfile.TemporaryDirectory() as pasta:
+        csv = os.path.join(pasta, "malformado.csv")
+        binario = os.path.join(pasta, "malformado.bin")
+        with open(csv, "w", newline="") as f:
+            f.write("x,y\n")
+            for _ in range(50):  # Repetido para que as faixas das threads caiam em linhas diferentes
+                for linha, _ in LINHAS:
+                    f.write(linha + "\n")
+        esperado *= 50
+
+        for threads in ("1", "3"):
+            subprocess.run([prog("conversor_binario"), csv, binario, threads],
+                           capture_output=True, check=True)
+            modos = {
+                "padrao": [prog("regressao-linear-mse"), csv, threads],
+                "--mmap": [prog("regressao-linear-mse"), csv, threads, "--mmap"],
+                "--fluxo": [prog("regressao-linear-mse"), csv, threads, "--fluxo"],
+                "--fora-memoria": [prog("regressao-linear-mse"), csv, threads, "--fora-memoria", "4"],
+                "conversor_binario": [prog("regressao-linear-mse"), binario, threads],
+                "motor": [prog("regressao-linear"), csv, threads],
+                "motor --mmap": [prog("regressao-linear"), csv, threads, "--mmap"],
+            }
+            for nome, comando in modos.items():
+                n = conta_pontos(comando)
+                ok = n == esperado
+                falhas += not ok
+                print(f"{'ok ' if ok else 'ERRO'} {threads} thread(s) {nome}: N = {n} (esperado {esperado})")
+
+    print("Todos os modos concordam" if falhas == 0 else f"{falhas} modo(s) discordam")
+    return 1 if falhas else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
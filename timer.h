@@ -2,7 +2,9 @@
  *
  * Purpose:  Define a macro that returns the number of seconds that 
  *           have elapsed since some point in the past.  The timer
- *           should return times with microsecond accuracy.
+ *           uses the monotonic clock (clock_gettime, nanosecond
+ *           resolution, read through the vDSO from the TSC on x86):
+ *           it never goes backwards when the system time is adjusted.
  *
  * Note:     The argument passed to the GET_TIME macro should be
  *           a double, *not* a pointer to a double.
@@ -26,13 +28,13 @@
 #ifndef _TIMER_H_
 #define _TIMER_H_
 
-#include <sys/time.h>
+#include <time.h>
 
 /* The argument now should be a double (not a pointer to a double) */
 #define GET_TIME(now) { \
-   struct timeval t; \
-   gettimeofday(&t, NULL); \
-   now = t.tv_sec + t.tv_usec/1000000.0; \
+   struct timespec t; \
+   clock_gettime(CLOCK_MONOTONIC, &t); \
+   now = t.tv_sec + t.tv_nsec/1000000000.0; \
 }
 
 #endif
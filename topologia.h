@@ -0,0 +1,114 @@
+/* File:     topologia.h
+ *
+ * Purpose:  Descobre quais CPUs pertencem a cada nó NUMA (lendo
+ *           /sys/devices/system/node, sem depender da libnuma) e monta a
+ *           ordem em que as threads devem ser fixadas.
+ *
+ *           As threads são distribuídas em rodízio entre os nós (thread 0
+ *           no nó 0, thread 1 no nó 1, ...), para que a banda de memória de
+ *           todos os soquetes seja usada mesmo com poucas threads. Só entram
+ *           CPUs permitidas pela máscara de afinidade do processo.
+ *
+ * Exemplo:
+ *    Topologia topo;
+ *    topologia_descobre(&topo);
+ *    int cpus[numThreads], nos[numThreads];
+ *    topologia_distribui(&topo, numThreads, cpus, nos);
+ *    fixa_thread_cpu(cpus[0]);
+ */
+#ifndef _TOPOLOGIA_H_
+#define _TOPOLOGIA_H_
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <pthread.h>
+
+#define TOPO_MAX_NOS     64
+#define TOPO_MAX_CPUS    1024  // Maior número de CPU considerado
+#define TOPO_MAX_CPUS_NO 128   // CPUs guardadas por nó
+
+typedef struct {
+    int numNos;                       // Nós NUMA com ao menos uma CPU permitida
+    int numCpus[TOPO_MAX_NOS];        // CPUs permitidas em cada nó
+    int cpus[TOPO_MAX_NOS][TOPO_MAX_CPUS_NO];  // CPUs de cada nó
+} Topologia;
+
+// Lê uma lista no formato do kernel ("0-3,8,10-11") e adiciona ao nó as CPUs permitidas
+static inline void topo_le_lista(const char *lista, const cpu_set_t *permitidas, Topologia *topo, int no) {
+    const char *p = lista;
+    while (*p && *p != '\n') {
+        char *fim;
+        long ini = strtol(p, &fim, 10), ult = ini;
+        if (fim == p)
+            break;
+        if (*fim == '-')
+            ult = strtol(fim + 1, &fim, 10);
+        for (long c = ini; c <= ult && c < TOPO_MAX_CPUS; c++) {
+            if (CPU_ISSET(c, permitidas) && topo->numCpus[no] < TOPO_MAX_CPUS_NO)
+                topo->cpus[no][topo->numCpus[no]++] = (int)c;
+        }
+        p = (*fim == ',') ? fim + 1 : fim;
+    }
+}
+
+// Preenche a topologia; sem informação de NUMA, considera um único nó
+static inline void topologia_descobre(Topologia *topo) {
+    cpu_set_t permitidas;
+    char caminho[128], lista[4096];
+
+    memset(topo, 0, sizeof(*topo));
+    if (sched_getaffinity(0, sizeof(permitidas), &permitidas) != 0) {
+        CPU_ZERO(&permitidas);
+        CPU_SET(0, &permitidas);
+    }
+
+    for (int no = 0; no < TOPO_MAX_NOS; no++) {
+        snprintf(caminho, sizeof(caminho), "/sys/devices/system/node/node%d/cpulist", no);
+        FILE *f = fopen(caminho, "r");
+        if (!f)
+            continue;
+        if (fgets(lista, sizeof(lista), f)) {
+            int atual = topo->numNos;
+            topo_le_lista(lista, &permitidas, topo, atual);
+            if (topo->numCpus[atual] > 0)
+                topo->numNos++;
+        }
+        fclose(f);
+    }
+
+    if (topo->numNos == 0) {
+        // Sem /sys/devices/system/node: todas as CPUs permitidas em um nó só
+        topo->numNos = 1;
+        for (int c = 0; c < TOPO_MAX_CPUS && topo->numCpus[0] < TOPO_MAX_CPUS_NO; c++) {
+            if (CPU_ISSET(c, &permitidas))
+                topo->cpus[0][topo->numCpus[0]++] = c;
+        }
+    }
+}
+
+// Define a CPU (cpus[t]) e o nó (nos[t]) de cada thread, em rodízio entre os nós
+static inline void topologia_distribui(const Topologia *topo, int numThreads, int *cpus, int *nos) {
+    int proxima[TOPO_MAX_NOS] = {0};
+
+    for (int t = 0; t < numThreads; t++) {
+        int no = t % topo->numNos;
+        nos[t] = no;
+        cpus[t] = topo->cpus[no][proxima[no] % topo->numCpus[no]];
+        proxima[no]++;
+    }
+}
+
+// Fixa a thread atual em uma CPU. Retorna 0 em sucesso
+static inline int fixa_thread_cpu(int cpu) {
+    cpu_set_t conjunto;
+    CPU_ZERO(&conjunto);
+    CPU_SET(cpu, &conjunto);
+    return pthread_setaffinity_np(pthread_self(), sizeof(conjunto), &conjunto);
+}
+
+#endif